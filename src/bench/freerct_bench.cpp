@@ -0,0 +1,433 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file freerct_bench.cpp Benchmark program timing the hot paths of the game in synthetic worlds. */
+
+#include "../stdafx.h"
+#include "../map.h"
+#include "../path.h"
+#include "../path_build.h"
+#include "../path_finding.h"
+#include "../person.h"
+#include "../people.h"
+#include "../viewport.h"
+#include "../video.h"
+#include "../window.h"
+#include "../sprite_data.h"
+#include "../sprite_store.h"
+#include "../rcdfile.h"
+#include "../language.h"
+#include "../loadsave.h"
+#include "../gamecontrol.h"
+#include "../getoptdata.h"
+#include "../fileio.h"
+#include "../palette.h"
+#include "../random.h"
+#include "../worker_pool.h"
+#include "../ride_type.h"
+#include "../blitter.h"
+#include "../sprite_cache.h"
+#include "../coaster.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const int16 BENCH_GROUND_HEIGHT = 8; ///< Height of the flat ground of the synthetic worlds.
+static const char *BENCH_SAVE_NAME = "freerct_bench.fct"; ///< File used for the savegame benchmarks.
+static const uint32 BENCH_SEED = 12345; ///< Seed of the random generators, for getting the same worlds in every run.
+
+/** Timing result of a single benchmark. */
+struct BenchResult {
+	std::string name; ///< Name of the benchmark.
+	int world_size;   ///< Length of a side of the world, in voxel stacks.
+	uint guests;      ///< Number of active guests in the world.
+	uint iterations;  ///< Number of timed iterations.
+	double total_ms;  ///< Total time of all iterations, in milliseconds.
+};
+
+static std::vector<BenchResult> _results; ///< Results of all benchmarks run so far.
+
+/**
+ * Time a benchmark, and add the result to #_results.
+ * @param name Name of the benchmark.
+ * @param world_size Length of a side of the world.
+ * @param iterations Number of iterations to run.
+ * @param func Function performing one iteration.
+ */
+template <typename Func>
+static void TimeBench(const char *name, int world_size, uint iterations, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (uint i = 0; i < iterations; i++) func();
+	auto stop = std::chrono::steady_clock::now();
+
+	_results.push_back({name, world_size, _guests.CountActiveGuests(), iterations,
+			std::chrono::duration<double, std::milli>(stop - start).count()});
+}
+
+/**
+ * Is the given voxel stack part of the path grid of the synthetic world?
+ * @param x X coordinate of the voxel stack.
+ * @param y Y coordinate of the voxel stack.
+ * @return Whether the stack has a path.
+ */
+static inline bool IsGridPath(int x, int y)
+{
+	return (x % 4) == 1 || (y % 4) == 1;
+}
+
+/**
+ * Make a flat park of the given size, with a grid of paths connected to the north-west edge.
+ * @param size Length of a side of the world.
+ */
+static void MakeSyntheticWorld(int size)
+{
+	_world.SetWorldSize(size, size);
+	_world.MakeFlatWorld(BENCH_GROUND_HEIGHT);
+
+	for (int x = 1; x < size - 1; x++) {
+		for (int y = 0; y < size - 1; y++) {
+			if (y == 0 && x != 1) continue; // Only a single entrance path at the edge.
+			if (IsGridPath(x, y)) BuildFlatPath(XYZPoint16(x, y, BENCH_GROUND_HEIGHT), PAT_CONCRETE, false);
+		}
+	}
+
+	/* Set the park area after building the paths, the border fence would otherwise block the entrance path. */
+	_world.SetTileOwnerGlobally(OWN_NONE);
+	_world.SetTileOwnerRect(1, 1, size - 2, size - 2, OWN_PARK);
+}
+
+/**
+ * Let guests enter the synthetic world.
+ * @param count Number of guests to add.
+ */
+static void AddGuests(uint count)
+{
+	_guests.start_voxel = {1, 0}; // Guests also leave the world here.
+	while (_guests.CountActiveGuests() < count) {
+		if (_guests.AddGuest(_guests.start_voxel) == nullptr) break;
+	}
+}
+
+/**
+ * Find a flat unbanked track piece of a coaster type.
+ * @param ct Coaster type to search.
+ * @param entry_connect Entry connection code of the piece.
+ * @param bend Bend of the piece.
+ * @param station Whether to find a station piece.
+ * @return The track piece, or \c nullptr if the coaster type does not have it.
+ */
+static ConstTrackPiecePtr FindFlatTrackPiece(const CoasterType *ct, uint8 entry_connect, TrackBend bend, bool station)
+{
+	for (const ConstTrackPiecePtr &piece : ct->pieces) {
+		if (piece->entry_connect != entry_connect || piece->GetBend() != bend || piece->IsStartingPiece() != station) continue;
+		if (piece->GetSlope() == TSL_FLAT && piece->GetBanking() == TPB_NONE) return piece;
+	}
+	return nullptr;
+}
+
+/**
+ * Build a square roller coaster above the park, with a station along the first side, and start testing it.
+ * @param size Length of a side of the world.
+ * @return The coaster, or \c nullptr if no coaster could be built with the loaded track pieces.
+ */
+static CoasterInstance *BuildCoaster(int size)
+{
+	const CoasterType *ct = nullptr;
+	for (uint16 i = 0; i < MAX_NUMBER_OF_RIDE_TYPES && ct == nullptr; i++) {
+		const RideType *rt = _rides_manager.GetRideType(i);
+		if (rt != nullptr && rt->kind == RTK_COASTER && rt->CanMakeInstance()) ct = static_cast<const CoasterType *>(rt);
+	}
+	if (ct == nullptr) return nullptr;
+
+	ConstTrackPiecePtr start_piece = nullptr;
+	for (const ConstTrackPiecePtr &piece : ct->pieces) {
+		if (piece->IsStartingPiece() && piece->GetSlope() == TSL_FLAT && piece->GetBend() == TBN_STRAIGHT) {
+			start_piece = piece;
+			break;
+		}
+	}
+	uint16 instance = _rides_manager.GetFreeInstance(ct);
+	if (start_piece == nullptr || instance == INVALID_RIDE_INSTANCE) return nullptr;
+
+	CoasterInstance *ci = static_cast<CoasterInstance *>(_rides_manager.CreateInstance(ct, instance));
+	_rides_manager.NewInstanceAdded(instance);
+
+	/* Square track in the middle of the world, above the paths. Every side has straight pieces followed by a bend. */
+	int side_length = std::min(size / 2 - 3, MAX_PLACED_TRACK_PIECES / 4 - 1);
+	XYZPoint16 pos(size / 2, size / 2, BENCH_GROUND_HEIGHT + 2);
+	uint8 connect = start_piece->entry_connect;
+	bool ok = true;
+	for (int side = 0; side < 4 && ok; side++) {
+		for (int i = 0; i <= side_length && ok; i++) {
+			ConstTrackPiecePtr piece;
+			if (i == side_length) {
+				piece = FindFlatTrackPiece(ct, connect, TBN_RIGHT_TIGHT, false);
+			} else {
+				piece = FindFlatTrackPiece(ct, connect, TBN_STRAIGHT, side == 0);
+			}
+			PositionedTrackPiece ptp(pos, piece);
+			ok = piece != nullptr && ptp.CanBePlaced() && ci->AddPositionedPiece(ptp) >= 0;
+			if (!ok) break;
+
+			ci->PlaceTrackPieceInWorld(ptp);
+			pos = ptp.GetEndXYZ();
+			connect = piece->exit_connect;
+		}
+	}
+	if (!ok || !ci->MakePositionedPiecesLooping(nullptr)) {
+		_rides_manager.DeleteInstance(instance);
+		return nullptr;
+	}
+
+	/* Complete the construction like the coaster management window does, and fill the station with trains. */
+	ci->CloseRide();
+	ci->SetNumberOfCars(ci->GetMaxNumberOfCars());
+	ci->SetNumberOfTrains(ci->GetMaxNumberOfTrains(ci->cars_per_train));
+	ci->TestRide();
+	return ci;
+}
+
+/**
+ * Run the benchmarks for one world size.
+ * @param size Length of a side of the world.
+ * @param scale Multiplier of the number of iterations.
+ */
+static void RunBenchmarks(int size, uint scale)
+{
+	MakeSyntheticWorld(size);
+	AddGuests(size * size / 2);
+
+	/* Let guests spread out over the park before measuring, and replace the guests that left. */
+	for (int i = 0; i < 200; i++) _guests.OnAnimate(FRAME_DELAY);
+	AddGuests(size * size / 2);
+
+	TimeBench("guests-on-animate", size, 100 * scale, []() { _guests.OnAnimate(FRAME_DELAY); });
+	TimeBench("guests-do-tick", size, 1000 * scale, []() { _guests.DoTick(); });
+
+	Random rnd;
+	uint16 grid_count = (size - 3) / 4; // Number of path lines in each direction inside the park.
+	TimeBench("path-search", size, 20 * scale, [&rnd, grid_count]() {
+		XYZPoint16 from(1 + 4 * rnd.Uniform(grid_count - 1), 1 + rnd.Uniform(4 * grid_count), BENCH_GROUND_HEIGHT);
+		XYZPoint16 to(1 + rnd.Uniform(4 * grid_count), 1 + 4 * rnd.Uniform(grid_count - 1), BENCH_GROUND_HEIGHT);
+		PathSearcher ps(to);
+		ps.AddStart(from);
+		ps.Search();
+	});
+
+	XYZPoint32 view_pos(size * 256 / 2, size * 256 / 2, BENCH_GROUND_HEIGHT * 256);
+	Viewport *vp = new Viewport(view_pos);
+	TimeBench("viewport-collect", size, 20 * scale, [vp]() { vp->CollectSprites(); });
+	TimeBench("viewport-draw", size, 20 * scale, [vp]() { vp->OnDraw(nullptr); });
+
+	/* Overviews of the park at the zoomed out levels. */
+	static const char *const zoom_collect_names[] = {"viewport-collect-zoom1", "viewport-collect-zoom2", "viewport-collect-zoom3"};
+	static const char *const zoom_draw_names[] = {"viewport-draw-zoom1", "viewport-draw-zoom2", "viewport-draw-zoom3"};
+	for (int zoom = 1; zoom < ZOOM_LEVEL_COUNT; zoom++) {
+		vp->Zoom(1);
+		TimeBench(zoom_collect_names[zoom - 1], size, 20 * scale, [vp]() { vp->CollectSprites(); });
+		TimeBench(zoom_draw_names[zoom - 1], size, 20 * scale, [vp]() { vp->OnDraw(nullptr); });
+	}
+	while (vp->zoom > 0) vp->Zoom(-1);
+
+	const SpriteStorage *sprites = _sprite_manager.GetSprites(vp->tile_width);
+	const ImageData *img = sprites->GetSurfaceSprite(GTP_GRASS0, ISL_FLAT, VOR_NORTH);
+	if (img != nullptr) {
+		static const Recolouring recolour;
+		const char *name = GB(img->flags, IFG_IS_8BPP, 1) != 0 ? "blit-8bpp-images" : "blit-32bpp-images";
+		uint16 numx = _video.GetXSize() / img->width;
+		uint16 numy = _video.GetYSize() / img->height;
+		TimeBench(name, size, 20 * scale, [img, numx, numy]() {
+			_video.BlitImages({0, 0}, img, numx, numy, recolour, GS_NORMAL);
+		});
+	}
+
+	std::vector<const RideType *> ride_types;
+	for (uint16 i = 0; i < MAX_NUMBER_OF_RIDE_TYPES; i++) {
+		const RideType *rt = _rides_manager.GetRideType(i);
+		if (rt != nullptr) ride_types.push_back(rt);
+	}
+	if (!ride_types.empty()) {
+		TimeBench("blit-ride-views", size, 20 * scale, [&ride_types]() {
+			/* Draw the ride views of all orientations in a grid over the screen, partly outside it at the edges. */
+			int32 x = -50;
+			int32 y = -50;
+			for (int i = 0; i < 64; i++) {
+				for (const RideType *rt : ride_types) {
+					for (uint8 orient = 0; orient < 4; orient++) {
+						const ImageData *view = rt->GetView(orient);
+						if (view == nullptr) continue;
+						_video.BlitImages({x, y}, view, 1, 1, rt->recolours, static_cast<GradientShift>(i % GS_COUNT));
+						x += 90;
+						if (x >= _video.GetXSize()) {
+							x = -50;
+							y = (y + 70 >= _video.GetYSize()) ? -50 : y + 70;
+						}
+					}
+				}
+			}
+		});
+	}
+	_window_manager.CloseAllWindows();
+
+	TimeBench("save-game", size, scale, []() { SaveGameFile(BENCH_SAVE_NAME, false); });
+	TimeBench("load-game", size, scale, []() {
+		_guests.Uninitialize();
+		LoadGameFile(BENCH_SAVE_NAME);
+	});
+	TimeBench("save-game-compressed", size, scale, []() { SaveGameFile(BENCH_SAVE_NAME, true); });
+	TimeBench("load-game-compressed", size, scale, []() {
+		_guests.Uninitialize();
+		LoadGameFile(BENCH_SAVE_NAME);
+	});
+	TimeBench("save-game-snapshot", size, scale, []() { delete TakeGameSnapshot(); });
+	remove(BENCH_SAVE_NAME);
+
+	CoasterInstance *ci = BuildCoaster(size);
+	if (ci != nullptr) {
+		/* Let the trains leave the station before measuring. */
+		for (int i = 0; i < 200; i++) ci->OnAnimate(FRAME_DELAY);
+		TimeBench("coaster-trains-on-animate", size, 1000 * scale, [ci]() { ci->OnAnimate(FRAME_DELAY); });
+		_rides_manager.DeleteInstance(ci->GetIndex());
+	}
+
+	_guests.Uninitialize();
+}
+
+/**
+ * Write the benchmark results as JSON.
+ * @param fp Output stream to write to.
+ */
+static void WriteResults(FILE *fp)
+{
+	fprintf(fp, "{\n\t\"blitter\": \"%s\",\n\t\"benchmarks\": [\n", _blitter.name);
+	for (uint i = 0; i < _results.size(); i++) {
+		const BenchResult &res = _results[i];
+		fprintf(fp, "\t\t{\"name\": \"%s\", \"world_size\": %d, \"guests\": %u, \"iterations\": %u, \"total_ms\": %.3f, \"per_iteration_us\": %.3f}%s\n",
+				res.name.c_str(), res.world_size, res.guests, res.iterations, res.total_ms,
+				(res.iterations > 0) ? res.total_ms * 1000.0 / res.iterations : 0.0,
+				(i + 1 < _results.size()) ? "," : "");
+	}
+	fprintf(fp, "\t],\n");
+	fprintf(fp, "\t\"sprite_cache\": {\"hits\": %llu, \"misses\": %llu, \"evictions\": %llu}\n}\n",
+			(unsigned long long)_sprite_cache.hits, (unsigned long long)_sprite_cache.misses, (unsigned long long)_sprite_cache.evictions);
+}
+
+/** Command-line options of the benchmark program. */
+static const OptionData _options[] = {
+	GETOPT_NOVAL('h', "--help"),
+	GETOPT_VALUE('s', "--scale"),
+	GETOPT_VALUE('o', "--output"),
+	GETOPT_VALUE('j', "--threads"),
+	GETOPT_VALUE('b', "--blitter"),
+	GETOPT_VALUE('c', "--cache"),
+	GETOPT_NOVAL('m', "--no-mmap"),
+	GETOPT_END()
+};
+
+/** Output command-line help. */
+static void PrintUsage()
+{
+	printf("Usage: freerct_bench [options]\n");
+	printf("Options:\n");
+	printf("  -h, --help           Display this help text and exit.\n");
+	printf("  -s, --scale [num]    Multiply the number of iterations of each benchmark (default 1).\n");
+	printf("  -o, --output [file]  Write the results to the specified file instead of the standard output.\n");
+	printf("  -j, --threads [num]  Number of worker threads (default one less than the number of processors).\n");
+	printf("  -b, --blitter [name] Use the named sprite blitter (scalar, sse2, or avx2) instead of the fastest one.\n");
+	printf("  -c, --cache [num]    Memory limit of the sprite cache in MiB, 0 disables the cache (default 32).\n");
+	printf("  -m, --no-mmap        Read the RCD files instead of memory-mapping them.\n");
+}
+
+/**
+ * Main entry point of the benchmark program.
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return The exit code of the program.
+ */
+int main(int argc, char **argv)
+{
+	GetOptData opt_data(argc - 1, argv + 1, _options);
+
+	int opt_id;
+	uint scale = 1;
+	uint workers = GetDefaultWorkerCount();
+	const char *blitter = nullptr;
+	int sprite_cache_size = -1;
+	FILE *output = stdout;
+	do {
+		opt_id = opt_data.GetOpt();
+		switch (opt_id) {
+			case 'h':
+				PrintUsage();
+				return 0;
+			case 's':
+				scale = std::max(atoi(opt_data.opt), 1);
+				break;
+			case 'o':
+				/* Open the file before changing the working directory. */
+				output = fopen(opt_data.opt, "w");
+				if (output == nullptr) {
+					fprintf(stderr, "Could not open \"%s\" for writing.\n", opt_data.opt);
+					return 1;
+				}
+				break;
+			case 'j':
+				workers = std::max(atoi(opt_data.opt), 0);
+				break;
+			case 'b':
+				blitter = opt_data.opt;
+				break;
+			case 'c':
+				sprite_cache_size = std::max(atoi(opt_data.opt), 0);
+				break;
+
+			case 'm':
+				RcdFileReader::map_files = false;
+				break;
+
+			case -1:
+				break;
+
+			default:
+				fprintf(stderr, "ERROR while processing the command-line\n");
+				return 1;
+		}
+	} while (opt_id != -1);
+
+	ChangeWorkingDirectoryToExecutable(argv[0]);
+	_worker_pool.Start(workers);
+
+	InitImageStorage();
+	TimeBench("load-rcd-files", 0, 1, []() {
+		_rcd_collection.ScanDirectories();
+		_sprite_manager.LoadRcdFiles();
+	});
+	InitLanguage();
+	_video.InitializeOffscreen(800, 600);
+	if (blitter != nullptr && !SelectBlitter(blitter)) {
+		fprintf(stderr, "Blitter \"%s\" is not available.\n", blitter);
+		return 1;
+	}
+	if (sprite_cache_size >= 0) _sprite_cache.SetMemoryLimit(sprite_cache_size * 1024 * 1024);
+
+	_game_control.headless = true;
+	Random::SetSeed(BENCH_SEED);
+	LoadGameFile(nullptr); // Default-initialize everything.
+
+	static const int sizes[] = {16, 32, 64, std::min(WORLD_X_SIZE, WORLD_Y_SIZE) - 1}; // Biggest world is just below the limit.
+	for (int size : sizes) RunBenchmarks(size, scale);
+
+	WriteResults(output);
+	if (output != stdout) fclose(output);
+	_worker_pool.Stop();
+
+	UninitLanguage();
+	DestroyImageStorage();
+	_video.Shutdown();
+	return 0;
+}
@@ -0,0 +1,282 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file blitter.cpp Pixel kernels of the 32bpp sprite blitter. */
+
+#include "stdafx.h"
+#include "blitter.h"
+#include "palette.h"
+#include "math_func.h"
+
+/* The SSE2 and AVX2 kernels are compiled for their instruction set with function attributes, and selected at run time.
+ * The AVX2 kernels clear the upper halves of the registers before handling the last pixels with the scalar kernels,
+ * to avoid the penalty of switching from AVX to SSE instructions. */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define WITH_X86_BLITTERS
+#	include <immintrin.h>
+#endif
+
+/**
+ * Expand packed 3-byte RGB colours to fully opaque pixels.
+ * @param dst Destination of the pixels.
+ * @param rgb Colour bytes.
+ * @param count Number of pixels.
+ */
+static void ScalarExpandRgb(uint32 *dst, const uint8 *rgb, uint count)
+{
+	for (; count > 0; count--) {
+		*dst++ = MakeRGBA(rgb[0], rgb[1], rgb[2], OPAQUE);
+		rgb += 3;
+	}
+}
+
+/**
+ * Look up colours in a recolour table.
+ * @param dst Destination of the colours.
+ * @param indices Indices into the table.
+ * @param count Number of colours.
+ * @param table Recolour table.
+ */
+static void ScalarRecolour(uint32 *dst, const uint8 *indices, uint count, const uint32 *table)
+{
+	for (; count > 0; count--) *dst++ = table[*indices++];
+}
+
+/**
+ * Apply a gradient shift to a colour channel.
+ * @param col Channel value.
+ * @param delta Amount of change.
+ * @return Shifted channel value.
+ */
+static inline uint8 ShiftChannel(uint8 col, int delta)
+{
+	return Clamp(col + delta, 0, 255);
+}
+
+/**
+ * Apply a gradient shift to colours.
+ * @param colours Colours to change.
+ * @param count Number of colours.
+ * @param delta Amount of change of each channel.
+ */
+static void ScalarShift(uint32 *colours, uint count, int delta)
+{
+	for (; count > 0; count--) {
+		uint32 colour = *colours;
+		*colours++ = MakeRGBA(ShiftChannel(GetR(colour), delta), ShiftChannel(GetG(colour), delta), ShiftChannel(GetB(colour), delta), GetA(colour));
+	}
+}
+
+/**
+ * Blend colours with a constant opacity onto the screen.
+ * @param dst Pixels at the screen.
+ * @param colours Colours to blend with the screen.
+ * @param count Number of pixels.
+ * @param opacity Opacity of the colours.
+ */
+static void ScalarBlend(uint32 *dst, const uint32 *colours, uint count, uint opacity)
+{
+	for (; count > 0; count--) {
+		uint32 colour = *colours++;
+		uint32 old_pixel = *dst;
+		uint r = GetR(colour) * opacity + GetR(old_pixel) * (256 - opacity);
+		uint g = GetG(colour) * opacity + GetG(old_pixel) * (256 - opacity);
+		uint b = GetB(colour) * opacity + GetB(old_pixel) * (256 - opacity);
+		*dst++ = MakeRGBA(r >> 8, g >> 8, b >> 8, OPAQUE);
+	}
+}
+
+#ifdef WITH_X86_BLITTERS
+
+/**
+ * Get the vector to add to or subtract from pixels for a gradient shift, the alpha channel is not changed.
+ * @param delta Amount of change of each channel.
+ * @return Amount to add or subtract from each 32 bit pixel.
+ */
+static inline int32 GetShiftVector(int delta)
+{
+	uint32 amount = (delta < 0) ? -delta : delta;
+	return MakeRGBA(amount, amount, amount, 0);
+}
+
+/**
+ * Apply a gradient shift to colours with SSE2.
+ * @param colours Colours to change.
+ * @param count Number of colours.
+ * @param delta Amount of change of each channel.
+ */
+__attribute__((target("sse2"))) static void Sse2Shift(uint32 *colours, uint count, int delta)
+{
+	const __m128i amount = _mm_set1_epi32(GetShiftVector(delta));
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(colours + i));
+		c = (delta < 0) ? _mm_subs_epu8(c, amount) : _mm_adds_epu8(c, amount);
+		_mm_storeu_si128((__m128i *)(colours + i), c);
+	}
+	ScalarShift(colours + i, count - i, delta);
+}
+
+/**
+ * Blend colours with a constant opacity onto the screen with SSE2.
+ * @param dst Pixels at the screen.
+ * @param colours Colours to blend with the screen.
+ * @param count Number of pixels.
+ * @param opacity Opacity of the colours.
+ */
+__attribute__((target("sse2"))) static void Sse2Blend(uint32 *dst, const uint32 *colours, uint count, uint opacity)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(OPAQUE);
+	const __m128i op = _mm_set1_epi16(opacity);
+	const __m128i inv_op = _mm_set1_epi16(256 - opacity);
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(colours + i));
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		/* Channels are at most 255, the weighted sums fit in 16 bits. */
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), op), _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv_op));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), op), _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv_op));
+		__m128i result = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(result, alpha));
+	}
+	ScalarBlend(dst + i, colours + i, count - i, opacity);
+}
+
+/**
+ * Expand packed 3-byte RGB colours to fully opaque pixels with AVX2.
+ * @param dst Destination of the pixels.
+ * @param rgb Colour bytes.
+ * @param count Number of pixels.
+ */
+__attribute__((target("avx2"))) static void Avx2ExpandRgb(uint32 *dst, const uint8 *rgb, uint count)
+{
+	/* Move the r, g, b bytes of each 3-byte colour to the high three bytes of a pixel. */
+	const __m256i order = _mm256_setr_epi8(
+			-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9,
+			-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+	const __m256i alpha = _mm256_set1_epi32(OPAQUE);
+	uint i = 0;
+	/* Each half loads 16 bytes for 4 colours, stay within the colours and the byte after them. */
+	for (; i + 9 <= count; i += 8) {
+		const uint8 *src = rgb + 3 * i;
+		__m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)), _mm_loadu_si128((const __m128i *)(src + 12)), 1);
+		c = _mm256_or_si256(_mm256_shuffle_epi8(c, order), alpha);
+		_mm256_storeu_si256((__m256i *)(dst + i), c);
+	}
+	_mm256_zeroupper();
+	ScalarExpandRgb(dst + i, rgb + 3 * i, count - i);
+}
+
+/**
+ * Look up colours in a recolour table with AVX2.
+ * @param dst Destination of the colours.
+ * @param indices Indices into the table.
+ * @param count Number of colours.
+ * @param table Recolour table.
+ */
+__attribute__((target("avx2"))) static void Avx2Recolour(uint32 *dst, const uint8 *indices, uint count, const uint32 *table)
+{
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indices + i)));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_i32gather_epi32((const int *)table, index, 4));
+	}
+	_mm256_zeroupper();
+	ScalarRecolour(dst + i, indices + i, count - i, table);
+}
+
+/**
+ * Apply a gradient shift to colours with AVX2.
+ * @param colours Colours to change.
+ * @param count Number of colours.
+ * @param delta Amount of change of each channel.
+ */
+__attribute__((target("avx2"))) static void Avx2Shift(uint32 *colours, uint count, int delta)
+{
+	const __m256i amount = _mm256_set1_epi32(GetShiftVector(delta));
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i c = _mm256_loadu_si256((const __m256i *)(colours + i));
+		c = (delta < 0) ? _mm256_subs_epu8(c, amount) : _mm256_adds_epu8(c, amount);
+		_mm256_storeu_si256((__m256i *)(colours + i), c);
+	}
+	_mm256_zeroupper();
+	ScalarShift(colours + i, count - i, delta);
+}
+
+/**
+ * Blend colours with a constant opacity onto the screen with AVX2.
+ * @param dst Pixels at the screen.
+ * @param colours Colours to blend with the screen.
+ * @param count Number of pixels.
+ * @param opacity Opacity of the colours.
+ */
+__attribute__((target("avx2"))) static void Avx2Blend(uint32 *dst, const uint32 *colours, uint count, uint opacity)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i alpha = _mm256_set1_epi32(OPAQUE);
+	const __m256i op = _mm256_set1_epi16(opacity);
+	const __m256i inv_op = _mm256_set1_epi16(256 - opacity);
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i c = _mm256_loadu_si256((const __m256i *)(colours + i));
+		__m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+		/* Unpacking and packing work within each 128 bit half, which keeps the pixels in order. */
+		__m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zero), op), _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv_op));
+		__m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zero), op), _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv_op));
+		__m256i result = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(result, alpha));
+	}
+	_mm256_zeroupper();
+	ScalarBlend(dst + i, colours + i, count - i, opacity);
+}
+
+#endif
+
+/** Available blitter kernels, from fastest to slowest. The last entry works at every processor. */
+static const BlitterKernels _blitter_kernels[] = {
+#ifdef WITH_X86_BLITTERS
+	{"avx2",   Avx2ExpandRgb,   Avx2Recolour,   Avx2Shift,   Avx2Blend},
+	{"sse2",   ScalarExpandRgb, ScalarRecolour, Sse2Shift,   Sse2Blend},
+#endif
+	{"scalar", ScalarExpandRgb, ScalarRecolour, ScalarShift, ScalarBlend},
+};
+
+BlitterKernels _blitter = {"scalar", ScalarExpandRgb, ScalarRecolour, ScalarShift, ScalarBlend}; ///< Kernels in use by the sprite blitter.
+
+/**
+ * Can the processor run the given blitter kernels?
+ * @param kernels Kernels to check.
+ * @return Whether the kernels are supported.
+ */
+static bool IsSupported(const BlitterKernels &kernels)
+{
+#ifdef WITH_X86_BLITTERS
+	__builtin_cpu_init();
+	if (strcmp(kernels.name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+	if (strcmp(kernels.name, "sse2") == 0) return __builtin_cpu_supports("sse2");
+#endif
+	return true;
+}
+
+/**
+ * Select the kernels of the sprite blitter.
+ * @param name Name of the kernels to use, or \c nullptr for the fastest kernels supported by the processor.
+ * @return Whether the kernels were found and are supported by the processor.
+ */
+bool SelectBlitter(const char *name)
+{
+	for (const BlitterKernels &kernels : _blitter_kernels) {
+		if (name != nullptr && strcmp(name, kernels.name) != 0) continue;
+		if (!IsSupported(kernels)) continue;
+
+		_blitter = kernels;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file blitter.h Pixel kernels of the 32bpp sprite blitter. */
+
+#ifndef BLITTER_H
+#define BLITTER_H
+
+/**
+ * Kernels for blitting a run of pixels of a 32bpp sprite.
+ * Colour values are in the format of #MakeRGBA, the alpha channel of the colours given to the kernels is ignored.
+ */
+struct BlitterKernels {
+	const char *name; ///< Name of the kernels, for display.
+
+	/**
+	 * Expand packed 3-byte RGB colours to fully opaque pixels.
+	 * @param dst Destination of the pixels.
+	 * @param rgb Colour bytes, the byte after the last colour must be readable.
+	 * @param count Number of pixels.
+	 */
+	void (*expand_rgb)(uint32 *dst, const uint8 *rgb, uint count);
+
+	/**
+	 * Look up colours in a recolour table.
+	 * @param dst Destination of the colours.
+	 * @param indices Indices into the table.
+	 * @param count Number of colours.
+	 * @param table Recolour table with 256 entries.
+	 */
+	void (*recolour)(uint32 *dst, const uint8 *indices, uint count, const uint32 *table);
+
+	/**
+	 * Apply a gradient shift to the red, green, and blue channels of colours, saturating at \c 0 and \c 255.
+	 * @param colours Colours to change.
+	 * @param count Number of colours.
+	 * @param delta Amount of change of each channel, non-zero.
+	 */
+	void (*shift)(uint32 *colours, uint count, int delta);
+
+	/**
+	 * Blend colours with a constant opacity onto the pixels at the screen, see #BlendPixels.
+	 * @param dst Pixels at the screen, become fully opaque.
+	 * @param colours Colours to blend with the screen.
+	 * @param count Number of pixels.
+	 * @param opacity Opacity of the colours.
+	 */
+	void (*blend)(uint32 *dst, const uint32 *colours, uint count, uint opacity);
+};
+
+extern BlitterKernels _blitter;
+
+bool SelectBlitter(const char *name);
+
+#endif
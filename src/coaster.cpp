@@ -16,6 +16,7 @@
 #include "map.h"
 #include "people.h"
 #include "viewport.h"
+#include "gamecontrol.h"
 
 #include "generated/coasters_strings.cpp"
 
@@ -1327,7 +1328,7 @@ void CoasterInstance::Crash(CoasterTrain *t1, CoasterTrain *t2)
 	/* \todo Display animation of a big ball of fire. */
 	/* \todo Decrease ride excitement rating and park rating. */
 	printf("%d guests died in a ball of fire when %s crashed.\n", number_dead, this->name.get());  // \todo Show this as a message in-game.
-	ShowCoasterManagementGui(this);
+	if (!_game_control.headless) ShowCoasterManagementGui(this);
 }
 
 bool CoasterInstance::CanOpenRide() const
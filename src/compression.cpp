@@ -0,0 +1,291 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file compression.cpp Compression of data. */
+
+#include "stdafx.h"
+#include "compression.h"
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+/*
+ * The built-in LZ77 compression stores the data as a sequence of literal bytes followed by a match with earlier data.
+ * A sequence starts with a token byte, the high nibble is the number of literal bytes, and the low nibble the length of the match minus
+ * #LZ_MIN_MATCH. A nibble value of 15 is followed by extension bytes that are added to it, until an extension byte below 255.
+ * The literal bytes follow next, and then the 2 byte offset of the match, back from the current position.
+ * The last sequence has only literal bytes, it ends at the end of the compressed data.
+ */
+
+static const uint LZ_MIN_MATCH = 4;       ///< Minimal length of a match.
+static const uint LZ_MAX_OFFSET = 0xFFFF; ///< Maximal distance of a match.
+static const int LZ_HASH_BITS = 14;       ///< Number of bits of the hash of the 4 bytes at a position.
+static const uint LZ_MAX_RATIO = 255;     ///< Maximal number of decompressed bytes for each compressed byte.
+static const uint ZLIB_MAX_RATIO = 1032;  ///< Maximal number of decompressed bytes for each compressed byte of deflate data.
+
+/**
+ * Read 4 bytes of data as a number.
+ * @param data Data to read.
+ * @return The 4 bytes of the data.
+ */
+static inline uint32 LzRead32(const uint8 *data)
+{
+	uint32 value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+/**
+ * Compute the hash of 4 bytes of data.
+ * @param value The 4 bytes of data.
+ * @return Hash of the data.
+ */
+static inline uint32 LzHash(uint32 value)
+{
+	return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * Write the extension bytes of a length.
+ * @param length Remainder of the length after the nibble of the token.
+ * @param out Compressed data.
+ */
+static void LzPutLength(size_t length, std::vector<uint8> *out)
+{
+	while (length >= 255) {
+		out->push_back(255);
+		length -= 255;
+	}
+	out->push_back(length);
+}
+
+/**
+ * Write a sequence of literal bytes and a match.
+ * @param literals Literal bytes.
+ * @param literal_count Number of literal bytes.
+ * @param match Length of the match, \c 0 for the last sequence.
+ * @param offset Distance of the match back from the current position.
+ * @param out Compressed data.
+ */
+static void LzPutSequence(const uint8 *literals, size_t literal_count, size_t match, uint offset, std::vector<uint8> *out)
+{
+	size_t match_rest = (match > 0) ? match - LZ_MIN_MATCH : 0;
+	out->push_back((std::min<size_t>(literal_count, 15) << 4) | std::min<size_t>(match_rest, 15));
+	if (literal_count >= 15) LzPutLength(literal_count - 15, out);
+	out->insert(out->end(), literals, literals + literal_count);
+	if (match == 0) return;
+
+	out->push_back(offset);
+	out->push_back(offset >> 8);
+	if (match_rest >= 15) LzPutLength(match_rest - 15, out);
+}
+
+/**
+ * Compress data with the built-in LZ77 compression.
+ * @param data Data to compress.
+ * @param length Length of the data.
+ * @param out Compressed data.
+ */
+static void LzCompress(const uint8 *data, size_t length, std::vector<uint8> *out)
+{
+	std::vector<uint32> table(1 << LZ_HASH_BITS, UINT32_MAX); // Last position of each hash.
+	size_t anchor = 0; // Start of the literal bytes.
+	size_t pos = 0;
+	while (pos + LZ_MIN_MATCH <= length) {
+		uint32 value = LzRead32(data + pos);
+		uint32 hash = LzHash(value);
+		size_t candidate = table[hash];
+		table[hash] = pos;
+		if (candidate == UINT32_MAX || pos - candidate > LZ_MAX_OFFSET || LzRead32(data + candidate) != value) {
+			pos++;
+			continue;
+		}
+
+		size_t match = LZ_MIN_MATCH;
+		while (pos + match < length && data[candidate + match] == data[pos + match]) match++;
+		LzPutSequence(data + anchor, pos - anchor, match, pos - candidate, out);
+		pos += match;
+		anchor = pos;
+	}
+	LzPutSequence(data + anchor, length - anchor, 0, 0, out);
+}
+
+/**
+ * Read the extension bytes of a length.
+ * @param data Compressed data, moved past the extension bytes.
+ * @param end End of the compressed data.
+ * @param length Length to add the extension bytes to.
+ * @return Whether the extension bytes were read successfully.
+ */
+static bool LzGetLength(const uint8 **data, const uint8 *end, size_t *length)
+{
+	for (;;) {
+		if (*data == end) return false;
+		uint8 value = *(*data)++;
+		*length += value;
+		if (value < 255) return true;
+	}
+}
+
+/**
+ * Decompress data of the built-in LZ77 compression.
+ * @param data Compressed data.
+ * @param length Length of the compressed data.
+ * @param out Decompressed data.
+ * @param out_length Length of the decompressed data.
+ * @return Whether the data was decompressed successfully.
+ */
+static bool LzDecompress(const uint8 *data, size_t length, uint8 *out, size_t out_length)
+{
+	const uint8 *end = data + length;
+	uint8 *pos = out;
+	uint8 *out_end = out + out_length;
+	while (data < end) {
+		uint8 token = *data++;
+		size_t literal_count = token >> 4;
+		if (literal_count == 15 && !LzGetLength(&data, end, &literal_count)) return false;
+		if (literal_count > (size_t)(end - data) || literal_count > (size_t)(out_end - pos)) return false;
+		memcpy(pos, data, literal_count);
+		data += literal_count;
+		pos += literal_count;
+		if (data == end) break; // Last sequence.
+
+		if (end - data < 2) return false;
+		size_t offset = data[0] | (data[1] << 8);
+		data += 2;
+		size_t match = token & 15;
+		if (match == 15 && !LzGetLength(&data, end, &match)) return false;
+		match += LZ_MIN_MATCH;
+		if (offset == 0 || offset > (size_t)(pos - out) || match > (size_t)(out_end - pos)) return false;
+
+		const uint8 *src = pos - offset;
+		for (size_t i = 0; i < match; i++) pos[i] = src[i]; // Source and destination may overlap.
+		pos += match;
+	}
+	return pos == out_end;
+}
+
+/**
+ * Is a compression method available in this program?
+ * @param method Compression method to check.
+ * @return Whether data can be compressed and decompressed with the method.
+ */
+bool IsCompressionAvailable(CompressionMethod method)
+{
+	switch (method) {
+		case CM_NONE:
+		case CM_LZ:
+			return true;
+
+		case CM_ZLIB:
+#ifdef WITH_ZLIB
+			return true;
+#else
+			return false;
+#endif
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Get the compression method to use for compressing data.
+ * @return Zlib compression if available, else the built-in compression.
+ */
+CompressionMethod GetDefaultCompression()
+{
+	return IsCompressionAvailable(CM_ZLIB) ? CM_ZLIB : CM_LZ;
+}
+
+/**
+ * Compress data.
+ * @param method Compression method to use.
+ * @param data Data to compress.
+ * @param length Length of the data.
+ * @param out Compressed data.
+ * @pre The compression method must be available.
+ */
+void CompressData(CompressionMethod method, const uint8 *data, size_t length, std::vector<uint8> *out)
+{
+	assert(IsCompressionAvailable(method));
+	out->clear();
+	switch (method) {
+		case CM_NONE:
+			out->assign(data, data + length);
+			break;
+
+		case CM_LZ:
+			out->reserve(length / 2);
+			LzCompress(data, length, out);
+			break;
+
+#ifdef WITH_ZLIB
+		case CM_ZLIB: {
+			uLongf out_length = compressBound(length);
+			out->resize(out_length);
+			/* Saving speed matters more than the last bytes. The output is big enough, so compressing does not fail. */
+			if (compress2(out->data(), &out_length, data, length, Z_BEST_SPEED) != Z_OK) NOT_REACHED();
+			out->resize(out_length);
+			break;
+		}
+#endif
+
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Get the largest length that compressed data can decompress to.
+ * @param method Compression method of the data.
+ * @param length Length of the compressed data.
+ * @return Upper bound of the length of the decompressed data, \c 0 for unavailable compression methods.
+ */
+uint64 GetMaxDecompressedLength(CompressionMethod method, size_t length)
+{
+	switch (method) {
+		case CM_NONE: return length;
+		case CM_LZ:   return (uint64)length * LZ_MAX_RATIO;
+#ifdef WITH_ZLIB
+		case CM_ZLIB: return (uint64)length * ZLIB_MAX_RATIO;
+#endif
+		default:      return 0;
+	}
+}
+
+/**
+ * Decompress data.
+ * @param method Compression method of the data.
+ * @param data Compressed data.
+ * @param length Length of the compressed data.
+ * @param out Decompressed data.
+ * @param out_length Length of the decompressed data.
+ * @return Whether the data was decompressed successfully, which fails for unavailable compression methods or bad data.
+ */
+bool DecompressData(CompressionMethod method, const uint8 *data, size_t length, uint8 *out, size_t out_length)
+{
+	switch (method) {
+		case CM_NONE:
+			if (length != out_length) return false;
+			memcpy(out, data, length);
+			return true;
+
+		case CM_LZ:
+			return LzDecompress(data, length, out, out_length);
+
+#ifdef WITH_ZLIB
+		case CM_ZLIB: {
+			uLongf result_length = out_length;
+			return uncompress(out, &result_length, data, length) == Z_OK && result_length == out_length;
+		}
+#endif
+
+		default:
+			return false;
+	}
+}
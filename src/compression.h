@@ -0,0 +1,29 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file compression.h Compression of data. */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <vector>
+
+/** Methods of compressing data. The values are stored in save games. */
+enum CompressionMethod {
+	CM_NONE = 0, ///< Data is not compressed.
+	CM_LZ   = 1, ///< Built-in LZ77 compression, always available.
+	CM_ZLIB = 2, ///< Zlib compression, only available if the program was built with zlib.
+};
+
+bool IsCompressionAvailable(CompressionMethod method);
+CompressionMethod GetDefaultCompression();
+
+void CompressData(CompressionMethod method, const uint8 *data, size_t length, std::vector<uint8> *out);
+uint64 GetMaxDecompressedLength(CompressionMethod method, size_t length);
+bool DecompressData(CompressionMethod method, const uint8 *data, size_t length, uint8 *out, size_t out_length);
+
+#endif
@@ -11,6 +11,7 @@
 #include "window.h"
 #include "palette.h"
 #include "bitmath.h"
+#include "replay.h"
 
 /**
  * Defines a Dropdown menu item.
@@ -247,6 +248,7 @@ void RecolourDropdownWindow::OnClick(WidgetNumber widget, const Point16 &pos)
 		if (GB(this->entry->dest_set, widget - RD_BUTTON_00, 1) == 0) return;
 
 		if (this->entry->dest != widget - RD_BUTTON_00) {
+			_replay.RecordUnsupported("Changing colours");
 			this->entry->dest = static_cast<ColourRange>(widget - RD_BUTTON_00);
 			_video.MarkDisplayDirty();
 		}
@@ -245,13 +245,8 @@ void FenceGui::SelectorMouseButtonEvent(uint8 state)
 	if (!IsLeftClick(state)) return;
 	if (this->fence_sel.area.width != 1 || this->fence_sel.area.height != 1) return;
 	if (this->fence_edge == INVALID_EDGE) return;
-	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(this->fence_base.x, this->fence_base.y) != OWN_PARK) return;
 
-	VoxelStack *vs = _world.GetModifyStack(this->fence_base.x, this->fence_base.y);
-	uint16 fences = GetGroundFencesFromMap(vs, this->fence_base.z);
-	fences = SetFenceType(fences, this->fence_edge, this->fence_type);
-	AddGroundFencesToMap(fences, vs, this->fence_base.z);
-	MarkVoxelDirty(this->fence_base);
+	BuildFence(this->fence_base, this->fence_edge, this->fence_type);
 }
 
 /**
@@ -110,16 +110,37 @@ DirectoryReader *MakeDirectoryReader()
 #endif
 }
 
+MappedFile::MappedFile() : data(nullptr), size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+bool RcdFileReader::map_files = true;
+
 /**
  * RCD file reader constructor, loading data from a file.
  * @param fname Name of the file to load.
  */
 RcdFileReader::RcdFileReader(const char *fname)
 {
+	this->fp = nullptr;
 	this->file_pos = 0;
 	this->file_size = 0;
 	this->name[4] = '\0';
 
+	if (map_files) {
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (mapping->Open(fname)) {
+			this->file_size = mapping->size;
+			this->mapping = mapping;
+			return;
+		}
+	}
+
 	this->fp = fopen(fname, "rb");
 	if (this->fp == nullptr) return;
 
@@ -156,6 +177,11 @@ size_t RcdFileReader::GetRemaining()
  */
 uint8 RcdFileReader::GetUInt8()
 {
+	if (this->mapping != nullptr) {
+		uint8 val = (this->file_pos < this->file_size) ? this->mapping->data[this->file_pos] : 0;
+		this->file_pos++;
+		return val;
+	}
 	this->file_pos++;
 	return fgetc(this->fp);
 }
@@ -222,7 +248,7 @@ int32 RcdFileReader::GetInt32()
  */
 bool RcdFileReader::CheckFileHeader(const char *hdr_name, uint32 version)
 {
-	if (this->fp == nullptr) return false;
+	if (this->fp == nullptr && this->mapping == nullptr) return false;
 	if (this->GetRemaining() < 8) return false;
 
 	char name[5];
@@ -255,6 +281,7 @@ bool RcdFileReader::SkipBytes(uint32 count)
 {
 	this->file_pos += count;
 	if (this->file_pos > this->file_size) this->file_pos = this->file_size;
+	if (this->mapping != nullptr) return true;
 	return fseek(this->fp, this->file_pos, SEEK_SET) == 0;
 }
 
@@ -266,10 +293,31 @@ bool RcdFileReader::SkipBytes(uint32 count)
  */
 bool RcdFileReader::GetBlob(void *address, size_t length)
 {
+	if (this->mapping != nullptr) {
+		const uint8 *data = this->GetMappedBlob(length);
+		if (data == nullptr) return false;
+		memcpy(address, data, length);
+		return true;
+	}
 	this->file_pos += length;
 	return fread(address, length, 1, this->fp) == 1;
 }
 
+/**
+ * Get a blob of data from the memory mapping of the file, without copying it.
+ * @param length Length of the data.
+ * @return Address of the data in the mapping, or \c nullptr if the file is not memory-mapped (nothing is read then) or the data is not available.
+ * @note The data stays valid while the mapping exists, see #GetMapping.
+ */
+const uint8 *RcdFileReader::GetMappedBlob(size_t length)
+{
+	if (this->mapping == nullptr) return nullptr;
+	const uint8 *data = this->mapping->data + this->file_pos;
+	bool available = length <= this->GetRemaining();
+	this->file_pos += length;
+	return available ? data : nullptr;
+}
+
 /**
  * Attempts to change the working directory to one in which the executable resides in.
  * @param exe "Path" to the executable (from argv[0]).
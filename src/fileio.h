@@ -10,6 +10,8 @@
 #ifndef FILEIO_H
 #define FILEIO_H
 
+#include <memory>
+
 /**
  * Base class for reading the contents of a directory.
  * Intended use:
@@ -38,8 +40,25 @@ public:
 	const char dir_sep; ///< Directory separator character.
 };
 
+/**
+ * Read-only memory mapping of a file.
+ * @ingroup fileio_group
+ */
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const char *fname);
+	void Close();
+
+	const uint8 *data; ///< Contents of the mapped file, \c nullptr if no file is mapped.
+	size_t size;       ///< Size of the mapped file.
+};
+
 /**
  * Class for reading an RCD file.
+ * The file is memory-mapped if possible, so data can be used without copying it (see #GetMappedBlob).
  * @ingroup fileio_group
  */
 class RcdFileReader {
@@ -52,6 +71,16 @@ public:
 	bool SkipBytes(uint32 count);
 
 	bool GetBlob(void *address, size_t length);
+	const uint8 *GetMappedBlob(size_t length);
+
+	/**
+	 * Get the memory mapping of the file. Data of #GetMappedBlob stays valid while a reference to the mapping exists.
+	 * @return The mapping of the file, or \c nullptr if the file is not memory-mapped.
+	 */
+	inline const std::shared_ptr<const MappedFile> &GetMapping() const
+	{
+		return this->mapping;
+	}
 
 	uint8  GetUInt8();
 	uint16 GetUInt16();
@@ -66,14 +95,29 @@ public:
 	uint32 version; ///< Version number of the last found block (with #ReadBlockHeader).
 	uint32 size;    ///< Data size of the last found block (with #ReadBlockHeader).
 
+	/**
+	 * Get the position in the file.
+	 * @return Offset of the next byte to read.
+	 */
+	inline size_t GetPosition() const
+	{
+		return this->file_pos;
+	}
+
+	static bool map_files; ///< Whether to memory-map the files, else they are read with stdio.
+
 private:
-	FILE *fp;         ///< File handle of the opened file.
+	FILE *fp;         ///< File handle of the opened file, \c nullptr if the file is memory-mapped.
+	std::shared_ptr<const MappedFile> mapping; ///< Memory mapping of the opened file, if available.
 	size_t file_pos;  ///< Position in the opened file.
 	size_t file_size; ///< Size of the opened file.
 };
 
 bool PathIsFile(const char *path);
 bool PathIsDirectory(const char *path);
+bool RenameFile(const char *from, const char *to);
+bool SyncFile(FILE *fp);
+char *MakeAbsolutePath(const char *path);
 
 DirectoryReader *MakeDirectoryReader();
 
@@ -68,6 +68,15 @@ public:
 
 	void DoTransaction(const Money &income);
 
+	/**
+	 * Get the amount of cash of the user.
+	 * @return Current cash.
+	 */
+	inline const Money &GetCash() const
+	{
+		return this->cash;
+	}
+
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
 
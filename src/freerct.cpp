@@ -21,6 +21,15 @@
 #include "fileio.h"
 #include "gamecontrol.h"
 #include "string_func.h"
+#include "loadsave.h"
+#include "person.h"
+#include "people.h"
+#include "finances.h"
+#include "dates.h"
+#include "worker_pool.h"
+#include "replay.h"
+#include <chrono>
+#include <cctype>
 
 GameControl _game_control; ///< Game controller.
 
@@ -45,6 +54,14 @@ static const OptionData _options[] = {
 	GETOPT_NOVAL('h', "--help"),
 	GETOPT_VALUE('l', "--load"),
 	GETOPT_VALUE('a', "--language"),
+	GETOPT_NOVAL('x', "--headless"),
+	GETOPT_VALUE('t', "--ticks"),
+	GETOPT_VALUE('s', "--save"),
+	GETOPT_VALUE('j', "--threads"),
+	GETOPT_VALUE('e', "--seed"),
+	GETOPT_VALUE('r', "--record"),
+	GETOPT_VALUE('p', "--replay"),
+	GETOPT_VALUE('A', "--autosave"),
 	GETOPT_END()
 };
 
@@ -56,6 +73,14 @@ static void PrintUsage()
 	printf("  -h, --help           Display this help text and exit.\n");
 	printf("  -l, --load [file]    Load game from specified file.\n");
 	printf("  -a, --language lang  Use the specified language.\n");
+	printf("  -x, --headless       Run the simulation without display.\n");
+	printf("  -t, --ticks [num]    Number of ticks to simulate in headless mode (default 1000).\n");
+	printf("  -s, --save [file]    Save the game to the specified file after a headless run.\n");
+	printf("  -j, --threads [num]  Number of worker threads (default one less than the number of processors).\n");
+	printf("  -e, --seed [num]     Master seed of the random generators in a new game (default based on the time).\n");
+	printf("  -r, --record [file]  Record the player commands of the new game in the specified replay file.\n");
+	printf("  -p, --replay [file]  Play the player commands of the specified replay file in a new game.\n");
+	printf("  -A, --autosave [num] Autosave the game every [num] months in %s (default 0, never).\n", AUTOSAVE_FILENAME);
 
 	printf("\nValid languages are:\n   ");
 	int length = 0;
@@ -78,6 +103,58 @@ void ShowGraphicsErrorMessage()
 	ShowErrorMessage(GUI_ERROR_MESSAGE_SPRITE);
 }
 
+/**
+ * Parse a non-negative number of the command line.
+ * @param text Text of the number.
+ * @param value [out] Parsed number, if the text is valid.
+ * @return Whether the text is a valid number.
+ */
+static bool ParseNumber(const char *text, uint32 *value)
+{
+	char *end;
+	unsigned long number = strtoul(text, &end, 0);
+	if (!isdigit((unsigned char)*text) || *end != '\0' || number > UINT32_MAX) return false;
+	*value = number;
+	return true;
+}
+
+/**
+ * Run the simulation without display as fast as possible, and print statistics of the run.
+ * @param ticks Number of ticks to simulate.
+ * @param save_name If not \c nullptr, name of the file to save the resulting game in.
+ * @return Exit code of the program.
+ */
+static int RunHeadless(uint32 ticks, const char *save_name)
+{
+	auto start = std::chrono::steady_clock::now();
+	uint32 done = 0; // Number of simulated ticks, less than requested if the game stopped early.
+	while (done < ticks && _game_control.running) {
+		OnNewFrame(FRAME_DELAY);
+		_game_control.DoNextAction();
+		done++;
+	}
+	auto stop = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double, std::milli>(stop - start).count();
+
+	printf("ticks: %u\n", done);
+	printf("elapsed-ms: %.1f\n", elapsed);
+	printf("ticks-per-second: %.1f\n", (elapsed > 0) ? done * 1000.0 / elapsed : 0.0);
+	printf("date: %d-%02d-%02d\n", _date.year, _date.month, _date.day);
+	printf("active-guests: %u\n", _guests.CountActiveGuests());
+	printf("guests-in-park: %u\n", _guests.CountGuestsInPark());
+	printf("guests-queuing: %u\n", _guests.CountQueuingGuests());
+	printf("guests-leaving: %u\n", _guests.CountLeavingGuests());
+	printf("cash: %lld\n", (long long)_finances_manager.GetCash());
+	printf("checksum: %08x\n", ComputeGameChecksum());
+	if (_replay.IsReplaying()) printf("replay-mismatches: %u\n", _replay.mismatches);
+
+	if (save_name != nullptr && !SaveGameFile(save_name)) {
+		fprintf(stderr, "Failed to save the game to \"%s\"\n", save_name);
+		return 1;
+	}
+	return 0;
+}
+
 /**
  * Main entry point of our FreeRCT game.
  * @param argc Argument count.
@@ -91,6 +168,12 @@ int freerct_main(int argc, char **argv)
 	int opt_id;
 	const char *file_name = nullptr;
 	const char *preferred_language = nullptr;
+	const char *save_name = nullptr;
+	const char *record_name = nullptr;
+	const char *replay_name = nullptr;
+	bool headless = false;
+	uint32 ticks = 1000;
+	uint workers = GetDefaultWorkerCount();
 	do {
 		opt_id = opt_data.GetOpt();
 		switch (opt_id) {
@@ -105,6 +188,41 @@ int freerct_main(int argc, char **argv)
 					file_name = StrDup(opt_data.opt);
 				}
 				break;
+			case 'x':
+				headless = true;
+				break;
+			case 't':
+				if (!ParseNumber(opt_data.opt, &ticks)) {
+					fprintf(stderr, "ERROR while processing the command-line: Invalid number of ticks \"%s\"\n", opt_data.opt);
+					return 1;
+				}
+				break;
+			case 's':
+				/* The working directory changes to the one of the executable before saving. */
+				save_name = MakeAbsolutePath(opt_data.opt);
+				break;
+			case 'j':
+				workers = std::max(atoi(opt_data.opt), 0);
+				break;
+			case 'e':
+				_game_control.seed = strtoul(opt_data.opt, nullptr, 0);
+				_game_control.seed_set = true;
+				break;
+			case 'r':
+				record_name = StrDup(opt_data.opt);
+				break;
+			case 'p':
+				replay_name = StrDup(opt_data.opt);
+				break;
+			case 'A': {
+				uint32 months;
+				if (!ParseNumber(opt_data.opt, &months)) {
+					fprintf(stderr, "ERROR while processing the command-line: Invalid autosave interval \"%s\"\n", opt_data.opt);
+					return 1;
+				}
+				_game_control.autosave_interval = months;
+				break;
+			}
 
 			case -1:
 				break;
@@ -116,9 +234,27 @@ int freerct_main(int argc, char **argv)
 		}
 	} while (opt_id != -1);
 
+	/* Open the replay files before changing the working directory. */
+	bool replay_ok = true;
+	if (record_name != nullptr) {
+		replay_ok = _replay.StartRecording(record_name);
+		if (!replay_ok) fprintf(stderr, "Could not open replay \"%s\" for writing.\n", record_name);
+		delete[] record_name;
+	} else if (replay_name != nullptr) {
+		replay_ok = _replay.LoadReplay(replay_name);
+		delete[] replay_name;
+	}
+	if (!replay_ok) return 1;
+
+	/* Autosave in the starting directory rather than next to the executable. */
+	char *autosave_name = MakeAbsolutePath(AUTOSAVE_FILENAME);
+	_game_control.autosave_name = autosave_name;
+	delete[] autosave_name;
+
 	ConfigFile cfg_file;
 
 	ChangeWorkingDirectoryToExecutable(argv[0]);
+	_worker_pool.Start(workers);
 
 	/* Load RCD files. */
 	InitImageStorage();
@@ -132,6 +268,24 @@ int freerct_main(int argc, char **argv)
 		return 1;
 	}
 
+	if (headless) {
+		_game_control.headless = true;
+		_game_control.Initialize(file_name);
+		delete[] file_name;
+
+		int ret = RunHeadless(ticks, save_name);
+		delete[] save_name;
+		delete[] preferred_language;
+
+		_game_control.Uninitialize();
+		_replay.Stop();
+		_worker_pool.Stop();
+		UninitLanguage();
+		DestroyImageStorage();
+		return ret;
+	}
+	delete[] save_name;
+
 	cfg_file.Load("freerct.cfg");
 	const char *font_path = cfg_file.GetValue("font", "medium-path");
 	int font_size = cfg_file.GetNum("font", "medium-size");
@@ -189,6 +343,8 @@ int freerct_main(int argc, char **argv)
 	_video.MainLoop();
 
 	_game_control.Uninitialize();
+	_replay.Stop();
+	_worker_pool.Stop();
 
 	UninitLanguage();
 	DestroyImageStorage();
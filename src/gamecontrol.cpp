@@ -18,6 +18,10 @@
 #include "viewport.h"
 #include "weather.h"
 #include "freerct.h"
+#include "random.h"
+#include "replay.h"
+#include <algorithm>
+#include <ctime>
 
 GameModeManager _game_mode_mgr; ///< Game mode manager object.
 
@@ -32,6 +36,7 @@ void OnNewMonth()
 {
 	_finances_manager.AdvanceMonth();
 	_rides_manager.OnNewMonth();
+	_game_control.OnNewMonth();
 }
 
 /** Runs various procedures that have to be done daily. */
@@ -40,6 +45,8 @@ void OnNewDay()
 	_rides_manager.OnNewDay();
 	_guests.OnNewDay();
 	_weather.OnNewDay();
+	_replay.OnNewDay();
+	_game_control.OnNewDay();
 	NotifyChange(WC_BOTTOM_TOOLBAR, ALL_WINDOWS_OF_TYPE, CHG_DISPLAY_OLD, 0);
 }
 
@@ -56,6 +63,7 @@ static int speed_factor(GameSpeed speed)
 		case GSP_2:     return 2;
 		case GSP_4:     return 4;
 		case GSP_8:     return 8;
+		case GSP_TURBO: return 8; // Only used by fixed frames, the #FrameScheduler runs ticks as fast as possible.
 		default:       NOT_REACHED();
 	}
 }
@@ -66,21 +74,131 @@ static int speed_factor(GameSpeed speed)
 */
 void OnNewFrame(const uint32 frame_delay)
 {
-	_window_manager.Tick();
-	for (int i = speed_factor(_game_control.speed); i > 0; i--) {
-		_guests.DoTick();
-		DateOnTick();
-		_guests.OnAnimate(frame_delay);
-		_rides_manager.OnAnimate(frame_delay);
+	if (!_game_control.headless) _window_manager.Tick();
+	for (int i = speed_factor(_game_control.speed); i > 0; i--) OnSimulationTick(frame_delay);
+}
+
+/**
+ * Run a single tick of the simulation.
+ * @param frame_delay Number of milliseconds of game time of the tick.
+ */
+void OnSimulationTick(const uint32 frame_delay)
+{
+	_replay.OnTick();
+	_guests.DoTick();
+	DateOnTick();
+	_guests.OnAnimate(frame_delay);
+	_rides_manager.OnAnimate(frame_delay);
+}
+
+FrameScheduler::FrameScheduler()
+{
+	this->Reset();
+}
+
+/** Start scheduling from the current time, without any simulation being due. */
+void FrameScheduler::Reset()
+{
+	this->last_update = Clock::now();
+	this->last_frame = this->last_update;
+	this->sim_time = 0;
+	this->skipped = 0;
+}
+
+/**
+ * Run the simulation ticks that are due, and redraw the display if it is time to do so.
+ * Returns after at most a frame, so input can be handled in between.
+ */
+void FrameScheduler::Run()
+{
+	const Clock::duration frame_delay = std::chrono::milliseconds(FRAME_DELAY);
+	const int64 tick_time = FRAME_DELAY * 1000;
+	Clock::time_point now = Clock::now();
+
+	if (_game_control.speed == GSP_TURBO) {
+		const Clock::duration turbo_delay = std::chrono::milliseconds(TURBO_FRAME_DELAY);
+		Clock::time_point stop = std::min(this->last_frame + turbo_delay, now + frame_delay);
+		do {
+			OnSimulationTick(FRAME_DELAY);
+			now = Clock::now();
+		} while (now < stop);
+
+		this->last_update = now;
+		this->sim_time = 0;
+		if (now - this->last_frame >= turbo_delay) this->Redraw(now, frame_delay);
+		return;
+	}
+
+	/* Time spent outside the scheduler (such as loading a game) is only partly caught up. */
+	int64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - this->last_update).count();
+	elapsed = std::min<int64>(elapsed, (MAX_SKIPPED_FRAMES + 1) * tick_time);
+	this->sim_time += elapsed * speed_factor(_game_control.speed);
+	this->last_update = now;
+
+	Clock::time_point stop = now + frame_delay;
+	while (this->sim_time >= tick_time) {
+		OnSimulationTick(FRAME_DELAY);
+		this->sim_time -= tick_time;
+		now = Clock::now();
+		if (now >= stop) break;
 	}
+
+	if (now - this->last_frame < frame_delay) return;
+	if (this->sim_time >= tick_time) { // Simulation is behind.
+		if (this->skipped < MAX_SKIPPED_FRAMES) {
+			this->skipped++;
+			return;
+		}
+		this->sim_time %= tick_time; // Give up catching up, the game runs slower instead.
+	}
+	this->Redraw(now, frame_delay);
+}
+
+/**
+ * Redraw the display.
+ * @param now Current time.
+ * @param frame_delay Time of a frame.
+ */
+void FrameScheduler::Redraw(Clock::time_point now, Clock::duration frame_delay)
+{
+	uint frames = std::max<uint>((now - this->last_frame) / frame_delay, 1);
+	this->last_frame = now;
+	this->skipped = 0;
+	if (!_game_control.headless) _window_manager.Tick(frames);
+}
+
+/**
+ * Get the time until the next simulation tick or redraw is due.
+ * @return Number of milliseconds the main loop may wait.
+ */
+uint32 FrameScheduler::GetDelay() const
+{
+	if (_game_control.speed == GSP_TURBO) return 0;
+
+	Clock::time_point next = this->last_frame + std::chrono::milliseconds(FRAME_DELAY);
+	int factor = speed_factor(_game_control.speed);
+	if (factor > 0) {
+		int64 remaining = std::max<int64>(FRAME_DELAY * 1000 - this->sim_time, 0) / factor;
+		next = std::min(next, this->last_update + std::chrono::microseconds(remaining));
+	}
+
+	Clock::time_point now = Clock::now();
+	if (next <= now) return 0;
+	return std::chrono::duration_cast<std::chrono::milliseconds>(next - now + std::chrono::microseconds(999)).count();
 }
 
 GameControl::GameControl()
 {
 	this->speed = GSP_1;
 	this->running = false;
+	this->headless = false;
 	this->next_action = GCA_NONE;
 	this->fname = "";
+	this->seed = 0;
+	this->seed_set = false;
+	this->autosave_interval = 0;
+	this->autosave_name = AUTOSAVE_FILENAME;
+	this->autosave_months = 0;
 }
 
 GameControl::~GameControl()
@@ -105,6 +223,7 @@ void GameControl::Initialize(const char *fname)
 /** Uninitialize the game controller. */
 void GameControl::Uninitialize()
 {
+	this->saver.Wait();
 	this->ShutdownLevel();
 }
 
@@ -117,21 +236,26 @@ void GameControl::RunAction()
 	switch (this->next_action) {
 		case GCA_NEW_GAME:
 		case GCA_LOAD_GAME:
+			this->saver.Wait(); // Do not load the file while it is being written.
 			this->ShutdownLevel();
 
 			if (this->next_action == GCA_NEW_GAME || !LoadGameFile(this->fname.c_str())) {
 				LoadGameFile(nullptr);  // Default-initialize everything.
 				this->NewLevel();
+			} else {
+				_replay.Stop(); // Replays always start with a new game.
 			}
 
+			this->autosave_months = 0;
 			this->StartLevel();
 			break;
 
 		case GCA_SAVE_GAME:
-			SaveGameFile(this->fname.c_str());
+			this->saver.Start(this->fname.c_str());
 			break;
-		
+
 		case GCA_QUIT:
+			this->saver.Wait();
 			this->running = false;
 			break;
 
@@ -174,10 +298,39 @@ void GameControl::QuitGame()
 	this->next_action = GCA_QUIT;
 }
 
+/** Finish a save in the background when it is done. */
+void GameControl::OnNewDay()
+{
+	this->saver.Poll();
+}
+
+/**
+ * Autosave the game when it is time to do so.
+ * The game is saved in the background, the simulation only pauses to take a snapshot of the game state.
+ * While a previous save is still being written, the autosave is postponed to the next month.
+ */
+void GameControl::OnNewMonth()
+{
+	if (this->headless || this->autosave_interval == 0) return;
+
+	if (this->autosave_months < this->autosave_interval) this->autosave_months++;
+	if (this->autosave_months < this->autosave_interval) return;
+
+	this->saver.Poll();
+	if (this->saver.IsBusy()) return;
+	this->autosave_months = 0;
+	this->saver.Start(this->autosave_name.c_str());
+}
+
 /** Initialize all game data structures for playing a new game. */
 void GameControl::NewLevel()
 {
 	/// \todo We blindly assume game data structures are all clean.
+	uint32 game_seed = this->seed_set ? this->seed : static_cast<uint32>(time(nullptr));
+	if (_replay.IsReplaying()) game_seed = _replay.seed;
+	Random::SetSeed(game_seed);
+	_replay.StartGame(game_seed);
+
 	_world.SetWorldSize(20, 21);
 	_world.MakeFlatWorld(8);
 	_world.SetTileOwnerGlobally(OWN_NONE);
@@ -195,6 +348,7 @@ void GameControl::StartLevel()
 {
 	_game_mode_mgr.SetGameMode(GM_PLAY);
 	this->speed = GSP_1;
+	if (this->headless) return; // No windows without display.
 
 	XYZPoint32 view_pos(_world.GetXSize() * 256 / 2, _world.GetYSize() * 256 / 2, 8 * 256);
 	ShowMainDisplay(view_pos);
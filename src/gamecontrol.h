@@ -10,10 +10,18 @@
 #ifndef GAMECONTROL_H
 #define GAMECONTROL_H
 
+#include "loadsave.h"
+#include <chrono>
+
 void OnNewDay();
 void OnNewMonth();
 void OnNewYear();
 void OnNewFrame(uint32 frame_delay);
+void OnSimulationTick(uint32 frame_delay);
+
+static const uint32 FRAME_DELAY = 30;        ///< Number of milliseconds between two frames.
+static const uint32 TURBO_FRAME_DELAY = 250; ///< Number of milliseconds between two redraws at #GSP_TURBO speed.
+static const char * const AUTOSAVE_FILENAME = "autosave.fct"; ///< Name of the file of the autosaved game.
 
 /** Actions that can be run to control the game. */
 enum GameControlAction {
@@ -31,6 +39,7 @@ enum GameSpeed {
 	GSP_2,      ///< Double speed.
 	GSP_4,      ///< 4 times speed.
 	GSP_8,      ///< 8 times speed.
+	GSP_TURBO,  ///< As fast as possible.
 	GSP_COUNT   ///< Number of entries.
 };
 
@@ -58,9 +67,17 @@ public:
 	void SaveGame(const std::string &fname);
 	void QuitGame();
 
-	bool running; ///< Indicates whether a game is currently running.
+	void OnNewDay();
+	void OnNewMonth();
+
+	bool running;  ///< Indicates whether a game is currently running.
+	bool headless; ///< The game runs without display, only the simulation is performed.
 
 	GameSpeed speed;  ///< Speed of the game.
+	uint32 seed;      ///< Master seed of the random generators in a new game, only used if #seed_set holds.
+	bool seed_set;    ///< Whether #seed is set, else a new game uses a seed based on the current time.
+	uint autosave_interval; ///< Number of months between two autosaves, \c 0 disables autosaving.
+	std::string autosave_name; ///< Name of the file of the autosaved game.
 
 private:
 	void RunAction();
@@ -70,10 +87,38 @@ private:
 
 	GameControlAction next_action; ///< Action game control wants to run, or #GCA_NONE for 'no action'.
 	std::string fname;             ///< Filename of game level to load from or save to.
+	BackgroundSaver saver;         ///< Saver of the game in the background.
+	uint autosave_months;          ///< Number of months since the previous autosave.
 };
 
 extern GameControl _game_control;
 
+/**
+ * Scheduler of the main loop, running the simulation at the rate of the game speed, independent of redrawing the display.
+ * The display is redrawn at most once every #FRAME_DELAY milliseconds. When the simulation falls behind, redraws are skipped
+ * to let it catch up. At #GSP_TURBO speed, ticks run as fast as possible, and the display is redrawn every #TURBO_FRAME_DELAY milliseconds.
+ */
+class FrameScheduler {
+public:
+	static const uint MAX_SKIPPED_FRAMES = 4; ///< Maximal number of redraws in a row skipped to let the simulation catch up.
+
+	FrameScheduler();
+
+	void Reset();
+	void Run();
+	uint32 GetDelay() const;
+
+private:
+	typedef std::chrono::steady_clock Clock; ///< Clock of the scheduler.
+
+	void Redraw(Clock::time_point now, Clock::duration frame_delay);
+
+	Clock::time_point last_update; ///< Time of the previous update of #sim_time.
+	Clock::time_point last_frame;  ///< Time of the previous redraw.
+	int64 sim_time;                ///< Game time due to be simulated, in microseconds.
+	uint skipped;                  ///< Number of redraws skipped in a row.
+};
+
 /**
  * The current game mode controls what user operations that are allowed
  * and not. In Game mode most construction operations are limited to
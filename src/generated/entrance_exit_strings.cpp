@@ -0,0 +1,11 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+/** EntranceExit string table array. */
+const char *_entrance_exit_strings_table[] = {
+	"NAME",
+	"DESCRIPTION_RECOLOUR1",
+	"DESCRIPTION_RECOLOUR2",
+	"DESCRIPTION_RECOLOUR3",
+	nullptr,
+};
@@ -0,0 +1,17 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+#ifndef ENTRANCE_EXIT_STRING_TABLE_H
+#define ENTRANCE_EXIT_STRING_TABLE_H
+
+/** EntranceExit strings table. */
+enum EntranceExitStrings {
+	ENTRANCE_EXIT_NAME = STR_GENERIC_ENTRANCE_EXIT_START,
+	ENTRANCE_EXIT_DESCRIPTION_RECOLOUR1,
+	ENTRANCE_EXIT_DESCRIPTION_RECOLOUR2,
+	ENTRANCE_EXIT_DESCRIPTION_RECOLOUR3,
+
+	ENTRANCE_EXIT_STRING_TABLE_END,
+};
+
+#endif
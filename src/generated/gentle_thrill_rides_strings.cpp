@@ -0,0 +1,14 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+/** GentleThrillRides string table array. */
+const char *_gentle_thrill_rides_strings_table[] = {
+	"NAME_INSTANCE1",
+	"NAME_INSTANCE2",
+	"NAME_TYPE",
+	"DESCRIPTION_TYPE",
+	"DESCRIPTION_RECOLOUR1",
+	"DESCRIPTION_RECOLOUR2",
+	"DESCRIPTION_RECOLOUR3",
+	nullptr,
+};
@@ -0,0 +1,20 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+#ifndef GENTLE_THRILL_RIDES_STRING_TABLE_H
+#define GENTLE_THRILL_RIDES_STRING_TABLE_H
+
+/** GentleThrillRides strings table. */
+enum GentleThrillRidesStrings {
+	GENTLE_THRILL_RIDES_NAME_INSTANCE1 = STR_GENERIC_GENTLE_THRILL_RIDES_START,
+	GENTLE_THRILL_RIDES_NAME_INSTANCE2,
+	GENTLE_THRILL_RIDES_NAME_TYPE,
+	GENTLE_THRILL_RIDES_DESCRIPTION_TYPE,
+	GENTLE_THRILL_RIDES_DESCRIPTION_RECOLOUR1,
+	GENTLE_THRILL_RIDES_DESCRIPTION_RECOLOUR2,
+	GENTLE_THRILL_RIDES_DESCRIPTION_RECOLOUR3,
+
+	GENTLE_THRILL_RIDES_STRING_TABLE_END,
+};
+
+#endif
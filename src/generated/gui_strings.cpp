@@ -0,0 +1,187 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+/** Gui string table array. */
+const char *_gui_strings_table[] = {
+	"TITLEBAR_TIP",
+	"LANGUAGE_NAME",
+	"MONTH_JANUARY",
+	"MONTH_FEBRUARY",
+	"MONTH_MARCH",
+	"MONTH_APRIL",
+	"MONTH_MAY",
+	"MONTH_JUNE",
+	"MONTH_JULY",
+	"MONTH_AUGUST",
+	"MONTH_SEPTEMBER",
+	"MONTH_OCTOBER",
+	"MONTH_NOVEMBER",
+	"MONTH_DECEMBER",
+	"NUMBERED_INSTANCE_NAME",
+	"RESOLUTION",
+	"TOOLBAR_GUI_DROPDOWN_MAIN",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_TOOLTIP",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_QUIT",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_SETTINGS",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_MODE",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_NEW_GAME",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_SAVE",
+	"TOOLBAR_GUI_DROPDOWN_MAIN_LOAD",
+	"TOOLBAR_GUI_DROPDOWN_SPEED",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_TOOLTIP",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_PAUSE",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_1",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_2",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_4",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_8",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_TURBO",
+	"TOOLBAR_GUI_GAME_MODE_EDITOR",
+	"TOOLBAR_GUI_GAME_MODE_PLAY",
+	"TOOLBAR_GUI_PATHS",
+	"TOOLBAR_GUI_TOOLTIP_BUILD_PATHS",
+	"TOOLBAR_GUI_RIDE_SELECT",
+	"TOOLBAR_GUI_TOOLTIP_RIDE_SELECT",
+	"TOOLBAR_GUI_FENCE",
+	"TOOLBAR_GUI_TOOLTIP_FENCE",
+	"TOOLBAR_GUI_TERRAFORM",
+	"TOOLBAR_GUI_TOOLTIP_TERRAFORM",
+	"TOOLBAR_GUI_FINANCES",
+	"TOOLBAR_GUI_TOOLTIP_FINANCES",
+	"BOTTOMBAR_GUESTCOUNT",
+	"QUIT_CAPTION",
+	"QUIT_MESSAGE",
+	"QUIT_NO",
+	"QUIT_YES",
+	"ERROR_MESSAGE_CAPTION",
+	"ERROR_MESSAGE_SPRITE",
+	"GUEST_INFO_MONEY",
+	"GUEST_INFO_MONEY_SPENT",
+	"GUEST_INFO_HAPPINESS",
+	"GUEST_INFO_HUNGER",
+	"GUEST_INFO_THIRST",
+	"GUEST_INFO_WASTE",
+	"GUEST_INFO_ITEMS",
+	"ITEM_NONE",
+	"ITEM_MAP",
+	"ITEM_UMBRELLA",
+	"ITEM_WRAPPER",
+	"PATH_GUI_TITLE",
+	"PATH_GUI_LONG",
+	"PATH_GUI_BUY",
+	"PATH_GUI_REMOVE",
+	"PATH_GUI_LONG_TIP",
+	"PATH_GUI_BUY_TIP",
+	"PATH_GUI_BULLDOZER_TIP",
+	"PATH_GUI_SLOPE_DOWN_TIP",
+	"PATH_GUI_SLOPE_FLAT_TIP",
+	"PATH_GUI_SLOPE_UP_TIP",
+	"PATH_GUI_FORWARD",
+	"PATH_GUI_BACKWARD",
+	"PATH_GUI_FORWARD_TIP",
+	"PATH_GUI_BACKWARD_TIP",
+	"PATH_GUI_NW_DIRECTION_TIP",
+	"PATH_GUI_NE_DIRECTION_TIP",
+	"PATH_GUI_SW_DIRECTION_TIP",
+	"PATH_GUI_SE_DIRECTION_TIP",
+	"PATH_GUI_NORMAL_PATH",
+	"PATH_GUI_QUEUE_PATH",
+	"PATH_GUI_SINGLE",
+	"PATH_GUI_DIRECTIONAL",
+	"PATH_GUI_SINGLE_TIP",
+	"PATH_GUI_DIRECTIONAL_TIP",
+	"RIDE_SELECT_TITLE",
+	"RIDE_SELECT_SHOPS",
+	"RIDE_SELECT_SHOPS_TOOLTIP",
+	"RIDE_SELECT_GENTLE",
+	"RIDE_SELECT_GENTLE_TOOLTIP",
+	"RIDE_SELECT_THRILL",
+	"RIDE_SELECT_THRILL_TOOLTIP",
+	"RIDE_SELECT_WET",
+	"RIDE_SELECT_WET_TOOLTIP",
+	"RIDE_SELECT_COASTER",
+	"RIDE_SELECT_COASTER_TOOLTIP",
+	"RIDE_SELECT_RIDE",
+	"RIDE_SELECT_RIDE_TOOLTIP",
+	"RIDE_SELECT_ROT_POS_TOOLTIP",
+	"RIDE_SELECT_ROT_NEG_TOOLTIP",
+	"SHOP_MANAGER_TITLE",
+	"SHOP_MANAGER_COST_PRICE_TEXT",
+	"SHOP_MANAGER_SELLING_PRICE_TEXT",
+	"SHOP_MANAGER_ITEMS_SOLD_TEXT",
+	"SHOP_MANAGER_ITEM_PROFIT_TEXT",
+	"SHOP_MANAGER_SELL_PROFIT_TEXT",
+	"SHOP_MANAGER_SHOP_COST_TEXT",
+	"SHOP_MANAGER_TOTAL_PROFIT_TEXT",
+	"SHOP_MANAGER_OPENED_TEXT",
+	"SHOP_MANAGER_CLOSED_TEXT",
+	"GENTLE_THRILL_RIDES_MANAGER_TITLE",
+	"GENTLE_RIDES_MANAGER_TITLE",
+	"THRILL_RIDES_MANAGER_TITLE",
+	"GENTLE_THRILL_RIDES_MANAGER_OPENED_TEXT",
+	"GENTLE_THRILL_RIDES_MANAGER_CLOSED_TEXT",
+	"GENTLE_THRILL_RIDES_MANAGER_ENTRANCE_FEE_TEXT",
+	"GENTLE_THRILL_RIDES_MANAGER_MONTHLY_COST_TEXT",
+	"FENCE_TITLE",
+	"TERRAFORM_TITLE",
+	"TERRAFORM_ADD_TEXT",
+	"TERRAFORM_ADD_TOOLTIP",
+	"TERRAFORM_SUB_TEXT",
+	"TERRAFORM_SUB_TOOLTIP",
+	"TERRAFORM_LEVEL_TEXT",
+	"TERRAFORM_MOVE_TEXT",
+	"FINANCES_TITLE",
+	"FINANCES_RIDE_CONSTRUCTION_TEXT",
+	"FINANCES_RIDE_RUNNING_TEXT",
+	"FINANCES_LAND_PURCHASE_TEXT",
+	"FINANCES_LANDSCAPING_TEXT",
+	"FINANCES_PARK_TICKETS_TEXT",
+	"FINANCES_RIDE_TICKETS_TEXT",
+	"FINANCES_SHOP_SALES_TEXT",
+	"FINANCES_SHOP_STOCK_TEXT",
+	"FINANCES_FOOD_SALES_TEXT",
+	"FINANCES_FOOD_STOCK_TEXT",
+	"FINANCES_STAFF_WAGES_TEXT",
+	"FINANCES_MARKETING_TEXT",
+	"FINANCES_RESEARCH_TEXT",
+	"FINANCES_LOAN_INTEREST_TEXT",
+	"FINANCES_TOTAL_TEXT",
+	"COASTER_BUILD_LEFT_BEND_TOOLTIP",
+	"COASTER_BUILD_NO_BEND_TOOLTIP",
+	"COASTER_BUILD_RIGHT_BEND_TOOLTIP",
+	"COASTER_BUILD_BANK_LEFT_TOOLTIP",
+	"COASTER_BUILD_BANK_NONE_TOOLTIP",
+	"COASTER_BUILD_BANK_RIGHT_TOOLTIP",
+	"COASTER_BUILD_BUY_TOOLTIP",
+	"COASTER_MANAGER_NUMBER_TRAINS",
+	"COASTER_MANAGER_NUMBER_CARS",
+	"ENTITY_REMOVE",
+	"ENTITY_REMOVE_TOOLTIP",
+	"ENTITY_REMOVE_CAPTION",
+	"ENTITY_REMOVE_YES",
+	"ENTITY_REMOVE_NO",
+	"ENTITY_REMOVE_MESSAGE",
+	"PLACE_ENTRANCE",
+	"PLACE_ENTRANCE_TOOLTIP",
+	"PLACE_EXIT",
+	"PLACE_EXIT_TOOLTIP",
+	"CHOOSE_ENTRANCE",
+	"CHOOSE_ENTRANCE_TOOLTIP",
+	"CHOOSE_EXIT",
+	"CHOOSE_EXIT_TOOLTIP",
+	"RIDE_BUILD_TITLEBAR_SHOP",
+	"RIDE_BUILD_TITLEBAR_GENTLE",
+	"RIDE_BUILD_TITLEBAR_THRILL",
+	"RIDE_BUILD_ROTATE_TOOLTIP",
+	"RIDE_BUILD_DISPLAY_TOOLTIP",
+	"RIDE_BUILD_NAME_TEXT",
+	"RIDE_BUILD_COST_TEXT",
+	"MONEY_CURRENCY_SYMBOL",
+	"MONEY_THOUSANDS_SEPARATOR",
+	"MONEY_DECIMAL_SEPARATOR",
+	"SETTING_TITLE",
+	"SETTING_LANGUAGE",
+	"SETTING_LANGUAGE_TOOLTIP",
+	"SETTING_RESOLUTION",
+	"SETTING_RESOLUTION_TOOLTIP",
+	nullptr,
+};
@@ -0,0 +1,22 @@
+// GUI string table for FreeRCT
+// Automagically generated, do not edit
+
+#ifndef SHOPS_STRING_TABLE_H
+#define SHOPS_STRING_TABLE_H
+
+/** Shops strings table. */
+enum ShopsStrings {
+	SHOPS_NAME_INSTANCE1 = STR_GENERIC_SHOP_START,
+	SHOPS_NAME_INSTANCE2,
+	SHOPS_NAME_TYPE,
+	SHOPS_NAME_ITEM1,
+	SHOPS_NAME_ITEM2,
+	SHOPS_DESCRIPTION_TYPE,
+	SHOPS_DESCRIPTION_RECOLOUR1,
+	SHOPS_DESCRIPTION_RECOLOUR2,
+	SHOPS_DESCRIPTION_RECOLOUR3,
+
+	SHOPS_STRING_TABLE_END,
+};
+
+#endif
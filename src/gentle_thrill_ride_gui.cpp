@@ -17,6 +17,7 @@
 #include "entity_gui.h"
 #include "mouse_mode.h"
 #include "viewport.h"
+#include "replay.h"
 #include "generated/entrance_exit_strings.h"
 
 /** Window to prompt for removing a gentle/thrill ride. */
@@ -44,6 +45,7 @@ void GentleThrillRideRemoveWindow::OnClick(WidgetNumber number, const Point16 &p
 {
 	if (number == ERW_YES) {
 		delete GetWindowByType(WC_GENTLE_THRILL_RIDE_MANAGER, this->si->GetIndex());
+		_replay.Record(RCT_REMOVE_RIDE, {this->si->GetIndex()});
 		_rides_manager.DeleteInstance(this->si->GetIndex());
 	}
 	delete this;
@@ -266,6 +268,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, const Point16
 		case GTRMW_RIDE_OPENED_TEXT:
 		case GTRMW_RIDE_OPENED:
 			if (this->ride->CanOpenRide()) {
+				_replay.Record(RCT_OPEN_RIDE, {this->ride->GetIndex()});
 				this->ride->OpenRide();
 				this->SetGentleThrillRideToggleButtons();
 			}
@@ -274,6 +277,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, const Point16
 		case GTRMW_RIDE_CLOSED_TEXT:
 		case GTRMW_RIDE_CLOSED:
 			if (this->ride->state != RIS_CLOSED) {
+				_replay.Record(RCT_CLOSE_RIDE, {this->ride->GetIndex()});
 				this->ride->CloseRide();
 				this->SetGentleThrillRideToggleButtons();
 			}
@@ -397,9 +401,13 @@ void GentleThrillRideManagerWindow::SelectorMouseButtonEvent(const uint8 state)
 
 	if (this->is_placing_entrance) {
 		assert(this->ride->CanPlaceEntranceOrExit(this->ride->temp_entrance_pos, true));
+		const XYZPoint16 &pos = this->ride->temp_entrance_pos;
+		_replay.Record(RCT_PLACE_RIDE_ENTRANCE, {this->ride->GetIndex(), pos.x, pos.y, pos.z});
 		this->ride->SetEntrancePos(this->ride->temp_entrance_pos);
 	} else {
 		assert(this->ride->CanPlaceEntranceOrExit(this->ride->temp_exit_pos, false));
+		const XYZPoint16 &pos = this->ride->temp_exit_pos;
+		_replay.Record(RCT_PLACE_RIDE_EXIT, {this->ride->GetIndex(), pos.x, pos.y, pos.z});
 		this->ride->SetExitPos(this->ride->temp_exit_pos);
 	}
 
@@ -424,10 +432,12 @@ void GentleThrillRideManagerWindow::OnChange(const ChangeCode code, const uint32
 		case CHG_DROPDOWN_RESULT:
 			switch ((parameter >> 16) & 0xFF) {
 				case GTRMW_CHOOSE_ENTRANCE:
+					_replay.Record(RCT_SET_ENTRANCE_TYPE, {this->ride->GetIndex(), static_cast<int32>(parameter & 0xFF)});
 					this->ride->SetEntranceType(parameter & 0xFF);
 					this->UpdateRecolourButtons();
 					break;
 				case GTRMW_CHOOSE_EXIT:
+					_replay.Record(RCT_SET_EXIT_TYPE, {this->ride->GetIndex(), static_cast<int32>(parameter & 0xFF)});
 					this->ride->SetExitType(parameter & 0xFF);
 					this->UpdateRecolourButtons();
 					break;
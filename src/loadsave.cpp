@@ -13,9 +13,27 @@
 #include "finances.h"
 #include "map.h"
 #include "string_func.h"
+#include "fileio.h"
 #include "person.h"
 #include "people.h"
 
+/** Name of the block with the block directory of a savegame. */
+static const char DIRECTORY_BLOCK[] = "FCTD";
+static const uint32 DIRECTORY_VERSION = 1; ///< Version of the block directory.
+
+static const uint32 COMPRESSED_VERSION = 7; ///< First version of the file header with compressed blocks.
+static const uint32 COMPRESSED_HEADER_LENGTH = 16; ///< Length of the file header of a savegame with compressed blocks.
+
+/**
+ * Read a long word from memory.
+ * @param data Data to read.
+ * @return The long word stored at the data.
+ */
+static inline uint32 ReadLong(const uint8 *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32)data[3] << 24);
+}
+
 /**
  * Constructor of the loader class.
  * @param fp Input file stream. Use \c nullptr for initialization to default.
@@ -24,8 +42,224 @@ Loader::Loader(FILE *fp)
 {
 	this->fail_msg = nullptr;
 	this->blk_name = nullptr;
-	this->fp = fp;
-	this->cache_count = 0;
+	this->reading = fp != nullptr;
+	this->window = nullptr;
+	this->pos = nullptr;
+	this->end = nullptr;
+	this->window_offset = 0;
+	this->compression = CM_NONE;
+	this->chunks_start = 0;
+	this->chunks_end = 0;
+	this->next_chunk = 0;
+	if (fp != nullptr) this->ReadFile(fp);
+}
+
+/**
+ * Read the entire file into memory, and find its block directory and compressed chunks.
+ * @param fp Input file stream.
+ */
+void Loader::ReadFile(FILE *fp)
+{
+	size_t length = 0;
+	if (fseek(fp, 0, SEEK_END) == 0) {
+		long size = ftell(fp);
+		if (size > 0) length = size;
+		rewind(fp);
+	}
+	/* Read in big chunks, the size is only a hint. */
+	this->data.resize(length + 1);
+	length = 0;
+	for (;;) {
+		length += fread(this->data.data() + length, 1, this->data.size() - length, fp);
+		if (length < this->data.size()) break;
+		this->data.resize(this->data.size() * 2);
+	}
+	if (ferror(fp)) this->SetFailMessage("Error reading the file");
+	this->data.resize(length);
+
+	const uint8 *start = this->data.data();
+	this->window = start;
+	this->pos = start;
+	this->end = start + length;
+	uint32 blocks_end = this->ReadDirectory();
+	if (this->IsFail()) return;
+
+	/* A file header with a compressed version is followed by chunks of compressed blocks. */
+	uint32 data_length = blocks_end;
+	if (blocks_end >= COMPRESSED_HEADER_LENGTH && memcmp(start, "FCTS", 4) == 0 && ReadLong(start + 4) >= COMPRESSED_VERSION) {
+		this->compression = static_cast<CompressionMethod>(ReadLong(start + 8));
+		if (this->compression == CM_NONE || !IsCompressionAvailable(this->compression)) {
+			this->SetFailMessage("Unsupported compression method");
+			return;
+		}
+		this->chunks_start = COMPRESSED_HEADER_LENGTH;
+		this->chunks_end = blocks_end;
+		this->next_chunk = this->chunks_start;
+		data_length = this->ReadChunks();
+		blocks_end = this->chunks_start;
+	}
+
+	for (const SaveBlockEntry &entry : this->directory) {
+		bool valid = entry.count > 0 && entry.length >= 12 * entry.count && entry.offset <= data_length && entry.length <= data_length - entry.offset;
+		if (valid && this->compression == CM_NONE) {
+			const uint8 *blk = start + entry.offset;
+			valid = memcmp(blk, entry.name, 4) == 0 && blk[entry.length - 4] == entry.name[3] && blk[entry.length - 1] == entry.name[0];
+		}
+		if (!valid) {
+			this->SetFailMessage("Corrupt block directory");
+			this->directory.clear();
+			return;
+		}
+	}
+
+	this->window = start;
+	this->pos = start;
+	this->end = start + blocks_end;
+}
+
+/**
+ * Read the block directory at the end of the file, if it exists.
+ * @return Offset of the end of the blocks in the file, that is, the start of the directory.
+ * @see Saver::Finish
+ */
+uint32 Loader::ReadDirectory()
+{
+	const uint8 *start = this->data.data();
+	size_t length = this->data.size();
+	if (length < 8) return length;
+
+	uint32 offset = ReadLong(start + length - 4);
+	if (offset >= length - 4 || memcmp(start + offset, DIRECTORY_BLOCK, 4) != 0) return length; // File without a directory.
+
+	this->pos = start + offset;
+	this->end = start + length - 4;
+	uint32 version = this->OpenBlock(DIRECTORY_BLOCK);
+	if (version != DIRECTORY_VERSION) {
+		this->SetFailMessage("Bad block directory version");
+		this->blk_name = nullptr;
+		return offset;
+	}
+	uint32 count = this->GetLong();
+	for (uint32 i = 0; i < count && !this->IsFail(); i++) {
+		SaveBlockEntry entry;
+		for (int j = 0; j < 4; j++) entry.name[j] = this->GetByte();
+		entry.version = this->GetLong();
+		entry.offset = this->GetLong();
+		entry.length = this->GetLong();
+		entry.count = this->GetLong();
+		this->directory.push_back(entry);
+	}
+	this->CloseBlock();
+	if (this->pos != this->end) this->SetFailMessage("Corrupt block directory");
+	if (this->IsFail()) {
+		this->blk_name = nullptr;
+		this->directory.clear();
+	}
+	return offset;
+}
+
+/**
+ * Verify the framing of the compressed chunks of the file.
+ * Each chunk has the length of its stored data, the length of its decompressed data, and the stored data.
+ * If both lengths are equal, the data is stored without compression.
+ * The decompressed length is checked against what the stored data can decompress to, before allocating memory for it.
+ * @return Length of the decompressed data of the file, including the file header.
+ */
+uint32 Loader::ReadChunks()
+{
+	const uint8 *start = this->data.data();
+	uint32 length = this->chunks_start;
+	uint32 offset = this->chunks_start;
+	while (offset < this->chunks_end) {
+		uint32 stored = (this->chunks_end - offset >= 8) ? ReadLong(start + offset) : UINT32_MAX;
+		uint32 decompressed = (this->chunks_end - offset >= 8) ? ReadLong(start + offset + 4) : 0;
+		if (stored > this->chunks_end - offset - 8 || decompressed == 0 || stored > decompressed || decompressed > UINT32_MAX - length ||
+				(stored != decompressed && decompressed > GetMaxDecompressedLength(this->compression, stored))) {
+			this->SetFailMessage("Corrupt compressed data");
+			return length;
+		}
+		length += decompressed;
+		offset += 8 + stored;
+	}
+	return length;
+}
+
+/**
+ * Decompress the next chunk of the file, and continue loading from it.
+ * @return Whether a next chunk was loaded.
+ */
+bool Loader::LoadNextChunk()
+{
+	if (this->IsFail() || this->next_chunk >= this->chunks_end) return false;
+
+	const uint8 *chunk_data = this->data.data() + this->next_chunk;
+	uint32 stored = ReadLong(chunk_data);
+	uint32 length = ReadLong(chunk_data + 4);
+	this->next_chunk += 8 + stored;
+	this->window_offset += this->end - this->window;
+
+	this->chunk.resize(length);
+	if (!DecompressData((stored == length) ? CM_NONE : this->compression, chunk_data + 8, stored, this->chunk.data(), length)) {
+		this->SetFailMessage("Corrupt compressed data");
+		return false;
+	}
+	this->window = this->chunk.data();
+	this->pos = this->window;
+	this->end = this->window + length;
+	return true;
+}
+
+/**
+ * Get the next byte from the stream at the end of the current data.
+ * @return The read next byte.
+ */
+uint8 Loader::GetByteFromNextChunk()
+{
+	if (this->LoadNextChunk()) return *this->pos++;
+	if (this->reading && !this->IsFail()) this->SetFailMessage("EOF encountered");
+	return 0;
+}
+
+/**
+ * Continue loading at a given offset.
+ * @param offset Offset in the decompressed data of the file.
+ * @return Whether the offset is valid, else the loading position did not change.
+ */
+bool Loader::Seek(uint32 offset)
+{
+	if (this->IsFail()) return false;
+	if (offset >= this->window_offset && offset - this->window_offset <= (uint32)(this->end - this->window)) {
+		this->pos = this->window + (offset - this->window_offset);
+		return true;
+	}
+	if (this->compression == CM_NONE) return false;
+
+	if (offset < this->chunks_start) { // In the file header.
+		this->window = this->data.data();
+		this->end = this->window + this->chunks_start;
+		this->window_offset = 0;
+		this->next_chunk = this->chunks_start;
+		this->pos = this->window + offset;
+		return true;
+	}
+
+	uint32 chunk_offset = this->chunks_start;
+	uint32 file_offset = this->chunks_start;
+	while (file_offset < this->chunks_end) {
+		uint32 stored = ReadLong(this->data.data() + file_offset);
+		uint32 length = ReadLong(this->data.data() + file_offset + 4);
+		if (offset < chunk_offset + length) {
+			this->next_chunk = file_offset;
+			this->window = this->end;
+			this->window_offset = chunk_offset;
+			if (!this->LoadNextChunk()) return false;
+			this->pos = this->window + (offset - chunk_offset);
+			return true;
+		}
+		chunk_offset += length;
+		file_offset += 8 + stored;
+	}
+	return false;
 }
 
 /**
@@ -33,31 +267,23 @@ Loader::Loader(FILE *fp)
  * @param name Name of the expected block.
  * @param may_fail Whether it is allowed not to find the expected block.
  * @return Version number of the found block, \c 0 for default initialization, #UINT32_MAX for failing to find the block (only if \a may_fail was set).
- * @note If the block was not found, bytes already read of the block name are pushed back onto the stream.
+ * @note If the block was not found, the loading position does not change.
  */
 uint32 Loader::OpenBlock(const char *name, bool may_fail)
 {
 	assert(strlen(name) == 4);
 
-	if (this->fp == nullptr || this->IsFail()) return 0;
+	if (!this->reading || this->IsFail()) return 0;
 
 	assert(this->blk_name == nullptr);
-	this->blk_name = name;
-	int i = 0;
-	while (i < 4) {
-		uint8 val = this->GetByte();
-		if (val != this->blk_name[i]) {
-			this->PutByte(val);
-			while (i > 0) {
-				i--;
-				this->PutByte(this->blk_name[i]);
-			}
-			if (may_fail) return UINT32_MAX;
-			this->SetFailMessage("Missing block name");
-			return 0;
-		}
-		i++;
+	if (this->pos == this->end) this->LoadNextChunk(); // Chunks start with a block.
+	if (this->end - this->pos < 4 || memcmp(this->pos, name, 4) != 0) {
+		if (may_fail) return UINT32_MAX;
+		this->SetFailMessage("Missing block name");
+		return 0;
 	}
+	this->blk_name = name;
+	this->pos += 4;
 
 	uint32 version = this->GetLong();
 	if (version == 0 || version == UINT32_MAX) {
@@ -70,7 +296,7 @@ uint32 Loader::OpenBlock(const char *name, bool may_fail)
 /** Test whether the current block is closed. */
 void Loader::CloseBlock()
 {
-	if (this->fp == nullptr || this->IsFail()) return;
+	if (!this->reading || this->IsFail()) return;
 
 	assert(this->blk_name != nullptr);
 	if (this->GetByte() != this->blk_name[3] || this->GetByte() != this->blk_name[2] ||
@@ -81,39 +307,50 @@ void Loader::CloseBlock()
 }
 
 /**
- * Get the next byte from the stream (or the cache).
- * @return The read next byte.
+ * Find a block in the block directory of the file.
+ * @param name Name of the block to find.
+ * @return Directory entry of the first block with the given name, or \c nullptr if the file has no such block or no directory.
  */
-uint8 Loader::GetByte()
+const SaveBlockEntry *Loader::FindBlock(const char *name) const
 {
-	if (this->fp == nullptr || this->IsFail()) return 0;
-	
-	if (this->cache_count > 0) {
-		this->cache_count--;
-		return this->cache[this->cache_count];
-	}
-	int k = getc(this->fp);
-	if (k == EOF) {
-		this->SetFailMessage("EOF encountered");
-		return 0;
+	assert(strlen(name) == 4);
+	for (const SaveBlockEntry &entry : this->directory) {
+		if (memcmp(entry.name, name, 4) == 0) return &entry;
 	}
-	return k;
+	return nullptr;
 }
 
 /**
- * Put a byte in the temporary cache.
- * @param val Value to save.
+ * Continue loading at the start of a block, using the block directory.
+ * @param name Name of the block to load next, for consecutive blocks with this name the first block.
+ * @return Whether the block was found, else the loading position did not change.
  */
-void Loader::PutByte(uint8 val)
+bool Loader::SeekBlock(const char *name)
 {
-	if (this->IsFail()) return;
-	assert(this->cache_count < (int)lengthof(this->cache));
-	this->cache[this->cache_count] = val;
-	this->cache_count++;
+	assert(this->blk_name == nullptr);
+	const SaveBlockEntry *entry = this->FindBlock(name);
+	return entry != nullptr && this->Seek(entry->offset);
+}
+
+/**
+ * Skip the blocks at the current loading position, using the block directory.
+ * @param name Name of the blocks to skip.
+ * @return Whether the next blocks have the given name and were skipped.
+ */
+bool Loader::SkipBlocks(const char *name)
+{
+	assert(this->blk_name == nullptr);
+	if (this->IsFail()) return false;
+
+	uint32 offset = this->window_offset + (this->pos - this->window);
+	for (const SaveBlockEntry &entry : this->directory) {
+		if (entry.offset == offset && memcmp(entry.name, name, 4) == 0) return this->Seek(offset + entry.length);
+	}
+	return false;
 }
 
 /**
- * Get the next word from the stream (or the cache).
+ * Get the next word from the stream.
  * @return The read next word.
  */
 uint16 Loader::GetWord()
@@ -124,7 +361,7 @@ uint16 Loader::GetWord()
 }
 
 /**
- * Get the next long word from the stream (or the cache).
+ * Get the next long word from the stream.
  * @return The read next long word.
  */
 uint32 Loader::GetLong()
@@ -135,7 +372,7 @@ uint32 Loader::GetLong()
 }
 
 /**
- * Get the next long long word from the stream (or the cache).
+ * Get the next long long word from the stream.
  * @return The read next long long word.
  */
 uint64 Loader::GetLongLong()
@@ -181,6 +418,7 @@ void Loader::SetFailMessage(const char *fail_msg)
 	fprintf(stderr, "ERROR while loading: %s\n", fail_msg);
 	if (this->IsFail()) return; // Do not overwrite the first message.
 	this->fail_msg = fail_msg;
+	this->end = this->pos; // Further reads return \c 0.
 }
 
 /**
@@ -204,12 +442,34 @@ bool Loader::IsFail() const
 
 /**
  * Constructor for the saver.
- * @param fp Output file stream to write to.
+ * @param fp Output file stream to write to, \c nullptr to only compute the checksum of the data.
+ * @param compression Compression method of the blocks after the first block (the file header).
  */
-Saver::Saver(FILE *fp)
+Saver::Saver(FILE *fp, CompressionMethod compression)
 {
+	assert(IsCompressionAvailable(compression));
 	this->fp = fp;
+	this->snapshot = false;
 	this->blk_name = nullptr;
+	this->checksum = 2166136261u;
+	this->chunk_start = 0;
+	this->flushed = 0;
+	this->written = 0;
+	this->write_error = false;
+	this->compression = compression;
+	this->compressing = false;
+	if (fp != nullptr) this->buffer.reserve(BUFFER_SIZE);
+}
+
+/**
+ * Constructor for a saver that makes a snapshot. The data is kept in memory, #WriteSnapshot writes it to a file later.
+ * Compressing and writing the data is the slow part of saving, and does not need access to the game state, so it can be done in another thread.
+ * @param compression Compression method of the blocks after the first block (the file header).
+ */
+Saver::Saver(CompressionMethod compression) : Saver(nullptr, compression)
+{
+	this->snapshot = true;
+	this->buffer.reserve(BUFFER_SIZE);
 }
 
 /**
@@ -221,9 +481,20 @@ void Saver::StartBlock(const char *name, uint32 version)
 {
 	assert(strlen(name) == 4);
 	assert(this->blk_name == nullptr);
+	assert(version != 0 && version != UINT32_MAX);
 	this->blk_name = name;
+	if (this->IsStoring()) {
+		if (this->compressing && this->buffer.size() - this->chunk_start >= CHUNK_SIZE) this->Flush(); // Chunks contain whole blocks.
+
+		SaveBlockEntry entry;
+		memcpy(entry.name, name, 4);
+		entry.version = version;
+		entry.offset = this->flushed + this->buffer.size();
+		entry.length = 0;
+		entry.count = 1;
+		this->directory.push_back(entry);
+	}
 	for (int i = 0; i < 4; i++) this->PutByte(name[i]);
-	assert(version != 0 && version != UINT32_MAX);
 	this->PutLong(version);
 }
 
@@ -233,6 +504,27 @@ void Saver::EndBlock()
 	assert(this->blk_name != nullptr);
 	for (int i = 3; i >= 0; i--) this->PutByte(this->blk_name[i]);
 	this->blk_name = nullptr;
+	if (this->IsStoring()) {
+		SaveBlockEntry &entry = this->directory.back();
+		entry.length = this->flushed + this->buffer.size() - entry.offset;
+
+		/* Merge with the previous entry if it has the same kind of blocks. */
+		size_t count = this->directory.size();
+		if (count >= 2) {
+			SaveBlockEntry &prev = this->directory[count - 2];
+			if (memcmp(prev.name, entry.name, 4) == 0 && prev.version == entry.version && prev.offset + prev.length == entry.offset) {
+				prev.length += entry.length;
+				prev.count++;
+				this->directory.pop_back();
+			}
+		}
+
+		/* The file header is not compressed. */
+		if (this->compression != CM_NONE && this->flushed + this->chunk_start == 0) {
+			this->Flush();
+			this->compressing = true;
+		}
+	}
 }
 
 /**
@@ -241,7 +533,131 @@ void Saver::EndBlock()
  */
 void Saver::PutByte(uint8 val)
 {
-	putc(val, this->fp);
+	this->checksum = (this->checksum ^ val) * 16777619u;
+	if (!this->IsStoring()) return;
+	this->buffer.push_back(val);
+	if (this->buffer.size() >= BUFFER_SIZE && !this->compressing && !this->snapshot) this->Flush();
+}
+
+/**
+ * End the current chunk of the collected data, and write it to the file.
+ * For a snapshot, the chunk is only recorded, and written by #WriteSnapshot.
+ */
+void Saver::Flush()
+{
+	size_t length = this->buffer.size() - this->chunk_start;
+	if (length == 0) return;
+	if (this->snapshot) {
+		this->chunks.push_back({this->chunk_start, length, this->compressing});
+		this->chunk_start = this->buffer.size();
+		return;
+	}
+	this->WriteChunk(this->buffer.data(), length, this->compressing);
+	this->flushed += length;
+	this->buffer.clear();
+}
+
+/**
+ * Write a chunk of data to the file.
+ * A compressed chunk is written with the length of the stored data, the length of the data, and the stored data.
+ * The data is stored without compression if compressing does not make it smaller.
+ * @param data Data of the chunk.
+ * @param length Length of the data.
+ * @param compress Whether to compress the chunk.
+ */
+void Saver::WriteChunk(const uint8 *data, size_t length, bool compress)
+{
+	if (!compress) {
+		this->Write(data, length);
+		return;
+	}
+
+	CompressData(this->compression, data, length, &this->packed);
+	bool packed = this->packed.size() < length;
+	size_t stored_length = packed ? this->packed.size() : length;
+	uint8 header[8];
+	for (int i = 0; i < 4; i++) {
+		header[i] = stored_length >> (8 * i);
+		header[4 + i] = length >> (8 * i);
+	}
+	this->Write(header, lengthof(header));
+	this->Write(packed ? this->packed.data() : data, stored_length);
+}
+
+/**
+ * Write data to the file.
+ * @param data Data to write.
+ * @param length Length of the data.
+ */
+void Saver::Write(const uint8 *data, size_t length)
+{
+	if (fwrite(data, 1, length, this->fp) != length) this->write_error = true;
+	this->written += length;
+}
+
+/**
+ * Finish saving by writing the block directory, and the remaining data.
+ * The directory is a block with the number of entries, and for each entry its name, version, offset, length, and number of blocks (see #SaveBlockEntry).
+ * The offset of the directory block is written after it, at the end of the file. The directory is not compressed.
+ * @return Whether all data was written successfully.
+ */
+bool Saver::Finish()
+{
+	assert(this->blk_name == nullptr);
+	if (!this->IsStoring()) return true;
+
+	this->Flush();
+	this->compressing = false;
+	uint32 offset = this->written;
+	std::vector<SaveBlockEntry> blocks;
+	blocks.swap(this->directory);
+
+	this->StartBlock(DIRECTORY_BLOCK, DIRECTORY_VERSION);
+	this->PutLong(blocks.size());
+	for (const SaveBlockEntry &entry : blocks) {
+		for (int i = 0; i < 4; i++) this->PutByte(entry.name[i]);
+		this->PutLong(entry.version);
+		this->PutLong(entry.offset);
+		this->PutLong(entry.length);
+		this->PutLong(entry.count);
+	}
+	this->EndBlock();
+	if (this->snapshot) { // The offset of the directory in the file is not known yet.
+		this->Flush();
+		return true;
+	}
+	this->PutLong(offset);
+
+	this->Flush();
+	return !this->write_error;
+}
+
+/**
+ * Write the data of a finished snapshot to a file.
+ * The chunks are compressed while writing them. The last chunk is the block directory, its offset in the file is written after it.
+ * @param fp Output file stream to write to.
+ * @return Whether all data was written successfully.
+ * @pre The saver makes a snapshot, and #Finish has been called.
+ * @note Does not access the game state, it may be called from another thread.
+ */
+bool Saver::WriteSnapshot(FILE *fp)
+{
+	assert(this->snapshot && this->blk_name == nullptr && !this->chunks.empty());
+	this->fp = fp;
+	this->written = 0;
+	this->write_error = false;
+
+	uint32 offset = 0;
+	for (const SnapshotChunk &chunk : this->chunks) {
+		offset = this->written;
+		this->WriteChunk(this->buffer.data() + chunk.start, chunk.length, chunk.compress);
+	}
+	uint8 trailer[4];
+	for (int i = 0; i < 4; i++) trailer[i] = offset >> (8 * i);
+	this->Write(trailer, lengthof(trailer));
+
+	this->fp = nullptr;
+	return !this->write_error;
 }
 
 /**
@@ -318,7 +734,8 @@ void Saver::PutText(const uint8 *str, int length)
 static void LoadElements(Loader &ldr)
 {
 	uint32 version = ldr.OpenBlock("FCTS");
-	if (version > 6) ldr.SetFailMessage("Bad file header");
+	if (version > COMPRESSED_VERSION) ldr.SetFailMessage("Bad file header");
+	if (version >= COMPRESSED_VERSION) ldr.GetLong(); // Compression method, already handled by the loader.
 	ldr.CloseBlock();
 
 	Loader reset_loader(nullptr);
@@ -341,7 +758,12 @@ static void LoadElements(Loader &ldr)
  */
 static void SaveElements(Saver &svr)
 {
-	svr.StartBlock("FCTS", 6);
+	if (svr.GetCompression() == CM_NONE) {
+		svr.StartBlock("FCTS", 6);
+	} else {
+		svr.StartBlock("FCTS", COMPRESSED_VERSION);
+		svr.PutLong(svr.GetCompression());
+	}
 	svr.EndBlock();
 
 	SaveDate(svr);
@@ -381,15 +803,110 @@ bool LoadGameFile(const char *fname)
 /**
  * Save the current game state to file.
  * @param fname Name of the file to write.
+ * @param compress Whether to compress the saved game.
  * @return Whether saving was successful.
  */
-bool SaveGameFile(const char *fname)
+bool SaveGameFile(const char *fname, bool compress)
 {
 	FILE *fp = fopen(fname, "wb");
 	if (fp == nullptr) return false;
-	Saver svr(fp);
+	Saver svr(fp, compress ? GetDefaultCompression() : CM_NONE);
 	SaveElements(svr);
-	fclose(fp);
-	return true;
+	bool ok = svr.Finish();
+	if (fclose(fp) != 0) ok = false;
+	return ok;
+}
+
+/**
+ * Take a snapshot of the current game state, to save it later with #WriteGameSnapshot.
+ * @param compress Whether to compress the saved game.
+ * @return The snapshot, the caller should delete it.
+ */
+Saver *TakeGameSnapshot(bool compress)
+{
+	Saver *snapshot = new Saver(compress ? GetDefaultCompression() : CM_NONE);
+	SaveElements(*snapshot);
+	snapshot->Finish();
+	return snapshot;
+}
+
+/**
+ * Save a snapshot of the game state to file.
+ * The data is written to a temporary file first, which is synchronized to the storage device and then replaces the file.
+ * An existing file is thus never left partially written.
+ * @param snapshot Snapshot to save, made by #TakeGameSnapshot.
+ * @param fname Name of the file to write.
+ * @return Whether saving was successful.
+ * @note Does not access the game state, it may be called from another thread.
+ */
+bool WriteGameSnapshot(Saver *snapshot, const char *fname)
+{
+	std::string temp_name = std::string(fname) + ".tmp";
+	FILE *fp = fopen(temp_name.c_str(), "wb");
+	if (fp == nullptr) return false;
+	bool ok = snapshot->WriteSnapshot(fp) && SyncFile(fp);
+	if (fclose(fp) != 0) ok = false;
+	if (ok) ok = RenameFile(temp_name.c_str(), fname);
+	if (!ok) remove(temp_name.c_str());
+	return ok;
+}
+
+/**
+ * Compute a checksum of the current game state. Two games have the same checksum if they would be saved the same.
+ * @return Checksum of the game state.
+ */
+uint32 ComputeGameChecksum()
+{
+	Saver svr(nullptr);
+	SaveElements(svr);
+	return svr.GetChecksum();
+}
+
+BackgroundSaver::BackgroundSaver() : done(false), success(false), snapshot(nullptr)
+{
+}
+
+BackgroundSaver::~BackgroundSaver()
+{
+	this->Wait();
+}
+
+/**
+ * Start saving the current game state. A previous save is finished first.
+ * @param fname Name of the file to write.
+ * @param compress Whether to compress the saved game.
+ */
+void BackgroundSaver::Start(const char *fname, bool compress)
+{
+	this->Wait();
+
+	this->snapshot = TakeGameSnapshot(compress);
+	this->fname = fname;
+	this->success = false;
+	this->done = false;
+	this->thread = std::thread([this]() {
+		this->success = WriteGameSnapshot(this->snapshot, this->fname.c_str());
+		this->done = true;
+	});
+}
+
+/** Finish saving if the background thread is done, without waiting for it. */
+void BackgroundSaver::Poll()
+{
+	if (this->IsBusy() && this->done) this->Finish();
 }
 
+/** Wait until the background thread is done saving, if it is saving a game. */
+void BackgroundSaver::Wait()
+{
+	if (this->IsBusy()) this->Finish();
+}
+
+/** Wait for the background thread, and report a failure to save the game. */
+void BackgroundSaver::Finish()
+{
+	this->thread.join();
+	delete this->snapshot;
+	this->snapshot = nullptr;
+	if (!this->success) fprintf(stderr, "Failed to save the game to \"%s\"\n", this->fname.c_str());
+}
@@ -10,6 +10,24 @@
 #ifndef LOADSAVE_H
 #define LOADSAVE_H
 
+#include "compression.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Entry of the block directory of a savegame, see #Saver::Finish.
+ * Consecutive blocks with the same name and version (such as the voxel stacks of the world) share an entry.
+ */
+struct SaveBlockEntry {
+	char name[4];   ///< Name of the blocks.
+	uint32 version; ///< Version number of the blocks.
+	uint32 offset;  ///< Offset of the start of the first block in the (decompressed) data of the file.
+	uint32 length;  ///< Length of the blocks in bytes, including their names, version numbers, and end markers.
+	uint32 count;   ///< Number of blocks.
+};
+
 /** Class for loading a save game. */
 class Loader {
 public:
@@ -18,7 +36,20 @@ public:
 	uint32 OpenBlock(const char *name, bool may_fail = false);
 	void CloseBlock();
 
-	uint8 GetByte();
+	const SaveBlockEntry *FindBlock(const char *name) const;
+	bool SeekBlock(const char *name);
+	bool SkipBlocks(const char *name);
+
+	/**
+	 * Get the next byte from the stream.
+	 * @return The read next byte.
+	 */
+	inline uint8 GetByte()
+	{
+		if (this->pos < this->end) return *this->pos++;
+		return this->GetByteFromNextChunk();
+	}
+
 	uint16 GetWord();
 	uint32 GetLong();
 	uint64 GetLongLong();
@@ -29,20 +60,36 @@ public:
 	bool IsFail() const;
 
 private:
-	void PutByte(uint8 val);
+	void ReadFile(FILE *fp);
+	uint32 ReadDirectory();
+	uint32 ReadChunks();
+	bool LoadNextChunk();
+	uint8 GetByteFromNextChunk();
+	bool Seek(uint32 offset);
 
 	const char *fail_msg; ///< If not \c nullptr, message of failure.
 	const char *blk_name; ///< Name of the current block.
 
-	FILE *fp;             ///< Data stream being loaded.
-	int cache_count;      ///< Number of values in #cache.
-	uint8 cache[8];       ///< Stack with temporary values to return on next read.
+	bool reading;                ///< Whether data is being loaded, else everything is initialized to default.
+	std::vector<uint8> data;     ///< Contents of the loaded file.
+	const uint8 *window;         ///< Data being loaded, either in #data or in #chunk.
+	const uint8 *pos;            ///< Position of the next byte to load in #window.
+	const uint8 *end;            ///< End of #window, loading stops early at an error.
+	uint32 window_offset;        ///< Offset of #window in the decompressed data of the file.
+	std::vector<SaveBlockEntry> directory; ///< Block directory of the file, empty if the file has none.
+
+	CompressionMethod compression; ///< Compression method of the chunks of the file.
+	std::vector<uint8> chunk;      ///< Decompressed data of the current chunk.
+	uint32 chunks_start;           ///< Offset of the first compressed chunk in #data.
+	uint32 chunks_end;             ///< End of the compressed chunks in #data.
+	uint32 next_chunk;             ///< Offset of the next compressed chunk in #data.
 };
 
 /** Class for saving a savegame. */
 class Saver {
 public:
-	Saver(FILE *fp);
+	Saver(FILE *fp, CompressionMethod compression = CM_NONE);
+	explicit Saver(CompressionMethod compression);
 
 	void StartBlock(const char *name, uint32 version);
 	void EndBlock();
@@ -53,12 +100,103 @@ public:
 	void PutLongLong(uint64 val);
 	void PutText(const uint8 *str, int length = -1);
 
+	bool Finish();
+	bool WriteSnapshot(FILE *fp);
+
+	/**
+	 * Get the checksum of the data written so far.
+	 * @return Checksum of the written data.
+	 */
+	inline uint32 GetChecksum() const
+	{
+		return this->checksum;
+	}
+
+	/**
+	 * Get the compression method of the blocks after the file header.
+	 * @return Compression method of the saver.
+	 */
+	inline CompressionMethod GetCompression() const
+	{
+		return this->compression;
+	}
+
+	static const size_t BUFFER_SIZE = 256 * 1024; ///< Number of bytes collected before writing them to the file.
+	static const size_t CHUNK_SIZE = 64 * 1024;   ///< Minimal number of bytes of blocks compressed together.
+
 private:
-	FILE *fp; ///< Output file stream.
+	/** Chunk of the data of a snapshot, see #WriteSnapshot. */
+	struct SnapshotChunk {
+		size_t start;  ///< Offset of the chunk in #buffer.
+		size_t length; ///< Length of the chunk.
+		bool compress; ///< Whether to compress the chunk.
+	};
+
+	/**
+	 * Is the data stored, either in a file or in a snapshot?
+	 * @return Whether the saver stores the data, else it only computes the checksum.
+	 */
+	inline bool IsStoring() const
+	{
+		return this->fp != nullptr || this->snapshot;
+	}
+
+	void Flush();
+	void WriteChunk(const uint8 *data, size_t length, bool compress);
+	void Write(const uint8 *data, size_t length);
+
+	FILE *fp; ///< Output file stream, \c nullptr if only the checksum is computed or a snapshot is made.
+	bool snapshot; ///< Whether the data is kept in memory, to write it to a file later.
 	const char *blk_name; ///< Name of the current block.
+	uint32 checksum; ///< FNV-1a hash of the written data.
+	std::vector<uint8> buffer; ///< Data not yet written to the file, all data of a snapshot.
+	size_t chunk_start;        ///< Start of the current chunk in #buffer.
+	std::vector<SnapshotChunk> chunks; ///< Chunks of the data of a snapshot.
+	uint32 flushed;            ///< Number of bytes of data written to the file, before compression.
+	uint32 written;            ///< Number of bytes written to the file.
+	bool write_error;          ///< Whether writing to the file failed.
+	CompressionMethod compression; ///< Compression method of the blocks after the file header.
+	bool compressing;              ///< Whether the file header is written, and the next data is compressed.
+	std::vector<uint8> packed;     ///< Memory for the compressed data of a chunk.
+	std::vector<SaveBlockEntry> directory; ///< Blocks written so far.
 };
 
 bool LoadGameFile(const char *fname);
-bool SaveGameFile(const char *fname);
+bool SaveGameFile(const char *fname, bool compress = true);
+Saver *TakeGameSnapshot(bool compress = true);
+bool WriteGameSnapshot(Saver *snapshot, const char *fname);
+uint32 ComputeGameChecksum();
+
+/**
+ * Saving games in a background thread.
+ * A snapshot of the game state is taken in the calling thread, compressing and writing it to the file is done by the background thread.
+ */
+class BackgroundSaver {
+public:
+	BackgroundSaver();
+	~BackgroundSaver();
+
+	void Start(const char *fname, bool compress = true);
+	void Poll();
+	void Wait();
+
+	/**
+	 * Is a game being saved?
+	 * @return Whether the background thread is saving a game.
+	 */
+	inline bool IsBusy() const
+	{
+		return this->thread.joinable();
+	}
+
+private:
+	void Finish();
+
+	std::thread thread;      ///< Thread writing the snapshot.
+	std::atomic<bool> done;  ///< Whether the thread has finished writing.
+	bool success;            ///< Whether writing the snapshot was successful, valid after #done is set.
+	Saver *snapshot;         ///< Snapshot of the game state being written.
+	std::string fname;       ///< Name of the file being written.
+};
 
 #endif
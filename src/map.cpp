@@ -17,6 +17,9 @@
 #include "viewport.h"
 #include "math_func.h"
 #include "sprite_store.h"
+#include "path_finding.h"
+#include "gamecontrol.h"
+#include "replay.h"
 
 /**
  * The game world.
@@ -153,7 +156,7 @@ VoxelObject::~VoxelObject()
 /** Mark the voxel containing the voxel object as dirty, so it is repainted. */
 void VoxelObject::MarkDirty()
 {
-	MarkVoxelDirty(this->vox_pos);
+	MarkVoxelObjectDirty(this->vox_pos);
 }
 
 /**
@@ -298,6 +301,7 @@ void VoxelWorld::SetWorldSize(uint16 xs, uint16 ys)
 	for (uint pos = 0; pos < WORLD_X_SIZE * WORLD_Y_SIZE; pos++) {
 		this->stacks[pos].Clear();
 	}
+	InvalidatePathDistances();
 }
 
 /**
@@ -327,6 +331,7 @@ static void AddFoundations(VoxelWorld *world, uint16 xpos, uint16 ypos, int16 z,
  */
 void VoxelWorld::MakeFlatWorld(int16 z)
 {
+	InvalidatePathDistances();
 	for (uint16 xpos = 0; xpos < this->x_size; xpos++) {
 		for (uint16 ypos = 0; ypos < this->y_size; ypos++) {
 			Voxel *v = this->GetCreateVoxel(XYZPoint16(xpos, ypos, z), true);
@@ -713,6 +718,30 @@ uint16 GetGroundFencesFromMap(const VoxelStack *stack, int base_z)
 	return fences;
 }
 
+/**
+ * Build a fence at an edge of the ground.
+ * @param base_pos Voxel position of the base of the ground.
+ * @param edge Edge of the ground to build the fence at.
+ * @param fence_type Type of the fence to build.
+ * @return Whether the fence could be built.
+ */
+bool BuildFence(const XYZPoint16 &base_pos, TileEdge edge, FenceType fence_type)
+{
+	if (!IsVoxelstackInsideWorld(base_pos.x, base_pos.y)) return false;
+	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(base_pos.x, base_pos.y) != OWN_PARK) return false;
+
+	VoxelStack *vs = _world.GetModifyStack(base_pos.x, base_pos.y);
+	const Voxel *v = vs->Get(base_pos.z);
+	if (v == nullptr || v->GetGroundType() == GTP_INVALID || IsImplodedSteepSlopeTop(v->GetGroundSlope())) return false;
+
+	_replay.Record(RCT_BUILD_FENCE, {base_pos.x, base_pos.y, base_pos.z, edge, fence_type});
+	uint16 fences = GetGroundFencesFromMap(vs, base_pos.z);
+	fences = SetFenceType(fences, edge, fence_type);
+	AddGroundFencesToMap(fences, vs, base_pos.z);
+	MarkVoxelDirty(base_pos);
+	return true;
+}
+
 /**
  * Add/remove land border fence based on current land ownership for the given tile rectangle.
  * @param x Base X coordinate of the rectangle.
@@ -772,6 +801,7 @@ void UpdateLandBorderFence(uint16 x, uint16 y, uint16 width, uint16 height)
 void VoxelWorld::SetTileOwner(uint16 x, uint16 y, TileOwner owner)
 {
 	this->GetModifyStack(x, y)->owner = owner;
+	InvalidatePathDistances();
 
 	UpdateLandBorderFence(x, y, 1, 1);
 }
@@ -792,6 +822,8 @@ void VoxelWorld::SetTileOwnerRect(uint16 x, uint16 y, uint16 width, uint16 heigh
 		}
 	}
 
+	InvalidatePathDistances();
+
 	UpdateLandBorderFence(x, y, width, height);
 }
 
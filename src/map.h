@@ -644,6 +644,7 @@ bool HasTopVoxelFences(uint8 base_tile_slope);
 uint16 MergeGroundFencesAtTop(uint16 vxtop_fences, uint16 fences, uint8 base_tile_slope);
 void AddGroundFencesToMap(uint16 fences, VoxelStack *stack, int base_z);
 uint16 GetGroundFencesFromMap(const VoxelStack *stack, int base_z);
+bool BuildFence(const XYZPoint16 &base_pos, TileEdge edge, FenceType fence_type);
 
 extern VoxelWorld _world;
 
@@ -106,6 +106,7 @@ Recolouring::Recolouring()
 Recolouring::Recolouring(const Recolouring &rc)
 {
 	std::copy(&rc.entries[0], endof(rc.entries), this->entries);
+	this->InvalidateColourMap();
 }
 
 /**
@@ -117,6 +118,7 @@ Recolouring &Recolouring::operator=(const Recolouring &rc)
 {
 	if (this != &rc) {
 		std::copy(&rc.entries[0], endof(rc.entries), this->entries);
+		this->InvalidateColourMap();
 	}
 	return *this;
 }
@@ -125,6 +127,7 @@ Recolouring &Recolouring::operator=(const Recolouring &rc)
 void Recolouring::Reset()
 {
 	for (int i = 0; i < MAX_RECOLOUR; i++) entries[i].source = COL_RANGE_INVALID;
+	this->InvalidateColourMap();
 }
 
 /**
@@ -164,6 +167,7 @@ void Recolouring::AssignRandomColours()
 			}
 		}
 	}
+	this->InvalidateColourMap();
 }
 
 /**
@@ -177,6 +181,7 @@ void Recolouring::Load(Loader &ldr)
 		uint8 val = ldr.GetByte();
 		this->entries[i].AssignDest((ColourRange)val);
 	}
+	this->InvalidateColourMap();
 }
 
 /**
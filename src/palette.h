@@ -342,6 +342,20 @@ public:
 		return _recolour_palettes[re.dest];
 	}
 
+	/**
+	 * Get a key of the recolouring. Recolourings with the same key recolour sprites in the same way.
+	 * @return Key of the recolouring.
+	 */
+	uint64 GetKey() const
+	{
+		static_assert(MAX_RECOLOUR * 16 <= 64, "Recolour entries do not fit in the key.");
+		uint64 key = 0;
+		for (int i = 0; i < MAX_RECOLOUR; i++) {
+			key |= static_cast<uint64>((this->entries[i].source & 0xFF) | ((this->entries[i].dest & 0xFF) << 8)) << (16 * i);
+		}
+		return key;
+	}
+
 	/**
 	 * Recolour entries, (one for each layer in 32bpp).
 	 * Don't assign directly, use #Set instead.
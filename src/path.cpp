@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "path.h"
 #include "map.h"
+#include "path_finding.h"
 #include "ride_type.h"
 #include "viewport.h"
 
@@ -443,6 +444,8 @@ uint8 AddRemovePathEdges(const XYZPoint16 &voxel_pos, uint8 slope, uint8 dirs, P
 	uint16 ngb_instance_data[4]; // New instance data, if the voxel exists.
 	XYZPoint16 ngb_pos[4];       // Coordinate of the neighbouring voxel.
 
+	InvalidatePathDistances();
+
 	Voxel *v = _world.GetCreateVoxel(voxel_pos, false);
 	uint16 fences = v->GetFences();
 
@@ -15,6 +15,7 @@
 #include "gamecontrol.h"
 #include "window.h"
 #include "math_func.h"
+#include "replay.h"
 
 /**
  * Build a path at a tile, and claim the voxels above it as well.
@@ -163,7 +164,10 @@ bool BuildUpwardPath(const XYZPoint16 &voxel_pos, TileEdge edge, PathType path_t
 		}
 	}
 
-	if (!test_only) BuildPathAtTile(voxel_pos, path_type, _path_up_from_edge[edge]);
+	if (!test_only) {
+		_replay.Record(RCT_BUILD_UPWARD_PATH, {voxel_pos.x, voxel_pos.y, voxel_pos.z, edge, path_type});
+		BuildPathAtTile(voxel_pos, path_type, _path_up_from_edge[edge]);
+	}
 	return true;
 }
 
@@ -198,7 +202,10 @@ bool BuildFlatPath(const XYZPoint16 &voxel_pos, PathType path_type, bool test_on
 		}
 	}
 
-	if (!test_only) BuildPathAtTile(voxel_pos, path_type, PATH_EMPTY);
+	if (!test_only) {
+		_replay.Record(RCT_BUILD_FLAT_PATH, {voxel_pos.x, voxel_pos.y, voxel_pos.z, path_type});
+		BuildPathAtTile(voxel_pos, path_type, PATH_EMPTY);
+	}
 	return true;
 }
 
@@ -241,6 +248,7 @@ bool BuildDownwardPath(XYZPoint16 voxel_pos, TileEdge edge, PathType path_type,
 	}
 
 	if (!test_only) {
+		_replay.Record(RCT_BUILD_DOWNWARD_PATH, {voxel_pos.x, voxel_pos.y, voxel_pos.z, edge, path_type});
 		voxel_pos.z--;
 		BuildPathAtTile(voxel_pos, path_type, _path_down_from_edge[edge]);
 	}
@@ -274,7 +282,10 @@ bool RemovePath(const XYZPoint16 &voxel_pos, bool test_only)
 		assert(v->GetInstance() == SRI_PATH && !HasValidPath(v->GetInstanceData()));
 	}
 
-	if (!test_only) RemovePathAtTile(voxel_pos, ps);
+	if (!test_only) {
+		_replay.Record(RCT_REMOVE_PATH, {voxel_pos.x, voxel_pos.y, voxel_pos.z});
+		RemovePathAtTile(voxel_pos, ps);
+	}
 	return true;
 }
 
@@ -300,7 +311,10 @@ bool ChangePath(const XYZPoint16 &voxel_pos, PathType path_type, bool test_only)
 		assert(v->GetInstance() == SRI_PATH && !HasValidPath(v->GetInstanceData()));
 	}
 
-	if (!test_only) ChangePathAtTile(voxel_pos, path_type, ps);
+	if (!test_only) {
+		_replay.Record(RCT_CHANGE_PATH, {voxel_pos.x, voxel_pos.y, voxel_pos.z, path_type});
+		ChangePathAtTile(voxel_pos, path_type, ps);
+	}
 	return true;
 }
 
@@ -11,70 +11,94 @@
 #include "path_finding.h"
 #include "map.h"
 
-/**
- * Constructor of a walked position.
- * @param cur_vox Current voxel position.
- * @param traveled Length of travel from the starting point so far.
- * @param estimate Estimated length of remaining travel to the destination (should be less or equal to the real value for optimal solutions).
- * @param prev_pos Previous walked position used to get at the new position, \c nullptr for the first position.
- */
-WalkedPosition::WalkedPosition(const XYZPoint16 &cur_vox, uint32 traveled, uint32 estimate, const WalkedPosition *prev_pos)
-		: cur_vox(cur_vox), traveled(traveled), estimate(estimate), prev_pos(prev_pos)
-{
-}
+/** Storage of the path searches of a thread, reused between searches. */
+struct WalkStorage {
+	WalkStorage() : xsize(0), ysize(0), search(0)
+	{
+	}
 
-/**
-* Compare two walked positions, and order on position.
-* @param wp1 First position to compare.
-* @param wp2 Second position to compare.
-* @return Whether \a wp1 should come before \a wp2.
-*/
-bool operator<(const WalkedPosition &wp1, const WalkedPosition &wp2)
-{
-	return wp1.cur_vox < wp2.cur_vox;
-}
+	std::vector<WalkedPosition> positions;   ///< Walk information of every voxel in the world.
+	std::vector<WalkedDistance> open_points; ///< Binary heap of open points to examine further.
+	uint16 xsize;  ///< Horizontal size of the world that #positions covers.
+	uint16 ysize;  ///< Vertical size of the world that #positions covers.
+	uint32 search; ///< Number of the current search.
+};
+
+static thread_local WalkStorage _walk_storage; ///< Path search storage of the thread.
+
+PathDistances _park_entry_distances; ///< Distances to the paths that connect the park with the outside world.
+PathDistances _go_home_distances;    ///< Distances to the edge of the world where guests enter and leave.
+XYZPoint16 _go_home_voxel = XYZPoint16::invalid(); ///< 'Go home' voxel of #_go_home_distances.
 
 /**
- * Walked distance constructor.
- * @param traveled Length of travel from the starting point to \a pos.
- * @param estimate Estimated length of remaining travel from \a pos to the destination.
- * @param pos Current position.
+ * Get the voxel at the other side of a path exit.
+ * @param cur_vox Voxel with the path.
+ * @param exits Exits of the path in \a cur_vox (see #GetPathExits).
+ * @param edge Edge to leave \a cur_vox.
+ * @param next_vox [out] Voxel with the connected path at the other side of the edge.
+ * @return Whether a connected path exists at the other side of the edge.
  */
-WalkedDistance::WalkedDistance(uint32 traveled, uint32 estimate, const WalkedPosition *pos) : traveled(traveled), estimate(estimate), pos(pos)
+static bool GetConnectedPath(const XYZPoint16 &cur_vox, uint8 exits, TileEdge edge, XYZPoint16 *next_vox)
 {
+	if ((exits & (0x11 << edge)) == 0) return false;
+
+	/* There is an outgoing connection, is it also on the world? */
+	Point16 dxy = _tile_dxy[edge];
+	if (dxy.x < 0 && cur_vox.x == 0) return false;
+	if (dxy.x > 0 && cur_vox.x + 1 == _world.GetXSize()) return false;
+	if (dxy.y < 0 && cur_vox.y == 0) return false;
+	if (dxy.y > 0 && cur_vox.y + 1 == _world.GetYSize()) return false;
+
+	int extra_z = ((exits & (0x10 << edge)) != 0);
+	if (cur_vox.z + extra_z < 0 || cur_vox.z + extra_z >= WORLD_Z_SIZE) return false;
+
+	/* Now check the other side, new_z is the voxel where the path should be at the bottom. */
+	const Voxel *v2 = _world.GetVoxel(cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
+	if (v2 == nullptr) return false;
+
+	uint8 other_exits = GetPathExits(v2);
+	if ((other_exits & (1 << ((edge + 2) % 4))) == 0) { // No path here, try one voxel below
+		extra_z--;
+		if (cur_vox.z + extra_z < 0) return false;
+		v2 = _world.GetVoxel(cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
+		if (v2 == nullptr) return false;
+		other_exits = GetPathExits(v2);
+		if ((other_exits & (0x10 << ((edge + 2) % 4))) == 0) return false;
+	}
+	*next_vox = cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z);
+	return true;
 }
 
 /**
- * Compare two walked distances, and order on minimal total distance.
+ * Order of open points in the binary heap, the point with the smallest guessed total path length is at the top.
+ * With equal total length, the point with the least travel so far goes first.
  * @param wd1 First distance to compare.
  * @param wd2 Second distance to compare.
- * @return Whether \a wd1 should come before \a wd2.
+ * @return Whether \a wd1 should be below \a wd2 in the heap.
  */
-bool operator<(const WalkedDistance &wd1, const WalkedDistance &wd2)
+static inline bool IsWorseOpenPoint(const WalkedDistance &wd1, const WalkedDistance &wd2)
 {
-	uint32 total1 = wd1.traveled + wd1.estimate;
-	uint32 total2 = wd2.traveled + wd2.estimate;
-	if (total1 != total2) return total1 < total2;
-	return wd1.traveled < wd2.traveled;
+	if (wd1.total != wd2.total) return wd1.total > wd2.total;
+	return wd1.traveled > wd2.traveled;
 }
 
 /**
- * Constructor, find a path to (\a dest_x, \a dest_y, \a dest_z). Give starting points through PathSearcher::AddStart.
- * @param dest_vox Coordinate of the destination voxel.
+ * Path searcher constructor.
+ * @param dest_vox Destination voxel of the search.
  */
 PathSearcher::PathSearcher(const XYZPoint16 &dest_vox)
 {
 	this->dest_vox = dest_vox;
-	this->dest_pos = nullptr;
+	this->Clear();
 }
 
 /**
- * Add a starting point to the searcher.
- * @param start_vox Coordinate of the start voxel.
+ * Add a starting point to the path searcher.
+ * @param start_vox Starting voxel position.
  */
 void PathSearcher::AddStart(const XYZPoint16 &start_vox)
 {
-	this->AddOpen(start_vox, 0, nullptr);
+	this->AddOpen(start_vox, 0, INVALID_WALK_INDEX);
 }
 
 /**
@@ -89,98 +113,219 @@ inline uint32 PathSearcher::GetEstimate(const XYZPoint16 &vox)
 	return val;
 }
 
+/**
+ * Get the index of a voxel in the walk information.
+ * @param vox Position of the voxel.
+ * @return Index of the voxel.
+ */
+inline uint32 PathSearcher::GetIndex(const XYZPoint16 &vox) const
+{
+	return ((uint32)vox.z * _walk_storage.ysize + vox.y) * _walk_storage.xsize + vox.x;
+}
+
+/**
+ * Get the voxel position of an index in the walk information.
+ * @param index Index of the voxel.
+ * @return Position of the voxel.
+ */
+inline XYZPoint16 PathSearcher::GetVoxel(uint32 index) const
+{
+	uint16 x = index % _walk_storage.xsize;
+	index /= _walk_storage.xsize;
+	uint16 y = index % _walk_storage.ysize;
+	return XYZPoint16(x, y, index / _walk_storage.ysize);
+}
+
 /**
  * Add a new open position to the set of open points, if it is better than already available.
  * @param vox Position of the current position.
  * @param traveled Distance traveled to get to the current position.
- * @param prev_pos Previous position (\c nullptr for the start position).
+ * @param prev_index Index of the previous position (#INVALID_WALK_INDEX for the start position).
  */
-void PathSearcher::AddOpen(const XYZPoint16 &vox, uint32 traveled, const WalkedPosition *prev_pos)
+void PathSearcher::AddOpen(const XYZPoint16 &vox, uint32 traveled, uint32 prev_index)
 {
-	uint32 estimate = this->GetEstimate(vox);
-	WalkedPosition wp(vox, traveled, estimate, prev_pos);
+	uint32 index = this->GetIndex(vox);
+	WalkedPosition &wp = _walk_storage.positions[index];
+	/* The estimate only depends on the position, comparing travel distance is sufficient. */
+	if (wp.search == _walk_storage.search && wp.traveled <= traveled) return;
 
-	/* Find the position. */
-	PositionSet::iterator pos_iter = this->positions.find(wp);
-	if (pos_iter == positions.end()) { // New position.
-		pos_iter = this->positions.insert(wp).first;
-		this->open_points.emplace(traveled, estimate, &(*pos_iter));
-		return;
-	}
-	/* Existing position, update if needed. */
-	const WalkedPosition *pwp = &(*pos_iter);
-	if (pwp->traveled + pwp->estimate <= traveled + estimate) return;
+	wp.search = _walk_storage.search;
+	wp.traveled = traveled; // Makes any older open point of the position invalid.
+	wp.prev = prev_index;
 
-	/* New one is better, update. */
-	pwp->traveled = traveled;
-	pwp->estimate = estimate; // The sum is changed, making any old open points invalid.
-	pwp->prev_pos = prev_pos;
-	this->open_points.emplace(traveled, estimate, pwp);
+	_walk_storage.open_points.push_back({traveled + this->GetEstimate(vox), traveled, index});
+	std::push_heap(_walk_storage.open_points.begin(), _walk_storage.open_points.end(), IsWorseOpenPoint);
 }
 
 /**
- * Search for a path to the destination.
- * @return Whether a path has been found.
+ * Perform the search.
+ * @return Whether a path was found.
  */
 bool PathSearcher::Search()
 {
-	this->dest_pos = nullptr;
-	while (!this->open_points.empty()) {
-		WalkedDistance wd = *this->open_points.begin();
-		this->open_points.erase(this->open_points.begin());
+	std::vector<WalkedDistance> &open_points = _walk_storage.open_points;
+	while (!open_points.empty()) {
+		std::pop_heap(open_points.begin(), open_points.end(), IsWorseOpenPoint);
+		WalkedDistance wd = open_points.back();
+		open_points.pop_back();
 
-		if (wd.traveled != wd.pos->traveled || wd.estimate != wd.pos->estimate) continue; // Invalid open point.
+		if (wd.traveled != _walk_storage.positions[wd.index].traveled) continue; // Invalid open point.
 
 		/* Reached the destination? */
-		const WalkedPosition *wp = wd.pos;
-		if (wp->cur_vox == this->dest_vox) {
-			this->dest_pos = wp;
-			return true;
-		}
+		XYZPoint16 cur_vox = this->GetVoxel(wd.index);
+		if (cur_vox == this->dest_vox) return true;
 
 		/* Add new open points. */
-		const Voxel *v = _world.GetVoxel(wp->cur_vox);
+		const Voxel *v = _world.GetVoxel(cur_vox);
 		if (v == nullptr) continue; // No voxel at the expected point, don't bother.
 
 		uint8 exits = GetPathExits(v);
 		for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
-			if ((exits & (0x11 << edge)) == 0) continue;
-
-			/* There is an outgoing connection, is it also on the world? */
-			Point16 dxy = _tile_dxy[edge];
-			if (dxy.x < 0 && wp->cur_vox.x == 0) continue;
-			if (dxy.x > 0 && wp->cur_vox.x + 1 == _world.GetXSize()) continue;
-			if (dxy.y < 0 && wp->cur_vox.y == 0) continue;
-			if (dxy.y > 0 && wp->cur_vox.y + 1 == _world.GetYSize()) continue;
-
-			int extra_z = ((exits & (0x10 << edge)) != 0);
-			if (wp->cur_vox.z + extra_z < 0 || wp->cur_vox.z + extra_z >= WORLD_Z_SIZE) continue;
-
-			/* Now check the other side, new_z is the voxel where the path should be at the bottom. */
-			const Voxel *v2 = _world.GetVoxel(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
-			if (v2 == nullptr) continue;
-
-			uint8 other_exits = GetPathExits(v2);
-			if ((other_exits & (1 << ((edge + 2) % 4))) == 0) { // No path here, try one voxel below
-				extra_z--;
-				if (wp->cur_vox.z + extra_z < 0) continue;
-				v2 = _world.GetVoxel(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
-				if (v2 == nullptr) continue;
-				other_exits = GetPathExits(v2);
-				if ((other_exits & (0x10 << ((edge + 2) % 4))) == 0) continue;
-			}
-			/* Add new open point to the path finder. */
-			this->AddOpen(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z), wp->traveled + 1, wp);
+			XYZPoint16 next_vox;
+			if (GetConnectedPath(cur_vox, exits, edge, &next_vox)) this->AddOpen(next_vox, wd.traveled + 1, wd.index);
 		}
 	}
 	return false;
 }
 
-/** Clear the used data structures of the path searcher. */
+/** Clean up the search data, and start a new search. */
 void PathSearcher::Clear()
 {
-	this->open_points.clear();
-	this->positions.clear();
-	this->dest_pos = nullptr;
+	WalkStorage &ws = _walk_storage;
+	ws.open_points.clear();
+
+	if (ws.xsize != _world.GetXSize() || ws.ysize != _world.GetYSize()) {
+		ws.xsize = _world.GetXSize();
+		ws.ysize = _world.GetYSize();
+		ws.positions.assign((size_t)ws.xsize * ws.ysize * WORLD_Z_SIZE, {0, 0, INVALID_WALK_INDEX});
+		ws.search = 0;
+	}
+	ws.search++;
+	if (ws.search == 0) { // Search number wrapped around, all walk information must be invalidated.
+		for (WalkedPosition &wp : ws.positions) wp.search = 0;
+		ws.search = 1;
+	}
 }
 
+/**
+ * After finding a path, get the position before the given position in the found path.
+ * @param vox Position in the path, for example the destination.
+ * @param prev_vox [out] Position before \a vox in the path.
+ * @return Whether a previous position exists (\c false if \a vox is a starting point or was not reached).
+ */
+bool PathSearcher::GetPreviousPosition(const XYZPoint16 &vox, XYZPoint16 *prev_vox) const
+{
+	const WalkedPosition &wp = _walk_storage.positions[this->GetIndex(vox)];
+	if (wp.search != _walk_storage.search || wp.prev == INVALID_WALK_INDEX) return false;
+
+	*prev_vox = this->GetVoxel(wp.prev);
+	return true;
+}
+
+static const uint16 UNREACHED_DISTANCE = UINT16_MAX; ///< Distance of voxels that cannot reach a destination.
+
+PathDistances::PathDistances() : xsize(0), ysize(0), valid(false)
+{
+}
+
+/**
+ * Get the index of a voxel in the distances.
+ * @param vox Position of the voxel.
+ * @return Index of the voxel.
+ */
+inline uint32 PathDistances::GetIndex(const XYZPoint16 &vox) const
+{
+	return ((uint32)vox.z * this->ysize + vox.y) * this->xsize + vox.x;
+}
+
+/** Start computing new distances, all voxels are unreachable until destinations are added. */
+void PathDistances::Reset()
+{
+	this->xsize = _world.GetXSize();
+	this->ysize = _world.GetYSize();
+	this->distances.assign((size_t)this->xsize * this->ysize * WORLD_Z_SIZE, UNREACHED_DISTANCE);
+	this->queue.clear();
+	this->valid = false;
+}
+
+/**
+ * Add a destination voxel.
+ * @param vox Destination voxel with a path.
+ * @pre #Reset has been called.
+ */
+void PathDistances::AddDestination(const XYZPoint16 &vox)
+{
+	uint32 index = this->GetIndex(vox);
+	if (this->distances[index] == 0) return;
+
+	this->distances[index] = 0;
+	this->queue.push_back(index);
+}
+
+/** Compute the distances from all voxels of the path network to the nearest destination. */
+void PathDistances::Compute()
+{
+	/* Path connections work in both directions, walking from the destinations gives the distance to them. */
+	for (uint i = 0; i < this->queue.size(); i++) {
+		uint32 index = this->queue[i];
+		uint16 next_distance = this->distances[index] + 1;
+		if (next_distance == UNREACHED_DISTANCE) continue; // Too far away to store.
+
+		XYZPoint16 cur_vox(index % this->xsize, (index / this->xsize) % this->ysize, index / ((uint32)this->xsize * this->ysize));
+		const Voxel *v = _world.GetVoxel(cur_vox);
+		if (v == nullptr) continue;
+
+		uint8 exits = GetPathExits(v);
+		for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+			XYZPoint16 next_vox;
+			if (!GetConnectedPath(cur_vox, exits, edge, &next_vox)) continue;
+
+			uint32 next_index = this->GetIndex(next_vox);
+			if (this->distances[next_index] != UNREACHED_DISTANCE) continue; // Already reached with a shorter or equal distance.
+			this->distances[next_index] = next_distance;
+			this->queue.push_back(next_index);
+		}
+	}
+	this->queue.clear();
+	this->valid = true;
+}
+
+/**
+ * Get the direction to walk from a voxel to get closer to the nearest destination.
+ * @param vox Current position.
+ * @return Edge to leave the voxel, or #INVALID_EDGE if no destination can be reached or the voxel is a destination.
+ * @pre The distances are valid.
+ */
+TileEdge PathDistances::GetDirection(const XYZPoint16 &vox) const
+{
+	assert(this->valid);
+	if (vox.x < 0 || vox.x >= this->xsize || vox.y < 0 || vox.y >= this->ysize || vox.z < 0 || vox.z >= WORLD_Z_SIZE) return INVALID_EDGE;
+
+	uint16 best_distance = this->distances[this->GetIndex(vox)];
+	if (best_distance == 0 || best_distance == UNREACHED_DISTANCE) return INVALID_EDGE;
+
+	const Voxel *v = _world.GetVoxel(vox);
+	if (v == nullptr) return INVALID_EDGE;
+
+	uint8 exits = GetPathExits(v);
+	TileEdge best_edge = INVALID_EDGE;
+	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+		XYZPoint16 next_vox;
+		if (!GetConnectedPath(vox, exits, edge, &next_vox)) continue;
+
+		uint16 distance = this->distances[this->GetIndex(next_vox)];
+		if (distance < best_distance) {
+			best_distance = distance;
+			best_edge = edge;
+		}
+	}
+	return best_edge;
+}
+
+/** The path network or the park changed, all path distances must be computed again. */
+void InvalidatePathDistances()
+{
+	_park_entry_distances.Invalidate();
+	_go_home_distances.Invalidate();
+	_go_home_voxel = XYZPoint16::invalid();
+}
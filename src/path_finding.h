@@ -10,35 +10,31 @@
 #ifndef PATH_FINDING_H
 #define PATH_FINDING_H
 
-#include <set>
+#include <vector>
 
 #include "geometry.h"
+#include "tile.h"
 
-/** Intermediate position of a walk. */
-class WalkedPosition {
-public:
-	WalkedPosition(const XYZPoint16 &cur_vox, uint32 traveled, uint32 estimate, const WalkedPosition *prev_pos);
-
-	XYZPoint16 cur_vox; ///< Coordinate of the current position.
-	mutable uint32 traveled; ///< Length of the traveled path so far.
-	mutable uint32 estimate; ///< Estimated distance to the destination.
-	mutable const WalkedPosition *prev_pos; ///< Position coming from (\c nullptr for initial position).
+/** Walk information of a voxel in a path search. */
+struct WalkedPosition {
+	uint32 search;   ///< Number of the search that last reached the voxel, other values are outdated.
+	uint32 traveled; ///< Length of the traveled path so far.
+	uint32 prev;     ///< Index of the voxel coming from (#INVALID_WALK_INDEX for initial position).
 };
 
 /** Guessed path length at a (partially) explored position. */
-class WalkedDistance {
-public:
-	WalkedDistance(uint32 traveled, uint32 estimate, const WalkedPosition *pos);
-
+struct WalkedDistance {
+	uint32 total;    ///< Length of the traveled path so far plus the estimated distance to the destination.
 	uint32 traveled; ///< Length of the traveled path so far.
-	uint32 estimate; ///< Estimated distance to the destination.
-	const WalkedPosition *pos; ///< Current position.
+	uint32 index;    ///< Index of the voxel of the position.
 };
 
-typedef std::set<WalkedPosition> PositionSet;	  ///< Visited positions (best solution so far).
-typedef std::multiset<WalkedDistance> OpenPoints; ///< Points for further exploration.
+static const uint32 INVALID_WALK_INDEX = UINT32_MAX; ///< Voxel index denoting 'no voxel'.
 
-/** Class for searching (and hopefully finding) a path between tiles. */
+/**
+ * Class for searching (and hopefully finding) a path between tiles.
+ * The searcher uses storage that is shared by all searches of a thread, only one search per thread may be active.
+ */
 class PathSearcher {
 public:
 	PathSearcher(const XYZPoint16 &dest_vox);
@@ -47,16 +43,61 @@ public:
 	bool Search();
 	void Clear();
 
+	bool GetPreviousPosition(const XYZPoint16 &vox, XYZPoint16 *prev_vox) const;
+
 	XYZPoint16 dest_vox; ///< Coordinate of the desired destination voxel.
-	const WalkedPosition *dest_pos; ///< If path was found, this points to the end-point of the walk.
 
 protected:
-	PositionSet positions;   ///< Examined positions.
-	OpenPoints  open_points; ///< Open points to examine further.
-
 	inline uint32 GetEstimate(const XYZPoint16 &vox);
-	void AddOpen(const XYZPoint16 &vox, uint32 traveled, const WalkedPosition *prev_pos);
+	inline uint32 GetIndex(const XYZPoint16 &vox) const;
+	inline XYZPoint16 GetVoxel(uint32 index) const;
+	void AddOpen(const XYZPoint16 &vox, uint32 traveled, uint32 prev_index);
 };
 
+/**
+ * Walking distances over the path network to a set of destination voxels.
+ * The distances are computed once with a breadth-first search from the destinations, and kept until the path network changes.
+ */
+class PathDistances {
+public:
+	PathDistances();
+
+	/**
+	 * Are the distances up to date?
+	 * @return Whether the distances can be used.
+	 */
+	inline bool IsValid() const
+	{
+		return this->valid;
+	}
+
+	/** The path network changed, the distances must be computed again. */
+	inline void Invalidate()
+	{
+		this->valid = false;
+	}
+
+	void Reset();
+	void AddDestination(const XYZPoint16 &vox);
+	void Compute();
+
+	TileEdge GetDirection(const XYZPoint16 &vox) const;
+
+protected:
+	inline uint32 GetIndex(const XYZPoint16 &vox) const;
+
+	std::vector<uint16> distances; ///< Walking distance of each voxel to the nearest destination.
+	std::vector<uint32> queue;     ///< Voxel indices to examine in the breadth-first search.
+	uint16 xsize;                  ///< Horizontal size of the world that #distances covers.
+	uint16 ysize;                  ///< Vertical size of the world that #distances covers.
+	bool valid;                    ///< Whether the distances are up to date.
+};
+
+void InvalidatePathDistances();
+
+extern PathDistances _park_entry_distances;
+extern PathDistances _go_home_distances;
+extern XYZPoint16 _go_home_voxel;
+
 #endif
 
@@ -17,9 +17,12 @@
 #include "person.h"
 #include "people.h"
 #include "gamelevel.h"
+#include "worker_pool.h"
 
 Guests _guests; ///< %Guests in the world/park.
 
+static const uint ANIMATE_CHUNK_SIZE = 256; ///< Number of guests in a job of the concurrent part of the guest animation.
+
 /**
  * Guest block constructor. Fills the id of the persons with an incrementing number.
  * @param base_id Id number of the first person in this block.
@@ -66,9 +69,10 @@ static Point16 FindEdgeRoad()
 	return {-1, -1};
 }
 
-Guests::Guests() : block(0), rnd()
+Guests::Guests() : rnd()
 {
-	this->free_idx = 0;
+	std::fill_n(this->activity_counts, lengthof(this->activity_counts), 0);
+	std::fill_n(this->queue_heads, lengthof(this->queue_heads), nullptr);
 	this->start_voxel.x = -1;
 	this->start_voxel.y = -1;
 	this->daily_frac = 0;
@@ -82,13 +86,12 @@ Guests::~Guests()
 /** Deactivate all guests and reset variables. */
 void Guests::Uninitialize()
 {
-	for (int i = 0; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *g = this->block.Get(i);
-		if (g->IsActive()) {
-			g->DeActivate(OAR_REMOVE);
-			this->AddFree(g);
-		}
+	while (!this->active.empty()) {
+		Guest *g = this->Get(this->active.back());
+		g->DeActivate(OAR_REMOVE);
+		this->AddFree(g);
 	}
+	this->ResetFreeGuests();
 	this->start_voxel.x = -1;
 	this->start_voxel.y = -1;
 	this->daily_frac = 0;
@@ -102,21 +105,35 @@ void Guests::Uninitialize()
 void Guests::Load(Loader &ldr)
 {
 	uint32 version = ldr.OpenBlock("GSTS");
-	if (version == 1) {
+	if (version == 1 || version == 2) {
 		this->start_voxel.x = ldr.GetWord();
 		this->start_voxel.y = ldr.GetWord();
 		this->daily_frac = ldr.GetWord();
 		this->next_daily_index = ldr.GetWord();
-		this->free_idx = ldr.GetLong();
+		if (version == 1) ldr.GetLong(); // Index of the first free guest, no longer used.
 		uint active_guest_count = ldr.GetLong();
-		for (uint i = 0; i < active_guest_count; i++) {
-			Guest *g = this->block.Get(ldr.GetWord());
+		for (uint i = 0; i < active_guest_count && !ldr.IsFail(); i++) {
+			uint32 id = ldr.GetWord();
+			if (id >= MAX_GUEST_BLOCKS * GUEST_BLOCK_SIZE) {
+				ldr.SetFailMessage("Incorrect guest id.");
+				break;
+			}
+			while (id >= this->blocks.size() * GUEST_BLOCK_SIZE) this->AddBlock();
+
+			Guest *g = this->Get(id);
+			if (this->active_pos[id] != INVALID_ACTIVE_POS) this->AddFree(g); // Guest is replaced by the loaded one.
 			g->Load(ldr);
+			if (g->IsActive()) {
+				this->AddActive(g);
+				this->UpdateQueuingGuest(g);
+			}
 		}
+		if (version == 1) this->next_daily_index = 0; // Old index was a guest id rather than a position in the active guests.
 	} else {
 		ldr.SetFailMessage("Incorrect version of Guests block.");
 	}
 	ldr.CloseBlock();
+	this->ResetFreeGuests();
 }
 
 /**
@@ -125,78 +142,40 @@ void Guests::Load(Loader &ldr)
  */
 void Guests::Save(Saver &svr)
 {
-	svr.StartBlock("GSTS", 1);
+	svr.StartBlock("GSTS", 2);
 	svr.PutWord(this->start_voxel.x);
 	svr.PutWord(this->start_voxel.y);
 	svr.PutWord(this->daily_frac);
 	svr.PutWord(this->next_daily_index);
-	svr.PutLong(this->free_idx);
-	svr.PutLong(this->CountActiveGuests());
-	for (uint i = 0; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *g = this->block.Get(i);
-		if (g->IsActive()) {
-			svr.PutWord(g->id);
-			g->Save(svr);
-		}
+	svr.PutLong(this->active.size());
+	for (uint16 id : this->active) {
+		svr.PutWord(id);
+		this->Get(id)->Save(svr);
 	}
 	svr.EndBlock();
 }
 
-/**
- * Update #free_idx to the next free guest (if available).
- * @return Whether a free guest was found.
- */
-bool Guests::FindNextFreeGuest()
+/** Add a new block of non-active guests. */
+void Guests::AddBlock()
 {
-	while (this->free_idx < GUEST_BLOCK_SIZE) {
-		Guest *g = this->block.Get(this->free_idx);
-		if (!g->IsActive()) return true;
-		this->free_idx++;
-	}
-	return false;
-}
+	assert(this->blocks.size() < MAX_GUEST_BLOCKS);
 
-/**
- * Update #free_idx to the next free guest (if available).
- * @return Whether a free guest was found.
- */
-bool Guests::FindNextFreeGuest() const
-{
-	uint idx = this->free_idx;
-	while (idx < GUEST_BLOCK_SIZE) {
-		const Guest *g = this->block.Get(idx);
-		if (!g->IsActive()) return true;
-		idx++;
-	}
-	return false;
-}
+	uint16 base_id = this->blocks.size() * GUEST_BLOCK_SIZE;
+	this->blocks.emplace_back(new GuestBlock(base_id));
+	this->active_pos.resize(this->blocks.size() * GUEST_BLOCK_SIZE, INVALID_ACTIVE_POS);
+	this->animate_results.resize(this->blocks.size() * GUEST_BLOCK_SIZE, APR_DONE);
 
-/**
- * Count the number of active guests.
- * @return The number of active guests.
- */
-uint Guests::CountActiveGuests()
-{
-	uint count = this->free_idx;
-	for (uint i = this->free_idx; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *g = this->block.Get(i);
-		if (g->IsActive()) count++;
-	}
-	return count;
+	/* Push in reverse order, so the lowest id is used first. */
+	for (int i = GUEST_BLOCK_SIZE - 1; i >= 0; i--) this->free_ids.push_back(base_id + i);
 }
 
-/**
- * Count the number of guests in the park.
- * @return The number of guests in the park.
- */
-uint Guests::CountGuestsInPark()
+/** Rebuild the stack of non-active guests from the active guests. */
+void Guests::ResetFreeGuests()
 {
-	uint count = 0;
-	for (uint i = 0; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *g = this->block.Get(i);
-		if (g->IsActive() && g->IsInPark()) count++;
+	this->free_ids.clear();
+	for (int id = this->blocks.size() * GUEST_BLOCK_SIZE - 1; id >= 0; id--) {
+		if (this->active_pos[id] == INVALID_ACTIVE_POS) this->free_ids.push_back(id);
 	}
-	return count;
 }
 
 /**
@@ -205,15 +184,36 @@ uint Guests::CountGuestsInPark()
  */
 void Guests::OnAnimate(int delay)
 {
-	for (int i = 0; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *p = this->block.Get(i);
-		if (!p->IsActive()) continue;
+	/* First do the part of the animation that only changes the guest itself, for all guests concurrently. */
+	uint count = this->active.size();
+	_worker_pool.Run((count + ANIMATE_CHUNK_SIZE - 1) / ANIMATE_CHUNK_SIZE, [this, count, delay](uint chunk) {
+		uint end = std::min(count, (chunk + 1) * ANIMATE_CHUNK_SIZE);
+		for (uint i = chunk * ANIMATE_CHUNK_SIZE; i < end; i++) {
+			uint16 id = this->active[i];
+			this->animate_results[id] = this->Get(id)->PrepareAnimate(delay);
+		}
+	});
 
-		AnimateResult ar = p->OnAnimate(delay);
+	/* Complete the animation of the guests in order, like updating all guests one after the other would do. */
+	uint i = 0;
+	while (i < this->active.size()) {
+		uint16 id = this->active[i];
+		Guest *p = this->Get(id);
+		AnimateResult ar = OAR_OK;
+		switch (this->animate_results[id]) {
+			case APR_DONE:  break;
+			case APR_MOVED: p->MarkDirty(); break;
+			case APR_STEP:  ar = p->AnimateStep(delay); break;
+			default: NOT_REACHED();
+		}
 		if (ar != OAR_OK) {
 			p->DeActivate(ar);
-			this->AddFree(p);
+		} else {
+			this->UpdateQueuingGuest(p);
 		}
+
+		/* A de-activated guest is replaced by the last active guest, which should be handled next. */
+		if (i < this->active.size() && this->active[i] == id) i++;
 	}
 }
 
@@ -221,16 +221,20 @@ void Guests::OnAnimate(int delay)
 void Guests::DoTick()
 {
 	this->daily_frac++;
-	int end_index = std::min(this->daily_frac * GUEST_BLOCK_SIZE / TICK_COUNT_PER_DAY, GUEST_BLOCK_SIZE);
+	int end_index = this->active.size();
+	if (this->daily_frac < TICK_COUNT_PER_DAY) end_index = std::min<int>(this->daily_frac * end_index / TICK_COUNT_PER_DAY, end_index);
 	while (this->next_daily_index < end_index) {
-		Guest *p = this->block.Get(this->next_daily_index);
-		if (p->IsActive() && !p->DailyUpdate()) {
+		uint16 id = this->active[this->next_daily_index];
+		Guest *p = this->Get(id);
+		if (!p->DailyUpdate()) {
 			p->DeActivate(OAR_REMOVE);
-			this->AddFree(p);
+			end_index = std::min<int>(end_index, this->active.size());
+			/* The last active guest took the place of the removed guest, it should be handled next. */
+			if (this->next_daily_index < (int)this->active.size() && this->active[this->next_daily_index] != id) continue;
 		}
 		this->next_daily_index++;
 	}
-	if (this->next_daily_index >= GUEST_BLOCK_SIZE) {
+	if (this->daily_frac >= TICK_COUNT_PER_DAY) {
 		this->daily_frac = 0;
 		this->next_daily_index = 0;
 	}
@@ -252,10 +256,22 @@ void Guests::OnNewDay()
 		if (!IsGoodEdgeRoad(this->start_voxel.x, this->start_voxel.y)) return;
 	}
 
-	if (!this->HasFreeGuests()) return; // No more quests available.
-	/* New guest! */
+	this->AddGuest(this->start_voxel); // New guest!
+}
+
+/**
+ * Add a new guest to the world.
+ * @param start Voxel stack at the edge of the world where the guest enters.
+ * @return The new guest, or \c nullptr if no more guests are available.
+ */
+Guest *Guests::AddGuest(const Point16 &start)
+{
+	if (!this->HasFreeGuests()) return nullptr; // No more quests available.
+
 	Guest *g = this->GetFree();
-	g->Activate(this->start_voxel, PERSON_GUEST);
+	g->Activate(start, PERSON_GUEST);
+	this->AddActive(g);
+	return g;
 }
 
 /**
@@ -263,11 +279,8 @@ void Guests::OnNewDay()
  * @param ri Ride being removed.
  */
 void Guests::NotifyRideDeletion(const RideInstance *ri) {
-	for (int i = 0; i < GUEST_BLOCK_SIZE; i++) {
-		Guest *p = this->block.Get(i);
-		if (!p->IsActive()) continue;
-
-		p->NotifyRideDeletion(ri);
+	for (uint16 id : this->active) {
+		this->Get(id)->NotifyRideDeletion(ri);
 	}
 }
 
@@ -277,16 +290,41 @@ void Guests::NotifyRideDeletion(const RideInstance *ri) {
  */
 bool Guests::HasFreeGuests() const
 {
-	return this->FindNextFreeGuest();
+	return !this->free_ids.empty() || this->blocks.size() < MAX_GUEST_BLOCKS;
 }
 
 /**
- * Add a guest to the non-active list.
+ * Add a guest to the non-active list. (Called by the guest on de-activation.)
  * @param g %Guest to add.
  */
 void Guests::AddFree(Guest *g)
 {
-	this->free_idx = std::min(this->block.Index(g), this->free_idx);
+	uint16 id = g->id;
+	uint32 pos = this->active_pos[id];
+	if (pos == INVALID_ACTIVE_POS) return;
+
+	/* Keep the guests that got their daily update already in front of #next_daily_index,
+	 * by first moving the last updated guest into the vacated position. */
+	if ((int)pos < this->next_daily_index) {
+		this->next_daily_index--;
+		uint16 updated = this->active[this->next_daily_index];
+		this->active[pos] = updated;
+		this->active_pos[updated] = pos;
+		pos = this->next_daily_index;
+	}
+
+	/* Move the last active guest into the vacated position. */
+	uint16 last = this->active.back();
+	this->active[pos] = last;
+	this->active_pos[last] = pos;
+	this->active.pop_back();
+	this->active_pos[id] = INVALID_ACTIVE_POS;
+
+	assert(this->activity_counts[g->activity] > 0);
+	this->activity_counts[g->activity]--;
+	this->RemoveQueuingGuest(g);
+
+	this->free_ids.push_back(id);
 }
 
 /**
@@ -296,10 +334,61 @@ void Guests::AddFree(Guest *g)
  */
 Guest *Guests::GetFree()
 {
-	bool b = this->FindNextFreeGuest();
-	assert(b);
+	if (this->free_ids.empty()) this->AddBlock();
 
-	Guest *g = this->block.Get(this->free_idx);
-	this->free_idx++;
-	return g;
+	uint16 id = this->free_ids.back();
+	this->free_ids.pop_back();
+	return this->Get(id);
+}
+
+/**
+ * Add a guest that just became active to the active guests.
+ * @param g %Guest to add.
+ */
+void Guests::AddActive(Guest *g)
+{
+	assert(this->active_pos[g->id] == INVALID_ACTIVE_POS);
+	this->active_pos[g->id] = this->active.size();
+	this->active.push_back(g->id);
+	this->activity_counts[g->activity]++;
+}
+
+/**
+ * Update the queuing guests of the voxel stacks for a guest that may have changed position or activity.
+ * @param g %Guest to update.
+ */
+void Guests::UpdateQueuingGuest(Guest *g)
+{
+	int32 stack = -1;
+	if (g->IsQueuingGuest() && IsVoxelstackInsideWorld(g->vox_pos.x, g->vox_pos.y)) stack = g->vox_pos.x + g->vox_pos.y * WORLD_X_SIZE;
+	if (stack == g->queue_stack) return;
+
+	this->RemoveQueuingGuest(g);
+	if (stack < 0) return;
+
+	g->queue_stack = stack;
+	g->prev_queuing = nullptr;
+	g->next_queuing = this->queue_heads[stack];
+	if (g->next_queuing != nullptr) g->next_queuing->prev_queuing = g;
+	this->queue_heads[stack] = g;
+}
+
+/**
+ * Remove a guest from the queuing guests of the voxel stacks.
+ * @param g %Guest to remove.
+ */
+void Guests::RemoveQueuingGuest(Guest *g)
+{
+	if (g->queue_stack < 0) return;
+
+	if (g->prev_queuing != nullptr) {
+		g->prev_queuing->next_queuing = g->next_queuing;
+	} else {
+		this->queue_heads[g->queue_stack] = g->next_queuing;
+	}
+	if (g->next_queuing != nullptr) g->next_queuing->prev_queuing = g->prev_queuing;
+
+	g->prev_queuing = nullptr;
+	g->next_queuing = nullptr;
+	g->queue_stack = -1;
 }
@@ -10,6 +10,9 @@
 #ifndef PEOPLE_H
 #define PEOPLE_H
 
+#include <memory>
+#include <vector>
+
 static const int GUEST_BLOCK_SIZE = 512; ///< Number of guests in a block.
 
 /** A block of guests. */
@@ -44,7 +47,7 @@ public:
 	 * @param g %Guest object to query.
 	 * @return Index of the guest in the block.
 	 */
-	inline uint Index(Guest *g)
+	inline uint Index(const Guest *g) const
 	{
 		uint idx = g - this->guests;
 		assert(idx < lengthof(this->guests));
@@ -55,9 +58,13 @@ protected:
 	Guest guests[GUEST_BLOCK_SIZE]; ///< Persons in the block.
 };
 
+static const int MAX_GUEST_BLOCKS = 128; ///< Maximal number of guest blocks, guest ids must fit in 16 bits.
+static const uint32 INVALID_ACTIVE_POS = UINT32_MAX; ///< Position of a non-active guest in the active guests.
+
 /**
  * All our guests.
- * @todo Allow to have several blocks of guests.
+ * The guests are stored in blocks of #GUEST_BLOCK_SIZE guests, more blocks are added when all guests are in use.
+ * Active guests are kept in a list, so updates do not need to visit unused guests.
  */
 class Guests {
 public:
@@ -69,49 +76,135 @@ public:
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
 
-	uint CountActiveGuests();
-	uint CountGuestsInPark();
+	/**
+	 * Count the number of active guests.
+	 * @return The number of active guests.
+	 */
+	inline uint CountActiveGuests() const
+	{
+		return this->active.size();
+	}
+
+	/**
+	 * Count the number of active guests doing the given activity.
+	 * @param activity Activity to count.
+	 * @return The number of active guests doing the activity.
+	 */
+	inline uint CountGuestsWithActivity(GuestActivity activity) const
+	{
+		assert(activity < GA_COUNT);
+		return this->activity_counts[activity];
+	}
+
+	/**
+	 * Count the number of guests in the park.
+	 * @return The number of guests in the park.
+	 * @see Guest::IsInPark
+	 */
+	inline uint CountGuestsInPark() const
+	{
+		return this->CountActiveGuests() - this->activity_counts[GA_ENTER_PARK] - this->activity_counts[GA_GO_HOME];
+	}
+
+	/**
+	 * Count the number of guests queuing for a ride.
+	 * @return The number of queuing guests.
+	 */
+	inline uint CountQueuingGuests() const
+	{
+		return this->activity_counts[GA_QUEUING];
+	}
+
+	/**
+	 * Count the number of guests leaving the park.
+	 * @return The number of guests going home.
+	 */
+	inline uint CountLeavingGuests() const
+	{
+		return this->activity_counts[GA_GO_HOME];
+	}
+
+	/**
+	 * Update the guest statistics for a guest changing activity.
+	 * @param id Id of the guest.
+	 * @param old_activity Previous activity of the guest.
+	 * @param new_activity New activity of the guest.
+	 * @note A guest that is being activated is counted after activation, with its activity at that moment.
+	 */
+	inline void NotifyActivityChange(uint16 id, GuestActivity old_activity, GuestActivity new_activity)
+	{
+		if (this->active_pos[id] == INVALID_ACTIVE_POS) return; // Not an active guest (yet).
+		assert(this->activity_counts[old_activity] > 0);
+		this->activity_counts[old_activity]--;
+		this->activity_counts[new_activity]++;
+	}
 
 	/**
 	 * Get a guest from the array.
-	 * @param idx Index of the person (should be between \c 0 and #GUEST_BLOCK_SIZE).
+	 * @param idx Index of the person (should be less than #GUEST_BLOCK_SIZE times the number of blocks).
 	 * @return The requested person.
 	 */
 	inline Guest *Get(int idx)
 	{
-		return this->block.Get(idx);
+		assert(idx >= 0 && (uint)idx < this->blocks.size() * GUEST_BLOCK_SIZE);
+		return this->blocks[idx / GUEST_BLOCK_SIZE]->Get(idx % GUEST_BLOCK_SIZE);
 	}
 
 	/**
 	 * Get a guest from the array.
-	 * @param idx Index of the person (should be between \c 0 and #GUEST_BLOCK_SIZE).
+	 * @param idx Index of the person (should be less than #GUEST_BLOCK_SIZE times the number of blocks).
 	 * @return The requested person.
 	 */
 	inline const Guest *Get(int idx) const
 	{
-		return this->block.Get(idx);
+		assert(idx >= 0 && (uint)idx < this->blocks.size() * GUEST_BLOCK_SIZE);
+		return this->blocks[idx / GUEST_BLOCK_SIZE]->Get(idx % GUEST_BLOCK_SIZE);
 	}
 
 	void OnAnimate(int delay);
 	void DoTick();
 	void OnNewDay();
 
+	Guest *AddGuest(const Point16 &start);
+	void AddFree(Guest *g);
+
+	/**
+	 * Get the queuing guests at a voxel stack.
+	 * @param x X coordinate of the voxel stack.
+	 * @param y Y coordinate of the voxel stack.
+	 * @return First queuing guest at the voxel stack (continue with Guest::next_queuing), or \c nullptr.
+	 * @note The list is updated after each guest animation, guests may have stopped queuing or moved away since.
+	 */
+	inline const Guest *GetQueuingGuests(uint16 x, uint16 y) const
+	{
+		assert(x < WORLD_X_SIZE && y < WORLD_Y_SIZE);
+		return this->queue_heads[x + y * WORLD_X_SIZE];
+	}
+
+	void UpdateQueuingGuest(Guest *g);
+
 	void NotifyRideDeletion(const RideInstance *);
 
 	Point16 start_voxel;  ///< Entry x/y coordinate of the voxel stack at the edge (negative X/Y coordinate means invalid).
 
 private:
-	GuestBlock block;     ///< The data of all actual guests.
-	uint free_idx;        ///< All guests less than this index are active.
+	std::vector<std::unique_ptr<GuestBlock>> blocks; ///< The data of all actual guests.
+	std::vector<uint16> free_ids;    ///< Stack of non-active guests, the guest at the back is used first.
+	std::vector<uint16> active;      ///< Ids of the active guests.
+	std::vector<uint32> active_pos;  ///< For each guest, its index in #active, or #INVALID_ACTIVE_POS if not active.
+	std::vector<uint8> animate_results; ///< For each guest, the #AnimatePrepareResult of the current animation update.
+	uint activity_counts[GA_COUNT];  ///< Number of active guests for each activity.
+	Guest *queue_heads[WORLD_X_SIZE * WORLD_Y_SIZE]; ///< Queuing guests of each voxel stack.
 	Random rnd;           ///< Random number generator for creating new guests.
 	int daily_frac;       ///< Frame counter.
-	int next_daily_index; ///< Index of the next guest to give daily service.
+	int next_daily_index; ///< Index in #active of the next guest to give daily service.
 
-	bool FindNextFreeGuest();
-	bool FindNextFreeGuest() const;
 	bool HasFreeGuests() const;
-	void AddFree(Guest *g);
 	Guest *GetFree();
+	void AddActive(Guest *g);
+	void RemoveQueuingGuest(Guest *g);
+	void AddBlock();
+	void ResetFreeGuests();
 };
 
 extern Guests _guests;
@@ -536,7 +536,7 @@ void Guest::NotifyRideDeletion(const RideInstance *ri)
 	if (this->ride == ri) {
 		switch (this->activity) {
 			case GA_QUEUING:
-				this->activity = GA_WANDER;
+				this->SetActivity(GA_WANDER);
 				this->ride = nullptr;
 				break;
 
@@ -564,7 +564,7 @@ void Guest::ExitRide(RideInstance *ri, TileEdge entry)
 	this->vox_pos.x = exit_pos.x >> 8; this->pix_pos.x = exit_pos.x & 0xff;
 	this->vox_pos.y = exit_pos.y >> 8; this->pix_pos.y = exit_pos.y & 0xff;
 	this->vox_pos.z = exit_pos.z >> 8; this->pix_pos.z = exit_pos.z & 0xff;
-	this->activity = GA_WANDER;
+	this->SetActivity(GA_WANDER);
 	this->AddSelf(_world.GetCreateVoxel(this->vox_pos, false));
 	this->DecideMoveDirection();
 }
@@ -641,9 +641,12 @@ uint8 Guest::GetExitDirections(const Voxel *v, TileEdge start_edge, bool *seen_w
  */
 static TileEdge GetParkEntryDirection(const XYZPoint16 &pos)
 {
-	PathSearcher ps(pos); // Current position is the destination.
+	if (_park_entry_distances.IsValid()) return _park_entry_distances.GetDirection(pos);
 
-	/* Add path tiles with a connection to outside the park to the initial starting points. */
+	PathDistances &pd = _park_entry_distances;
+	pd.Reset();
+
+	/* Add path tiles with a connection to outside the park as destinations. */
 	for (int x = 0; x < _world.GetXSize() - 1; x++) {
 		for (int y = 0; y < _world.GetYSize() - 1; y++) {
 			const VoxelStack *vs = _world.GetStack(x, y);
@@ -653,7 +656,7 @@ static TileEdge GetParkEntryDirection(const XYZPoint16 &pos)
 					const Voxel *v = vs->voxels + offset;
 					if (HasValidPath(v) && GetImplodedPathSlope(v) < PATH_FLAT_COUNT &&
 							(GetPathExits(v) & ((1 << EDGE_SE) | (1 << EDGE_SW))) != 0) {
-						ps.AddStart(XYZPoint16(x, y, vs->base + offset));
+						pd.AddDestination(XYZPoint16(x, y, vs->base + offset));
 					}
 				}
 			} else {
@@ -663,7 +666,7 @@ static TileEdge GetParkEntryDirection(const XYZPoint16 &pos)
 					const Voxel *v = vs->voxels + offset;
 					if (HasValidPath(v) && GetImplodedPathSlope(v) < PATH_FLAT_COUNT &&
 							(GetPathExits(v) & (1 << EDGE_NE)) != 0) {
-						ps.AddStart(XYZPoint16(x + 1, y, vs->base + offset));
+						pd.AddDestination(XYZPoint16(x + 1, y, vs->base + offset));
 					}
 				}
 
@@ -673,19 +676,14 @@ static TileEdge GetParkEntryDirection(const XYZPoint16 &pos)
 					const Voxel *v = vs->voxels + offset;
 					if (HasValidPath(v) && GetImplodedPathSlope(v) < PATH_FLAT_COUNT &&
 							(GetPathExits(v) & (1 << EDGE_NW)) != 0) {
-						ps.AddStart(XYZPoint16(x, y + 1, vs->base + offset));
+						pd.AddDestination(XYZPoint16(x, y + 1, vs->base + offset));
 					}
 				}
 			}
 		}
 	}
-	if (!ps.Search()) return INVALID_EDGE; // Search failed.
-
-	const WalkedPosition *dest = ps.dest_pos;
-	const WalkedPosition *prev = dest->prev_pos;
-	if (prev == nullptr) return INVALID_EDGE; // Already at tile.
-
-	return GetAdjacentEdge(dest->cur_vox.x, dest->cur_vox.y, prev->cur_vox.x, prev->cur_vox.y);
+	pd.Compute();
+	return pd.GetDirection(pos);
 }
 
 /**
@@ -695,19 +693,16 @@ static TileEdge GetParkEntryDirection(const XYZPoint16 &pos)
  */
 static TileEdge GetGoHomeDirection(const XYZPoint16 &pos)
 {
-	PathSearcher ps(pos); // Current position is the destination.
-
 	int x = _guests.start_voxel.x;
 	int y = _guests.start_voxel.y;
-	ps.AddStart(XYZPoint16(x, y, _world.GetBaseGroundHeight(x, y)));
-
-	if (!ps.Search()) return INVALID_EDGE;
-
-	const WalkedPosition *dest = ps.dest_pos;
-	const WalkedPosition *prev = dest->prev_pos;
-	if (prev == nullptr) return INVALID_EDGE; // Already at tile.
-
-	return GetAdjacentEdge(dest->cur_vox.x, dest->cur_vox.y, prev->cur_vox.x, prev->cur_vox.y);
+	XYZPoint16 cur_home(x, y, _world.GetBaseGroundHeight(x, y));
+	if (!_go_home_distances.IsValid() || cur_home != _go_home_voxel) {
+		_go_home_voxel = cur_home;
+		_go_home_distances.Reset();
+		_go_home_distances.AddDestination(_go_home_voxel);
+		_go_home_distances.Compute();
+	}
+	return _go_home_distances.GetDirection(pos);
 }
 
 /**
@@ -741,7 +736,7 @@ void Guest::DecideMoveDirection()
 	if (this->activity == GA_ENTER_PARK && vs->owner == OWN_PARK) {
 		// \todo Pay the park fee, go home if insufficient monies.
 		NotifyChange(WC_BOTTOM_TOOLBAR, ALL_WINDOWS_OF_TYPE, CHG_GUEST_COUNT, 1);
-		this->activity = GA_WANDER;
+		this->SetActivity(GA_WANDER);
 		// Add some happiness?? (Somewhat useless as every guest enters the park. On the other hand, a nice point to configure difficulty level perhaps?)
 	}
 
@@ -765,13 +760,13 @@ void Guest::DecideMoveDirection()
 	/* Switch between wandering and queuing depending on being on a queue path and having a desired ride. */
 	if (this->activity == GA_WANDER) {
 		if (queue_path && this->ride != nullptr) {
-			this->activity = GA_QUEUING;
+			this->SetActivity(GA_QUEUING);
 		} else {
 			queue_path = false;
 		}
 	} else if (this->activity == GA_QUEUING) {
 		if (this->ride == nullptr) {
-			this->activity = GA_WANDER;
+			this->SetActivity(GA_WANDER);
 			queue_path = false;
 		}
 	}
@@ -932,36 +927,32 @@ bool Person::IsQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& p
 {
 	/*
 	 * To ensure that guests on a neighbouring tile are also considered, we also need to check
-	 * the next voxel in all four directions, as well as the one above and the one below that.
+	 * the next voxel stack in all four directions, at the same height, one above, or one below.
 	 */
+	static const Point16 stack_offsets[] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
 	const XYZPoint32 merged_pos = MergeCoordinates(vox_pos, pix_pos);
-	std::vector<XYZPoint16> voxels = {vox_pos};
-	for (const XYZPoint16& vx : {
-			vox_pos,
-			XYZPoint16(vox_pos.x + 1, vox_pos.y, vox_pos.z),
-			XYZPoint16(vox_pos.x - 1, vox_pos.y, vox_pos.z),
-			XYZPoint16(vox_pos.x, vox_pos.y + 1, vox_pos.z),
-			XYZPoint16(vox_pos.x, vox_pos.y - 1, vox_pos.z)}) {
-		if (!IsVoxelstackInsideWorld(vx.x, vx.y)) continue;
-
-		for (const XYZPoint16& checkme : {vx, XYZPoint16(vx.x, vx.y, vx.z + 1), XYZPoint16(vx.x, vx.y, vx.z - 1)}) {
-			const Voxel *voxel = _world.GetVoxel(checkme);
-			if (voxel == nullptr) continue;
-
-			for (VoxelObject *v = voxel->voxel_objects; v != nullptr; v = v->next_object) {
-				if (v == this) continue;
-				Guest *g = dynamic_cast<Guest*>(v);
-				if (g == nullptr || !g->IsQueuingGuest()) continue;
-
-				const XYZPoint32 coords = g->MergeCoordinates();
-				if (hypot(coords.x - merged_pos.x, coords.y - merged_pos.y) < QUEUE_DISTANCE) {
-					if (!only_in_front) return true;
-					const AnimationFrame &frame = this->frames[this->frame_index];
-					if (frame.dx > 0 && coords.x > merged_pos.x) return true;
-					if (frame.dx < 0 && coords.x < merged_pos.x) return true;
-					if (frame.dy > 0 && coords.y > merged_pos.y) return true;
-					if (frame.dy < 0 && coords.y < merged_pos.y) return true;
-				}
+	for (const Point16 &offset : stack_offsets) {
+		int x = vox_pos.x + offset.x;
+		int y = vox_pos.y + offset.y;
+		if (!IsVoxelstackInsideWorld(x, y)) continue;
+
+		for (const Guest *g = _guests.GetQueuingGuests(x, y); g != nullptr; g = g->next_queuing) {
+			if (g == this) continue;
+			/* Queuing guests are listed after their animation, skip guests that have left the queue since. */
+			if (!g->IsQueuingGuest() || g->vox_pos.x != x || g->vox_pos.y != y) continue;
+			if (g->vox_pos.z < vox_pos.z - 1 || g->vox_pos.z > vox_pos.z + 1) continue;
+
+			const XYZPoint32 coords = g->MergeCoordinates();
+			int32 dx = coords.x - merged_pos.x;
+			int32 dy = coords.y - merged_pos.y;
+			if (dx * dx + dy * dy < QUEUE_DISTANCE * QUEUE_DISTANCE) {
+				if (!only_in_front) return true;
+				const AnimationFrame &frame = this->frames[this->frame_index];
+				if (frame.dx > 0 && coords.x > merged_pos.x) return true;
+				if (frame.dx < 0 && coords.x < merged_pos.x) return true;
+				if (frame.dy > 0 && coords.y > merged_pos.y) return true;
+				if (frame.dy < 0 && coords.y < merged_pos.y) return true;
 			}
 		}
 	}
@@ -972,17 +963,46 @@ bool Person::IsQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& p
  * Update the animation of a person.
  * @param delay Amount of milliseconds since the last update.
  * @return Whether to keep the person active or how to deactivate him/her.
- * @return Result code of the visit.
  */
 AnimateResult Person::OnAnimate(int delay)
+{
+	switch (this->PrepareAnimate(delay)) {
+		case APR_DONE:  return OAR_OK;
+		case APR_MOVED: this->MarkDirty(); return OAR_OK;
+		case APR_STEP:  return this->AnimateStep(delay);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * First part of updating the animation of a person, which only changes the person itself.
+ * It does not look at other persons, and does not change anything in the world, so it can be done concurrently for different persons.
+ * @param delay Amount of milliseconds since the last update.
+ * @return What remains to be done for the update.
+ * @see OnAnimate
+ */
+AnimatePrepareResult Person::PrepareAnimate(int delay)
 {
 	this->frame_time -= delay;
-	if (this->frame_time > 0) return OAR_OK;
+	if (this->frame_time > 0) return APR_DONE;
 
-	this->MarkDirty(); // Marks the entire voxel dirty, which should be big enough even after moving.
+	/* Queuing guests check the guests in front of them, which must be done in order. */
+	if (this->frames == nullptr || this->frame_count == 0 || this->IsQueuingGuest()) return APR_STEP;
 
-	if (this->frames == nullptr || this->frame_count == 0) return OAR_REMOVE;
+	XYZPoint16 new_pix_pos;
+	if (this->ComputeFrameMove(&new_pix_pos)) return APR_STEP;
+
+	this->NextFrame(new_pix_pos);
+	return APR_MOVED;
+}
 
+/**
+ * Compute the movement of the current animation frame.
+ * @param new_pix_pos [out] Pixel position after the movement (z position is not updated).
+ * @return Whether the movement went beyond the limit of the current walk.
+ */
+bool Person::ComputeFrameMove(XYZPoint16 *new_pix_pos) const
+{
 	int16 x_limit = -1;
 	switch (GB(this->walk->limit_type, WLM_X_START, WLM_LIMIT_LENGTH)) {
 		case WLM_MINIMAL: x_limit =   0;                break;
@@ -1001,39 +1021,69 @@ AnimateResult Person::OnAnimate(int delay)
 		case WLM_MAXIMAL: y_limit = 255;                break;
 	}
 
-	uint16 index = this->frame_index;
-	const AnimationFrame *frame = &this->frames[index];
-	if (this->IsQueuingGuest() && this->IsQueuingGuestNearby(this->vox_pos, this->pix_pos, true)) {
-		/* Freeze in place if we are too close to the person queuing in front of us. */
-		this->frame_time += delay;
-		return OAR_OK;
-	}
-	this->pix_pos.x += frame->dx;
-	this->pix_pos.y += frame->dy;
+	const AnimationFrame *frame = &this->frames[this->frame_index];
+	*new_pix_pos = this->pix_pos;
+	new_pix_pos->x += frame->dx;
+	new_pix_pos->y += frame->dy;
 
 	bool reached = false; // Set to true when we are beyond the limit!
 	if ((this->walk->limit_type & (1 << WLM_END_LIMIT)) == WLM_X_COND) {
-		if (frame->dx > 0) reached |= this->pix_pos.x > x_limit;
-		if (frame->dx < 0) reached |= this->pix_pos.x < x_limit;
+		if (frame->dx > 0) reached |= new_pix_pos->x > x_limit;
+		if (frame->dx < 0) reached |= new_pix_pos->x < x_limit;
 
-		if (y_limit >= 0) this->pix_pos.y += sign(y_limit - this->pix_pos.y); // Also slowly move the other axis in the right direction.
+		if (y_limit >= 0) new_pix_pos->y += sign(y_limit - new_pix_pos->y); // Also slowly move the other axis in the right direction.
 	} else {
-		if (frame->dy > 0) reached |= this->pix_pos.y > y_limit;
-		if (frame->dy < 0) reached |= this->pix_pos.y < y_limit;
+		if (frame->dy > 0) reached |= new_pix_pos->y > y_limit;
+		if (frame->dy < 0) reached |= new_pix_pos->y < y_limit;
 
-		if (x_limit >= 0) this->pix_pos.x += sign(x_limit - this->pix_pos.x); // Also slowly move the other axis in the right direction.
+		if (x_limit >= 0) new_pix_pos->x += sign(x_limit - new_pix_pos->x); // Also slowly move the other axis in the right direction.
 	}
+	return reached;
+}
 
-	if (!reached) {
-		/* Not reached the end, do the next frame. */
-		index++;
-		if (this->frame_count <= index) index = 0;
-		this->frame_index = index;
-		this->frame_time = this->frames[index].duration;
+/**
+ * Move the person without reaching the end of the walk, and continue with the next animation frame.
+ * @param new_pix_pos New pixel position of the person (see #ComputeFrameMove).
+ */
+void Person::NextFrame(const XYZPoint16 &new_pix_pos)
+{
+	this->pix_pos.x = new_pix_pos.x;
+	this->pix_pos.y = new_pix_pos.y;
+
+	uint16 index = this->frame_index + 1;
+	if (this->frame_count <= index) index = 0;
+	this->frame_index = index;
+	this->frame_time = this->frames[index].duration;
+
+	this->pix_pos.z = GetZHeight(this->vox_pos, this->pix_pos.x, this->pix_pos.y);
+}
+
+/**
+ * Second part of updating the animation of a person, after #PrepareAnimate decided it was needed.
+ * @param delay Amount of milliseconds since the last update.
+ * @return Whether to keep the person active or how to deactivate him/her.
+ * @see OnAnimate
+ */
+AnimateResult Person::AnimateStep(int delay)
+{
+	this->MarkDirty(); // Marks the entire voxel dirty, which should be big enough even after moving.
+
+	if (this->frames == nullptr || this->frame_count == 0) return OAR_REMOVE;
+
+	if (this->IsQueuingGuest() && this->IsQueuingGuestNearby(this->vox_pos, this->pix_pos, true)) {
+		/* Freeze in place if we are too close to the person queuing in front of us. */
+		this->frame_time += delay;
+		return OAR_OK;
+	}
 
-		this->pix_pos.z = GetZHeight(this->vox_pos, this->pix_pos.x, this->pix_pos.y);
+	XYZPoint16 new_pix_pos;
+	if (!this->ComputeFrameMove(&new_pix_pos)) {
+		/* Not reached the end, do the next frame. */
+		this->NextFrame(new_pix_pos);
 		return OAR_OK;
 	}
+	this->pix_pos.x = new_pix_pos.x;
+	this->pix_pos.y = new_pix_pos.y;
 
 	/* Reached the goal, start the next walk. */
 	if (this->walk[1].anim_type != ANIM_INVALID) {
@@ -1174,6 +1224,9 @@ RideVisitDesire Person::WantToVisit(const RideInstance *ri)
 
 Guest::Guest() : Person()
 {
+	this->prev_queuing = nullptr;
+	this->next_queuing = nullptr;
+	this->queue_stack = -1;
 }
 
 Guest::~Guest()
@@ -1214,11 +1267,22 @@ void Guest::DeActivate(AnimateResult ar)
 		delete wi;
 
 		/// \todo Evaluate Guest::total_happiness against scenario requirements for evaluating the park value.
+		_guests.AddFree(this);
 	}
 
 	this->Person::DeActivate(ar);
 }
 
+/**
+ * Change the activity of the guest.
+ * @param new_activity New activity of the guest.
+ */
+void Guest::SetActivity(GuestActivity new_activity)
+{
+	_guests.NotifyActivityChange(this->id, this->activity, new_activity);
+	this->activity = new_activity;
+}
+
 /**
  * Load a guest from the save game.
  * @param ldr Input stream to read.
@@ -1228,6 +1292,10 @@ void Guest::Load(Loader &ldr)
 	this->Person::Load(ldr);
 
 	this->activity = static_cast<GuestActivity>(ldr.GetByte());
+	if (this->activity >= GA_COUNT) {
+		ldr.SetFailMessage("Incorrect guest activity.");
+		this->activity = GA_WANDER;
+	}
 	this->happiness = ldr.GetWord();
 	this->total_happiness = ldr.GetWord();
 	this->cash = static_cast<Money>(ldr.GetLongLong());
@@ -1285,10 +1353,10 @@ void Guest::Save(Saver &svr)
 	svr.PutByte(this->nausea);
 }
 
-AnimateResult Guest::OnAnimate(int delay)
+AnimatePrepareResult Guest::PrepareAnimate(int delay)
 {
-	if (this->activity == GA_ON_RIDE) return OAR_OK; // Guest is not animated while on ride.
-	return this->Person::OnAnimate(delay);
+	if (this->activity == GA_ON_RIDE) return APR_DONE; // Guest is not animated while on ride.
+	return this->Person::PrepareAnimate(delay);
 }
 
 AnimateResult Guest::EdgeOfWorldOnAnimate()
@@ -1308,11 +1376,11 @@ AnimateResult Guest::VisitRideOnAnimate(RideInstance *ri, TileEdge exit_edge)
 {
 	if (ri->CanBeVisited(this->vox_pos, exit_edge) && this->SelectItem(ri) != ITP_NOTHING) {
 		/* All lights are green, let's try to enter the ride. */
-		this->activity = GA_ON_RIDE;
+		this->SetActivity(GA_ON_RIDE);
 		this->ride = ri;
 		const RideEntryResult rer = ri->EnterRide(this->id, this->vox_pos, exit_edge);
 		if (rer == RER_WAIT) {
-			this->activity = GA_QUEUING;
+			this->SetActivity(GA_QUEUING);
 			return OAR_HALT;
 		}
 		if (rer != RER_REFUSED) {
@@ -1323,7 +1391,7 @@ AnimateResult Guest::VisitRideOnAnimate(RideInstance *ri, TileEdge exit_edge)
 
 		/* Could not enter, find another ride. */
 		this->ride = nullptr;
-		this->activity = GA_WANDER;
+		this->SetActivity(GA_WANDER);
 	}
 	return OAR_CONTINUE;
 }
@@ -1402,7 +1470,7 @@ bool Guest::DailyUpdate()
 	this->ChangeHappiness(happiness_change);
 
 	if (this->activity == GA_WANDER && this->happiness <= 10) {
-		this->activity = GA_GO_HOME; // Go home when bored.
+		this->SetActivity(GA_GO_HOME); // Go home when bored.
 		NotifyChange(WC_BOTTOM_TOOLBAR, ALL_WINDOWS_OF_TYPE, CHG_GUEST_COUNT, 0);
 	}
 	return true;
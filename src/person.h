@@ -79,6 +79,16 @@ enum AnimateResult {
 	OAR_DEACTIVATE, ///< Person is already removed from the person-list, only de-activate.
 };
 
+/**
+ * Exit codes of the Person::PrepareAnimate call.
+ * Preparing only changes the person itself, the remaining work is done by the caller.
+ */
+enum AnimatePrepareResult {
+	APR_DONE,  ///< Nothing more to do.
+	APR_MOVED, ///< The person moved inside its voxel, the voxel should be marked dirty.
+	APR_STEP,  ///< The animation should be completed with Person::AnimateStep.
+};
+
 /** Desire to visit a ride. */
 enum RideVisitDesire {
 	RVD_NO_RIDE,    ///< There is no ride here (used to distinguish between paths and rides).
@@ -100,7 +110,9 @@ public:
 
 	const ImageData *GetSprite(const SpriteStorage *sprites, ViewOrientation orient, const Recolouring **recolour) const override;
 
-	virtual AnimateResult OnAnimate(int delay);
+	AnimateResult OnAnimate(int delay);
+	virtual AnimatePrepareResult PrepareAnimate(int delay);
+	AnimateResult AnimateStep(int delay);
 	virtual bool DailyUpdate() = 0;
 
 	virtual void Activate(const Point16 &start, PersonType person_type);
@@ -151,6 +163,9 @@ protected:
 	TileEdge GetCurrentEdge() const;
 	uint8 GetInparkDirections();
 
+	bool ComputeFrameMove(XYZPoint16 *new_pix_pos) const;
+	void NextFrame(const XYZPoint16 &new_pix_pos);
+
 	virtual void DecideMoveDirection() = 0;
 	void StartAnimation(const WalkInformation *walk);
 
@@ -166,6 +181,8 @@ enum GuestActivity {
 	GA_QUEUING,    ///< Guest is queuing for a ride.
 	GA_ON_RIDE,    ///< Guest is on the ride.
 	GA_GO_HOME,    ///< Find a way to home.
+
+	GA_COUNT,      ///< Number of guest activities.
 };
 
 /** %Guests walking around in the world. */
@@ -190,7 +207,7 @@ public:
 		return this->activity != GA_ENTER_PARK && this->activity != GA_GO_HOME;
 	}
 
-	AnimateResult OnAnimate(int delay) override;
+	AnimatePrepareResult PrepareAnimate(int delay) override;
 	bool DailyUpdate() override;
 
 	void ChangeHappiness(int16 amount);
@@ -198,8 +215,9 @@ public:
 	void BuyItem(RideInstance *ri);
 	void NotifyRideDeletion(const RideInstance *ri);
 	void ExitRide(RideInstance *ri, TileEdge entry);
+	void SetActivity(GuestActivity new_activity);
 
-	GuestActivity activity; ///< Activity being done by the guest currently.
+	GuestActivity activity; ///< Activity being done by the guest currently. Use #SetActivity to change the activity of an active guest.
 	int16 happiness;        ///< Happiness of the guest (values are 0-100). Use #ChangeHappiness to change the guest happiness.
 	uint16 total_happiness; ///< Sum of all good experiences (for evaluating the day after getting home, values are 0-1000).
 	Money cash;             ///< Amount of money carried by the guest (should be non-negative).
@@ -221,6 +239,11 @@ public:
 	uint8 waste;         ///< Amount of food/drink waste that should be disposed.
 	uint8 nausea;        ///< Amount of nausea of the guest.
 
+	/* Queuing guests at the same voxel stack (see Guests::GetQueuingGuests). */
+	Guest *prev_queuing; ///< Previous queuing guest at the voxel stack, or \c nullptr.
+	Guest *next_queuing; ///< Next queuing guest at the voxel stack, or \c nullptr.
+	int32 queue_stack;   ///< Index of the voxel stack where the guest is listed as queuing, \c -1 if not listed.
+
 protected:
 	void DecideMoveDirection() override;
 	RideVisitDesire ComputeExitDesire(TileEdge current_edge, XYZPoint16 cur_pos, TileEdge exit_edge, bool *seen_wanted_ride);
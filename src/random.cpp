@@ -9,7 +9,6 @@
 
 #include "stdafx.h"
 #include "random.h"
-#include <time.h>
 #include <cmath>
 
 uint32 Random::seed = 0;
@@ -74,14 +73,19 @@ uint16 Random::Uniform(uint16 incl_upper)
  */
 uint32 Random::DrawNumber()
 {
-	if (seed == 0) {
-		seed = time(nullptr);
-	}
-
 	seed = 1664525UL * seed + 1013904223UL;
 	return seed;
 }
 
+/**
+ * Seed the random generators.
+ * @param new_seed Master seed of the game.
+ */
+void Random::SetSeed(uint32 new_seed)
+{
+	Random::seed = new_seed;
+}
+
 /**
  * Load random number for the game.
  * @param ldr Source of the data.
@@ -10,7 +10,12 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
-/** A random generator class. */
+/**
+ * A random generator class.
+ * All generators draw from a single shared stream, which is seeded with the master seed of the game at the start of a new game
+ * (see #Random::SetSeed), and stored in the savegame. As long as the numbers are drawn in the same order, a game therefore
+ * always plays the same.
+ */
 class Random {
 public:
 	bool Success1024(uint upper);
@@ -18,6 +23,8 @@ public:
 	uint16 Uniform(uint16 incl_upper);
 	uint16 Exponential(uint16 mean);
 
+	static void SetSeed(uint32 new_seed);
+
 	static void Load(Loader &ldr);
 	static void Save(Saver &svr);
 
@@ -11,6 +11,8 @@
 #include "rcdfile.h"
 #include "fileio.h"
 #include "string_func.h"
+#include "worker_pool.h"
+#include <vector>
 
 RcdFileCollection _rcd_collection; ///< Available RCD files.
 
@@ -75,11 +77,15 @@ static const char *_rcd_paths[] = {
 	nullptr,
 };
 
-/** Scan directories, looking for RCD files to add. */
+/**
+ * Scan directories, looking for RCD files to add.
+ * The files are scanned concurrently on the worker threads, and added in the order of finding them.
+ */
 void RcdFileCollection::ScanDirectories()
 {
 	DirectoryReader *reader = MakeDirectoryReader();
 
+	std::vector<RcdFileInfo> found; // Found files, their uri and build are filled in by scanning them.
 	const char **rcd_path = _rcd_paths;
 	while (*rcd_path != nullptr) {
 		reader->OpenPath(*rcd_path);
@@ -87,12 +93,18 @@ void RcdFileCollection::ScanDirectories()
 			const char *fname = reader->NextFile();
 			if (fname == nullptr) break;
 			if (!StrEndsWith(fname, ".rcd", false)) continue;
-			this->ScanFileForMetaInfo(fname);
+			found.emplace_back(fname, "", "");
 		}
 		reader->ClosePath();
 		rcd_path++;
 	}
 	delete reader;
+
+	std::vector<const char *> errors(found.size());
+	_worker_pool.Run(found.size(), [&found, &errors](uint i) { errors[i] = ScanFileForMetaInfo(&found[i]); });
+	for (uint i = 0; i < found.size(); i++) {
+		if (errors[i] == nullptr) this->AddFile(found[i]);
+	}
 }
 
 /**
@@ -130,13 +142,13 @@ static std::string GetString(RcdFileReader &rcd_file, uint max_bytes, uint32 *re
 }
 
 /**
- * Scan a file for Rcd meta-data, and add it to the collection if all is well.
- * @param fname Filename of the file to scan.
+ * Scan a file for Rcd meta-data.
+ * @param rfi Information of the file. The path must be set, the uri and the build are filled in if all is well.
  * @return Error message, or \c nullptr if no error found.
  */
-const char *RcdFileCollection::ScanFileForMetaInfo(const char *fname)
+const char *RcdFileCollection::ScanFileForMetaInfo(RcdFileInfo *rfi)
 {
-	RcdFileReader rcd_file(fname);
+	RcdFileReader rcd_file(rfi->path.c_str());
 	if (!rcd_file.CheckFileHeader("RCDF", 2)) return "Wrong header";
 
 	/* Load block. */
@@ -155,7 +167,7 @@ const char *RcdFileCollection::ScanFileForMetaInfo(const char *fname)
 	std::string description = GetString(rcd_file, 512, &remaining);
 	if (remaining != 0) return "Error while reading INFO text.";
 
-	RcdFileInfo rfi(fname, uri, build);
-	this->AddFile(rfi);
+	rfi->uri = uri;
+	rfi->build = build;
 	return nullptr; // Success.
 }
@@ -35,7 +35,7 @@ public:
 	std::map<std::string, RcdFileInfo> rcdfiles; ///< Found unique RCD files, mapping of uri to the Rcd file information.
 
 private:
-	const char *ScanFileForMetaInfo(const char *fname);
+	static const char *ScanFileForMetaInfo(RcdFileInfo *rfi);
 };
 
 extern RcdFileCollection _rcd_collection;
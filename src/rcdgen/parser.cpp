@@ -0,0 +1,1707 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 8 "/root/repo/src/rcdgen/parser.y"
+
+#include <cstdio>
+#include "scanner_funcs.h"
+#include "ast.h"
+#include "utils.h"
+
+std::shared_ptr<NamedValueList> _parsed_data = nullptr; // Documentation is in scanner_funcs.h, since this file is not being scanned.
+
+#line 80 "/root/repo/src/rcdgen/parser.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "tokens.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_PAR_OPEN = 3,                   /* PAR_OPEN  */
+  YYSYMBOL_PAR_CLOSE = 4,                  /* PAR_CLOSE  */
+  YYSYMBOL_CURLY_OPEN = 5,                 /* CURLY_OPEN  */
+  YYSYMBOL_CURLY_CLOSE = 6,                /* CURLY_CLOSE  */
+  YYSYMBOL_COLON = 7,                      /* COLON  */
+  YYSYMBOL_SEMICOLON = 8,                  /* SEMICOLON  */
+  YYSYMBOL_COMMA = 9,                      /* COMMA  */
+  YYSYMBOL_MINUS = 10,                     /* MINUS  */
+  YYSYMBOL_BITSET_KW = 11,                 /* BITSET_KW  */
+  YYSYMBOL_IMPORT_KW = 12,                 /* IMPORT_KW  */
+  YYSYMBOL_AND = 13,                       /* AND  */
+  YYSYMBOL_PIPE = 14,                      /* PIPE  */
+  YYSYMBOL_XOR = 15,                       /* XOR  */
+  YYSYMBOL_SHL = 16,                       /* SHL  */
+  YYSYMBOL_SHR = 17,                       /* SHR  */
+  YYSYMBOL_ADD = 18,                       /* ADD  */
+  YYSYMBOL_MUL = 19,                       /* MUL  */
+  YYSYMBOL_DIV = 20,                       /* DIV  */
+  YYSYMBOL_MOD = 21,                       /* MOD  */
+  YYSYMBOL_NEG = 22,                       /* NEG  */
+  YYSYMBOL_STRING = 23,                    /* STRING  */
+  YYSYMBOL_NUMBER = 24,                    /* NUMBER  */
+  YYSYMBOL_IDENTIFIER = 25,                /* IDENTIFIER  */
+  YYSYMBOL_YYACCEPT = 26,                  /* $accept  */
+  YYSYMBOL_Program = 27,                   /* Program  */
+  YYSYMBOL_ExpressionList = 28,            /* ExpressionList  */
+  YYSYMBOL_Expression = 29,                /* Expression  */
+  YYSYMBOL_ShiftTerm = 30,                 /* ShiftTerm  */
+  YYSYMBOL_AddTerm = 31,                   /* AddTerm  */
+  YYSYMBOL_MulTerm = 32,                   /* MulTerm  */
+  YYSYMBOL_Term = 33,                      /* Term  */
+  YYSYMBOL_Factor = 34,                    /* Factor  */
+  YYSYMBOL_NamedValueList = 35,            /* NamedValueList  */
+  YYSYMBOL_NamedValue = 36,                /* NamedValue  */
+  YYSYMBOL_IdentifierTable = 37,           /* IdentifierTable  */
+  YYSYMBOL_IdentifierRows = 38,            /* IdentifierRows  */
+  YYSYMBOL_IdentifierRow = 39,             /* IdentifierRow  */
+  YYSYMBOL_Group = 40                      /* Group  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   97
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  26
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  15
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  41
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  80
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   280
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,    35,    35,    40,    45,    51,    56,    62,    68,    75,
+      80,    86,    93,    98,   104,   111,   116,   122,   128,   135,
+     140,   146,   153,   159,   165,   172,   178,   184,   189,   194,
+     200,   205,   213,   222,   227,   233,   238,   244,   250,   258,
+     266,   273
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "PAR_OPEN",
+  "PAR_CLOSE", "CURLY_OPEN", "CURLY_CLOSE", "COLON", "SEMICOLON", "COMMA",
+  "MINUS", "BITSET_KW", "IMPORT_KW", "AND", "PIPE", "XOR", "SHL", "SHR",
+  "ADD", "MUL", "DIV", "MOD", "NEG", "STRING", "NUMBER", "IDENTIFIER",
+  "$accept", "Program", "ExpressionList", "Expression", "ShiftTerm",
+  "AddTerm", "MulTerm", "Term", "Factor", "NamedValueList", "NamedValue",
+  "IdentifierTable", "IdentifierRows", "IdentifierRow", "Group", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-16)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+     -16,     5,    18,   -16,   -12,    16,    67,   -16,    41,   -16,
+     -16,     2,    46,    37,     4,   -16,     9,    69,   -16,   -12,
+      70,   -16,     4,    33,    90,    33,   -16,   -16,   -16,    45,
+      62,     1,    -9,    59,   -16,   -16,    34,    68,    53,   -16,
+      68,   -16,    46,   -16,    38,   -16,     0,   -16,    57,     4,
+       4,     4,     4,     4,     4,     4,     4,     4,     4,     4,
+     -16,   -16,   -16,   -16,    60,   -16,    62,     1,     1,     1,
+      -9,    -9,    59,    59,   -16,   -16,   -16,   -16,    35,   -16
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+      28,     0,     2,     1,     0,     0,     0,    29,     0,    30,
+      38,     0,    36,     0,     0,    28,     0,     0,    35,     0,
+       0,    34,     0,     0,     0,     0,    22,    23,    24,     0,
+       3,     5,     9,    12,    15,    19,     0,    24,     0,    31,
+       0,    33,    37,    39,     0,    20,     0,    21,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      40,    32,    27,    25,     0,    28,     4,     6,     7,     8,
+      10,    11,    14,    13,    16,    17,    18,    26,     0,    41
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -16,   -16,    50,   -14,    31,    36,    32,    27,    40,   -15,
+     -16,   -16,   -16,    78,    75
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,    29,    30,    31,    32,    33,    34,    35,     2,
+       7,     8,    11,    12,     9
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      36,    55,    38,    22,    63,     3,    18,    22,    44,    56,
+      23,    24,    22,    10,    23,    24,    19,    53,    54,    23,
+      24,     4,    25,    26,    27,    28,    25,    26,    27,    28,
+       5,    25,    26,    27,    37,    66,    22,     4,     4,    13,
+      60,    79,    62,     6,    24,    21,     5,     5,    17,    48,
+      78,    50,    51,    52,    49,    20,    26,    27,    28,     6,
+       6,    61,    65,    45,    77,    47,    50,    51,    52,    49,
+      14,    14,    15,    15,    16,    50,    51,    52,    57,    58,
+      59,    67,    68,    69,    74,    75,    76,    72,    73,    70,
+      71,    39,    41,    46,    40,    43,    64,    42
+};
+
+static const yytype_int8 yycheck[] =
+{
+      15,    10,    16,     3,     4,     0,     4,     3,    22,    18,
+      10,    11,     3,    25,    10,    11,    14,    16,    17,    10,
+      11,     3,    22,    23,    24,    25,    22,    23,    24,    25,
+      12,    22,    23,    24,    25,    49,     3,     3,     3,    23,
+       6,     6,     4,    25,    11,     8,    12,    12,     7,     4,
+      65,    13,    14,    15,     9,     9,    23,    24,    25,    25,
+      25,     8,     5,    23,     4,    25,    13,    14,    15,     9,
+       3,     3,     5,     5,     7,    13,    14,    15,    19,    20,
+      21,    50,    51,    52,    57,    58,    59,    55,    56,    53,
+      54,    16,    17,     3,    25,    25,    46,    19
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    27,    35,     0,     3,    12,    25,    36,    37,    40,
+      25,    38,    39,    23,     3,     5,     7,     7,     4,    14,
+       9,     8,     3,    10,    11,    22,    23,    24,    25,    28,
+      29,    30,    31,    32,    33,    34,    35,    25,    29,    40,
+      25,    40,    39,    25,    29,    34,     3,    34,     4,     9,
+      13,    14,    15,    16,    17,    10,    18,    19,    20,    21,
+       6,     8,     4,     4,    28,     5,    29,    30,    30,    30,
+      31,    31,    32,    32,    33,    33,    33,     4,    35,     6
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    26,    27,    28,    28,    29,    29,    29,    29,    30,
+      30,    30,    31,    31,    31,    32,    32,    32,    32,    33,
+      33,    33,    34,    34,    34,    34,    34,    34,    35,    35,
+      36,    36,    36,    36,    36,    37,    38,    38,    39,    39,
+      40,    40
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     1,     3,     1,     3,     3,     3,     1,
+       3,     3,     1,     3,     3,     1,     3,     3,     3,     1,
+       2,     2,     1,     1,     1,     3,     4,     3,     0,     2,
+       1,     3,     4,     3,     3,     3,     1,     3,     1,     3,
+       4,     7
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* Program: NamedValueList  */
+#line 35 "/root/repo/src/rcdgen/parser.y"
+                         {
+	_parsed_data = (yyvsp[0].values);
+}
+#line 1156 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 3: /* ExpressionList: Expression  */
+#line 40 "/root/repo/src/rcdgen/parser.y"
+                            {
+	(yyval.exprlist) = std::make_shared<ExpressionList>();
+	(yyval.exprlist)->exprs.push_back((yyvsp[0].expr));
+}
+#line 1165 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 4: /* ExpressionList: ExpressionList COMMA Expression  */
+#line 45 "/root/repo/src/rcdgen/parser.y"
+                                                 {
+	(yyval.exprlist) = (yyvsp[-2].exprlist);
+	(yyval.exprlist)->exprs.push_back((yyvsp[0].expr));
+}
+#line 1174 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 5: /* Expression: ShiftTerm  */
+#line 51 "/root/repo/src/rcdgen/parser.y"
+                       {
+	(yyval.expr) = (yyvsp[0].expr);
+}
+#line 1182 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 6: /* Expression: Expression AND ShiftTerm  */
+#line 56 "/root/repo/src/rcdgen/parser.y"
+                                      {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '&', (yyvsp[0].expr));
+}
+#line 1191 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 7: /* Expression: Expression PIPE ShiftTerm  */
+#line 62 "/root/repo/src/rcdgen/parser.y"
+                                       {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '|', (yyvsp[0].expr));
+}
+#line 1200 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 8: /* Expression: Expression XOR ShiftTerm  */
+#line 68 "/root/repo/src/rcdgen/parser.y"
+                                      {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '^', (yyvsp[0].expr));
+}
+#line 1209 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 9: /* ShiftTerm: AddTerm  */
+#line 75 "/root/repo/src/rcdgen/parser.y"
+                    {
+	(yyval.expr) = (yyvsp[0].expr);
+}
+#line 1217 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 10: /* ShiftTerm: ShiftTerm SHL AddTerm  */
+#line 80 "/root/repo/src/rcdgen/parser.y"
+                                  {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '<', (yyvsp[0].expr));
+}
+#line 1226 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 11: /* ShiftTerm: ShiftTerm SHR AddTerm  */
+#line 86 "/root/repo/src/rcdgen/parser.y"
+                                  {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '>', (yyvsp[0].expr));
+}
+#line 1235 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 12: /* AddTerm: MulTerm  */
+#line 93 "/root/repo/src/rcdgen/parser.y"
+                  {
+	(yyval.expr) = (yyvsp[0].expr);
+}
+#line 1243 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 13: /* AddTerm: AddTerm ADD MulTerm  */
+#line 98 "/root/repo/src/rcdgen/parser.y"
+                              {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '+', (yyvsp[0].expr));
+}
+#line 1252 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 14: /* AddTerm: AddTerm MINUS MulTerm  */
+#line 104 "/root/repo/src/rcdgen/parser.y"
+                                {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '-', (yyvsp[0].expr));
+}
+#line 1261 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 15: /* MulTerm: Term  */
+#line 111 "/root/repo/src/rcdgen/parser.y"
+               {
+	(yyval.expr) = (yyvsp[0].expr);
+}
+#line 1269 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 16: /* MulTerm: MulTerm MUL Term  */
+#line 116 "/root/repo/src/rcdgen/parser.y"
+                           {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '*', (yyvsp[0].expr));
+}
+#line 1278 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 17: /* MulTerm: MulTerm DIV Term  */
+#line 122 "/root/repo/src/rcdgen/parser.y"
+                           {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '/', (yyvsp[0].expr));
+}
+#line 1287 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 18: /* MulTerm: MulTerm MOD Term  */
+#line 128 "/root/repo/src/rcdgen/parser.y"
+                           {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<BinaryOperator>(pos, (yyvsp[-2].expr), '%', (yyvsp[0].expr));
+}
+#line 1296 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 19: /* Term: Factor  */
+#line 135 "/root/repo/src/rcdgen/parser.y"
+              {
+	(yyval.expr) = (yyvsp[0].expr);
+}
+#line 1304 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 20: /* Term: MINUS Factor  */
+#line 140 "/root/repo/src/rcdgen/parser.y"
+                    {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<UnaryOperator>(pos, '-', (yyvsp[0].expr));
+}
+#line 1313 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 21: /* Term: NEG Factor  */
+#line 146 "/root/repo/src/rcdgen/parser.y"
+                  {
+	Position pos(filename, (yyvsp[-1].line));
+	(yyval.expr) = std::make_shared<UnaryOperator>(pos, '~', (yyvsp[0].expr));
+}
+#line 1322 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 22: /* Factor: STRING  */
+#line 153 "/root/repo/src/rcdgen/parser.y"
+                {
+	Position pos(filename, (yyvsp[0].chars).line);
+	(yyval.expr) = std::make_shared<StringLiteral>(pos, (yyvsp[0].chars).value);
+}
+#line 1331 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 23: /* Factor: NUMBER  */
+#line 159 "/root/repo/src/rcdgen/parser.y"
+                {
+	Position pos(filename, (yyvsp[0].number).line);
+	(yyval.expr) = std::make_shared<NumberLiteral>(pos, (yyvsp[0].number).value);
+}
+#line 1340 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 24: /* Factor: IDENTIFIER  */
+#line 165 "/root/repo/src/rcdgen/parser.y"
+                    {
+	Position pos(filename, (yyvsp[0].chars).line);
+	CheckIsSingleName((yyvsp[0].chars).value, pos);
+	(yyval.expr) = std::make_shared<IdentifierLiteral>(pos, (yyvsp[0].chars).value);
+}
+#line 1350 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 25: /* Factor: BITSET_KW PAR_OPEN PAR_CLOSE  */
+#line 172 "/root/repo/src/rcdgen/parser.y"
+                                      {
+	Position pos(filename, (yyvsp[-2].line));
+	(yyval.expr) = std::make_shared<BitSet>(pos, nullptr);
+}
+#line 1359 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 26: /* Factor: BITSET_KW PAR_OPEN ExpressionList PAR_CLOSE  */
+#line 178 "/root/repo/src/rcdgen/parser.y"
+                                                     {
+	Position pos(filename, (yyvsp[-3].line));
+	(yyval.expr) = std::make_shared<BitSet>(pos, (yyvsp[-1].exprlist));
+}
+#line 1368 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 27: /* Factor: PAR_OPEN Expression PAR_CLOSE  */
+#line 184 "/root/repo/src/rcdgen/parser.y"
+                                       {
+	(yyval.expr) = (yyvsp[-1].expr);
+}
+#line 1376 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 28: /* NamedValueList: %empty  */
+#line 189 "/root/repo/src/rcdgen/parser.y"
+                             {
+	(yyval.values) = std::make_shared<NamedValueList>();
+}
+#line 1384 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 29: /* NamedValueList: NamedValueList NamedValue  */
+#line 194 "/root/repo/src/rcdgen/parser.y"
+                                           {
+	(yyval.values) = (yyvsp[-1].values);
+	(yyval.values)->values.push_back((yyvsp[0].value));
+}
+#line 1393 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 30: /* NamedValue: Group  */
+#line 200 "/root/repo/src/rcdgen/parser.y"
+                   {
+	(yyval.value) = std::make_shared<NamedValue>(nullptr, (yyvsp[0].group));
+}
+#line 1401 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 31: /* NamedValue: IDENTIFIER COLON Group  */
+#line 205 "/root/repo/src/rcdgen/parser.y"
+                                    {
+	Position pos(filename, (yyvsp[-2].chars).line);
+	CheckIsSingleName((yyvsp[-2].chars).value, pos);
+	std::shared_ptr<Name> name = std::make_shared<SingleName>(pos, (yyvsp[-2].chars).value);
+	(yyval.value) = std::make_shared<NamedValue>(name, (yyvsp[0].group));
+}
+#line 1412 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 32: /* NamedValue: IDENTIFIER COLON Expression SEMICOLON  */
+#line 213 "/root/repo/src/rcdgen/parser.y"
+                                                   {
+	Position pos(filename, (yyvsp[-3].chars).line);
+	CheckIsSingleName((yyvsp[-3].chars).value, pos);
+	std::shared_ptr<Name> name = std::make_shared<SingleName>(pos, (yyvsp[-3].chars).value);
+	std::shared_ptr<Group> group = std::make_shared<ExpressionGroup>((yyvsp[-1].expr));
+	(yyval.value) = std::make_shared<NamedValue>(name, group);
+}
+#line 1424 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 33: /* NamedValue: IdentifierTable COLON Group  */
+#line 222 "/root/repo/src/rcdgen/parser.y"
+                                         {
+	(yyval.value) = std::make_shared<NamedValue>((yyvsp[-2].iden_table), (yyvsp[0].group));
+}
+#line 1432 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 34: /* NamedValue: IMPORT_KW STRING SEMICOLON  */
+#line 227 "/root/repo/src/rcdgen/parser.y"
+                                        {
+	Position pos(filename, (yyvsp[-2].line));
+	(yyval.value) = std::make_shared<ImportValue>(pos, (yyvsp[-1].chars).value);
+}
+#line 1441 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 35: /* IdentifierTable: PAR_OPEN IdentifierRows PAR_CLOSE  */
+#line 233 "/root/repo/src/rcdgen/parser.y"
+                                                    {
+	(yyval.iden_table) = (yyvsp[-1].iden_table);
+}
+#line 1449 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 36: /* IdentifierRows: IdentifierRow  */
+#line 238 "/root/repo/src/rcdgen/parser.y"
+                               {
+	(yyval.iden_table) = std::make_shared<NameTable>();
+	(yyval.iden_table)->rows.push_back((yyvsp[0].iden_row));
+}
+#line 1458 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 37: /* IdentifierRows: IdentifierRows PIPE IdentifierRow  */
+#line 244 "/root/repo/src/rcdgen/parser.y"
+                                                   {
+	(yyval.iden_table) = (yyvsp[-2].iden_table);
+	(yyval.iden_table)->rows.push_back((yyvsp[0].iden_row));
+}
+#line 1467 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 38: /* IdentifierRow: IDENTIFIER  */
+#line 250 "/root/repo/src/rcdgen/parser.y"
+                           {
+	(yyval.iden_row) = std::make_shared<NameRow>();
+	Position pos(filename, (yyvsp[0].chars).line);
+	std::shared_ptr<IdentifierLine> il = std::make_shared<IdentifierLine>(pos, (yyvsp[0].chars).value);
+	(yyval.iden_row)->identifiers.push_back(il);
+}
+#line 1478 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 39: /* IdentifierRow: IdentifierRow COMMA IDENTIFIER  */
+#line 258 "/root/repo/src/rcdgen/parser.y"
+                                               {
+	(yyval.iden_row) = (yyvsp[-2].iden_row);
+	Position pos(filename, (yyvsp[0].chars).line);
+	std::shared_ptr<IdentifierLine> il = std::make_shared<IdentifierLine>(pos, (yyvsp[0].chars).value);
+	(yyval.iden_row)->identifiers.push_back(il);
+}
+#line 1489 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 40: /* Group: IDENTIFIER CURLY_OPEN NamedValueList CURLY_CLOSE  */
+#line 266 "/root/repo/src/rcdgen/parser.y"
+                                                         {
+	Position pos(filename, (yyvsp[-3].chars).line);
+	CheckIsSingleName((yyvsp[-3].chars).value, pos);
+	(yyval.group) = std::make_shared<NodeGroup>(pos, (yyvsp[-3].chars).value, nullptr, (yyvsp[-1].values));
+}
+#line 1499 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+  case 41: /* Group: IDENTIFIER PAR_OPEN ExpressionList PAR_CLOSE CURLY_OPEN NamedValueList CURLY_CLOSE  */
+#line 273 "/root/repo/src/rcdgen/parser.y"
+                                                                                           {
+	Position pos(filename, (yyvsp[-6].chars).line);
+	CheckIsSingleName((yyvsp[-6].chars).value, pos);
+	(yyval.group) = std::make_shared<NodeGroup>(pos, (yyvsp[-6].chars).value, (yyvsp[-4].exprlist), (yyvsp[-1].values));
+}
+#line 1509 "/root/repo/src/rcdgen/parser.cpp"
+    break;
+
+
+#line 1513 "/root/repo/src/rcdgen/parser.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 280 "/root/repo/src/rcdgen/parser.y"
+
+
@@ -51,6 +51,7 @@ static const char *_gui_string_names[] = {
 	"TOOLBAR_GUI_DROPDOWN_SPEED_2",
 	"TOOLBAR_GUI_DROPDOWN_SPEED_4",
 	"TOOLBAR_GUI_DROPDOWN_SPEED_8",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_TURBO",
 	/* …and here. */
 	"TOOLBAR_GUI_GAME_MODE_EDITOR",
 	"TOOLBAR_GUI_GAME_MODE_PLAY",
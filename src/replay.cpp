@@ -0,0 +1,445 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file replay.cpp Recording and replaying the player commands of a game. */
+
+#include "stdafx.h"
+#include "replay.h"
+#include "map.h"
+#include "path.h"
+#include "path_build.h"
+#include "mouse_mode.h"
+#include "terraform.h"
+#include "loadsave.h"
+#include "gamecontrol.h"
+#include "window.h"
+#include "gentle_thrill_ride_type.h"
+
+Replay _replay; ///< Replay of the current game.
+
+static const char *REPLAY_HEADER = "freerct-replay 1"; ///< First line of a replay file.
+static const uint MAX_REPORTED_MISMATCHES = 10; ///< Maximal number of days with a different game state to report.
+
+/** Description of a player command in a replay file. */
+struct ReplayCommandInfo {
+	const char *name; ///< Name of the command in the replay file.
+	int arg_count;    ///< Number of arguments of the command.
+};
+
+/** Descriptions of the player commands, indexed by #ReplayCommandType. */
+static const ReplayCommandInfo _replay_commands[RCT_COUNT] = {
+	{"build-flat-path",     4}, // x, y, z, path type.
+	{"build-upward-path",   5}, // x, y, z, edge, path type.
+	{"build-downward-path", 5}, // x, y, z, edge, path type.
+	{"remove-path",         3}, // x, y, z.
+	{"change-path",         4}, // x, y, z, path type.
+	{"terraform-tile",      6}, // x, y, cursor type, levelling, direction, dot mode.
+	{"terraform-area",      6}, // x, y, width, height, levelling, direction.
+	{"create-ride",         2}, // ride number, ride type index.
+	{"place-ride",          5}, // ride number, x, y, z, orientation.
+	{"remove-ride",         1}, // ride number.
+	{"open-ride",           1}, // ride number.
+	{"close-ride",          1}, // ride number.
+	{"place-ride-entrance", 4}, // ride number, x, y, z.
+	{"place-ride-exit",     4}, // ride number, x, y, z.
+	{"set-entrance-type",   2}, // ride number, entrance type index.
+	{"set-exit-type",       2}, // ride number, exit type index.
+	{"build-fence",         5}, // x, y, z, edge, fence type.
+	{"set-game-mode",       1}, // game mode.
+};
+
+/**
+ * Check whether an argument of a player command is a valid enum value.
+ * @param arg Value of the argument.
+ * @param count Number of valid values of the enum.
+ * @return Whether the argument is in the range of the enum.
+ */
+static inline bool IsValidEnumArg(int32 arg, int count)
+{
+	return arg >= 0 && arg < count;
+}
+
+/**
+ * Get the ride of a player command.
+ * @param number Ride number argument of the command.
+ * @param placed Whether the ride should be placed in the world already.
+ * @return The ride, or \c nullptr if no such ride exists.
+ */
+static RideInstance *GetCommandRide(int32 number, bool placed)
+{
+	if (number < SRI_FULL_RIDES || number >= SRI_LAST) return nullptr;
+	RideInstance *ri = _rides_manager.GetRideInstance(number);
+	if (ri == nullptr || (ri->state != RIS_ALLOCATED) != placed) return nullptr;
+	return ri;
+}
+
+/**
+ * Is the ride kind a fixed ride, one that is placed in the world as a whole?
+ * @param kind Kind of the ride.
+ * @return Whether the ride is a shop, a gentle ride, or a thrill ride.
+ */
+static inline bool IsFixedRideKind(RideTypeKind kind)
+{
+	return kind == RTK_SHOP || kind == RTK_GENTLE || kind == RTK_THRILL;
+}
+
+/**
+ * Perform the #RCT_CREATE_RIDE command.
+ * @param args Arguments of the command.
+ */
+static void CreateRide(const int32 *args)
+{
+	if (args[0] < SRI_FULL_RIDES || args[0] >= SRI_LAST || _rides_manager.GetRideInstance(args[0]) != nullptr) return;
+	const RideType *ride_type = (args[1] >= 0) ? _rides_manager.GetRideType(args[1]) : nullptr;
+	if (ride_type == nullptr || !IsFixedRideKind(ride_type->kind) || !ride_type->CanMakeInstance()) return;
+
+	_rides_manager.CreateInstance(ride_type, args[0]);
+}
+
+/**
+ * Perform the #RCT_PLACE_RIDE command, like #RideBuildWindow::SelectorMouseButtonEvent.
+ * @param args Arguments of the command.
+ */
+static void PlaceRide(const int32 *args)
+{
+	RideInstance *ri = GetCommandRide(args[0], false);
+	if (ri == nullptr || !IsFixedRideKind(ri->GetKind()) || !IsValidEnumArg(args[4], 4)) return;
+
+	FixedRideInstance *si = static_cast<FixedRideInstance *>(ri);
+	const FixedRideType *type = si->GetFixedRideType();
+	const XYZPoint16 vox_pos(args[1], args[2], args[3]);
+	for (int8 x = 0; x < type->width_x; x++) {
+		for (int8 y = 0; y < type->width_y; y++) {
+			const XYZPoint16 location = vox_pos + type->OrientatedOffset(args[4], x, y);
+			if (!IsVoxelInsideWorld(location) || _world.GetTileOwner(location.x, location.y) != OWN_PARK) return;
+		}
+	}
+
+	si->SetRide(args[4], vox_pos);
+	_rides_manager.NewInstanceAdded(si->GetIndex());
+	AddRemovePathEdges(si->vox_pos, PATH_EMPTY, si->GetEntranceDirections(si->vox_pos), PAS_QUEUE_PATH);
+}
+
+/**
+ * Perform the #RCT_REMOVE_RIDE command.
+ * @param args Arguments of the command.
+ */
+static void RemoveRide(const int32 *args)
+{
+	if (args[0] < SRI_FULL_RIDES || args[0] >= SRI_LAST) return;
+	RideInstance *ri = _rides_manager.GetRideInstance(args[0]);
+	if (ri == nullptr) return;
+
+	switch (ri->GetKind()) {
+		case RTK_SHOP:
+			delete GetWindowByType(WC_SHOP_MANAGER, args[0]);
+			break;
+		case RTK_GENTLE:
+		case RTK_THRILL:
+			delete GetWindowByType(WC_GENTLE_THRILL_RIDE_MANAGER, args[0]);
+			break;
+		default:
+			break;
+	}
+	_rides_manager.DeleteInstance(args[0]);
+}
+
+/**
+ * Perform the #RCT_PLACE_RIDE_ENTRANCE or #RCT_PLACE_RIDE_EXIT command.
+ * @param args Arguments of the command.
+ * @param entrance Whether to place the entrance rather than the exit.
+ */
+static void PlaceRideEntranceExit(const int32 *args, bool entrance)
+{
+	RideInstance *ri = GetCommandRide(args[0], true);
+	const XYZPoint16 pos(args[1], args[2], args[3]);
+	if (ri == nullptr || (ri->GetKind() != RTK_GENTLE && ri->GetKind() != RTK_THRILL) || !IsVoxelInsideWorld(pos)) return;
+
+	GentleThrillRideInstance *ride = static_cast<GentleThrillRideInstance *>(ri);
+	if (!ride->CanPlaceEntranceOrExit(pos, entrance)) return;
+	if (entrance) {
+		ride->SetEntrancePos(pos);
+	} else {
+		ride->SetExitPos(pos);
+	}
+}
+
+Replay::Replay() : seed(0), tick(0), mismatches(0), record_file(nullptr), replaying(false), next_command(0), next_checksum(0)
+{
+}
+
+Replay::~Replay()
+{
+	this->Stop();
+}
+
+/**
+ * Start recording the player commands of the next new game.
+ * @param fname Name of the file to write the replay to.
+ * @return Whether the file could be opened.
+ */
+bool Replay::StartRecording(const char *fname)
+{
+	this->Stop();
+	this->record_file = fopen(fname, "w");
+	return this->record_file != nullptr;
+}
+
+/**
+ * Load a replay file, to play it in the next new game.
+ * @param fname Name of the replay file.
+ * @return Whether the replay could be loaded.
+ */
+bool Replay::LoadReplay(const char *fname)
+{
+	this->Stop();
+
+	FILE *fp = fopen(fname, "r");
+	if (fp == nullptr) {
+		fprintf(stderr, "Could not open replay \"%s\"\n", fname);
+		return false;
+	}
+
+	char line[256];
+	int line_number = 1;
+	bool ok = fgets(line, lengthof(line), fp) != nullptr && strncmp(line, REPLAY_HEADER, strlen(REPLAY_HEADER)) == 0;
+	bool have_seed = false;
+	while (ok && fgets(line, lengthof(line), fp) != nullptr) {
+		line_number++;
+		char name[64];
+		int offset;
+		ReplayCommand cmd;
+		if (sscanf(line, "seed %u", &this->seed) == 1) {
+			have_seed = true;
+		} else if (sscanf(line, "cmd %u %63s%n", &cmd.tick, name, &offset) == 2) {
+			int type = 0;
+			while (type < RCT_COUNT && strcmp(name, _replay_commands[type].name) != 0) type++;
+			ok = type < RCT_COUNT && (this->commands.empty() || this->commands.back().tick <= cmd.tick);
+			if (!ok) break;
+			cmd.type = static_cast<ReplayCommandType>(type);
+
+			const char *args = line + offset;
+			for (int i = 0; i < REPLAY_MAX_ARGS; i++) {
+				cmd.args[i] = 0;
+				if (i >= _replay_commands[type].arg_count) continue;
+
+				int length;
+				ok = sscanf(args, "%d%n", &cmd.args[i], &length) == 1;
+				if (!ok) break;
+				args += length;
+			}
+			if (ok) this->commands.push_back(cmd);
+		} else {
+			int year, month, day;
+			ReplayChecksum rc;
+			ok = sscanf(line, "day %d-%d-%d %x", &year, &month, &day, &rc.checksum) == 4;
+			rc.date = Date(day, month, year).Compress();
+			if (ok) this->checksums.push_back(rc);
+		}
+	}
+	fclose(fp);
+
+	if (!ok || !have_seed) {
+		fprintf(stderr, "Replay \"%s\" is not valid (line %d)\n", fname, line_number);
+		this->commands.clear();
+		this->checksums.clear();
+		return false;
+	}
+	this->replaying = true;
+	return true;
+}
+
+/** Stop recording or replaying. */
+void Replay::Stop()
+{
+	if (this->record_file != nullptr) {
+		fclose(this->record_file);
+		this->record_file = nullptr;
+	}
+	this->replaying = false;
+	this->commands.clear();
+	this->checksums.clear();
+}
+
+/**
+ * A new game has started.
+ * @param game_seed Master seed of the new game.
+ */
+void Replay::StartGame(uint32 game_seed)
+{
+	this->seed = game_seed;
+	this->tick = 0;
+	this->mismatches = 0;
+	this->next_command = 0;
+	this->next_checksum = 0;
+
+	if (this->record_file != nullptr) {
+		if (ftell(this->record_file) != 0) {
+			fprintf(stderr, "Replay: only the first new game is recorded\n");
+			this->Stop();
+			return;
+		}
+		fprintf(this->record_file, "%s\nseed %u\n", REPLAY_HEADER, this->seed);
+	}
+}
+
+/**
+ * Record a player command, if recording.
+ * @param type Type of the command.
+ * @param args Arguments of the command.
+ */
+void Replay::Record(ReplayCommandType type, std::initializer_list<int32> args)
+{
+	if (this->record_file == nullptr) return;
+
+	assert(static_cast<int>(args.size()) == _replay_commands[type].arg_count);
+	fprintf(this->record_file, "cmd %u %s", this->tick, _replay_commands[type].name);
+	for (int32 arg : args) fprintf(this->record_file, " %d", arg);
+	fprintf(this->record_file, "\n");
+}
+
+/**
+ * A player command that cannot be recorded is performed. Stop recording with an error, since the replay would not reproduce the game.
+ * @param command Description of the command.
+ */
+void Replay::RecordUnsupported(const char *command)
+{
+	if (this->record_file == nullptr) return;
+
+	fprintf(stderr, "Replay: %s cannot be recorded, recording stopped at tick %u\n", command, this->tick);
+	this->Stop();
+}
+
+/**
+ * Perform a player command of the replay.
+ * @param cmd Command to perform.
+ */
+void Replay::ExecuteCommand(const ReplayCommand &cmd)
+{
+	const int32 *args = cmd.args;
+	XYZPoint16 voxel_pos(args[0], args[1], args[2]);
+	switch (cmd.type) {
+		case RCT_BUILD_FLAT_PATH:
+			if (IsValidEnumArg(args[3], PAT_COUNT)) BuildFlatPath(voxel_pos, static_cast<PathType>(args[3]), false);
+			break;
+
+		case RCT_BUILD_UPWARD_PATH:
+			if (IsValidEnumArg(args[3], EDGE_COUNT) && IsValidEnumArg(args[4], PAT_COUNT)) BuildUpwardPath(voxel_pos, static_cast<TileEdge>(args[3]), static_cast<PathType>(args[4]), false);
+			break;
+
+		case RCT_BUILD_DOWNWARD_PATH:
+			if (IsValidEnumArg(args[3], EDGE_COUNT) && IsValidEnumArg(args[4], PAT_COUNT)) BuildDownwardPath(voxel_pos, static_cast<TileEdge>(args[3]), static_cast<PathType>(args[4]), false);
+			break;
+
+		case RCT_REMOVE_PATH:
+			RemovePath(voxel_pos, false);
+			break;
+
+		case RCT_CHANGE_PATH:
+			if (IsVoxelInsideWorld(voxel_pos) && IsValidEnumArg(args[3], PAT_COUNT)) ChangePath(voxel_pos, static_cast<PathType>(args[3]), false);
+			break;
+
+		case RCT_TERRAFORM_TILE:
+			if (IsVoxelstackInsideWorld(args[0], args[1]) && IsValidEnumArg(args[2], CUR_TYPE_TILE + 1)) {
+				ChangeTileCursorMode(Point16(args[0], args[1]), static_cast<CursorType>(args[2]), args[3] != 0, args[4], args[5] != 0);
+			}
+			break;
+
+		case RCT_TERRAFORM_AREA:
+			if (args[2] >= 0 && args[3] >= 0) ChangeAreaCursorMode(Rectangle16(args[0], args[1], args[2], args[3]), args[4] != 0, args[5]);
+			break;
+
+		case RCT_CREATE_RIDE:
+			CreateRide(args);
+			break;
+
+		case RCT_PLACE_RIDE:
+			PlaceRide(args);
+			break;
+
+		case RCT_REMOVE_RIDE:
+			RemoveRide(args);
+			break;
+
+		case RCT_OPEN_RIDE: {
+			RideInstance *ri = GetCommandRide(args[0], true);
+			if (ri != nullptr && ri->state != RIS_OPEN && ri->CanOpenRide()) ri->OpenRide();
+			break;
+		}
+
+		case RCT_CLOSE_RIDE: {
+			RideInstance *ri = GetCommandRide(args[0], true);
+			if (ri != nullptr && ri->state != RIS_CLOSED) ri->CloseRide();
+			break;
+		}
+
+		case RCT_PLACE_RIDE_ENTRANCE:
+		case RCT_PLACE_RIDE_EXIT:
+			PlaceRideEntranceExit(args, cmd.type == RCT_PLACE_RIDE_ENTRANCE);
+			break;
+
+		case RCT_SET_ENTRANCE_TYPE:
+		case RCT_SET_EXIT_TYPE: {
+			RideInstance *ri = GetCommandRide(args[0], true);
+			if (ri == nullptr || !IsValidEnumArg(args[1], MAX_NUMBER_OF_RIDE_ENTRANCES_EXITS)) break;
+			if (cmd.type == RCT_SET_ENTRANCE_TYPE) {
+				if (_rides_manager.entrances[args[1]] != nullptr) ri->SetEntranceType(args[1]);
+			} else {
+				if (_rides_manager.exits[args[1]] != nullptr) ri->SetExitType(args[1]);
+			}
+			break;
+		}
+
+		case RCT_BUILD_FENCE:
+			if (IsValidEnumArg(args[3], EDGE_COUNT) && args[4] >= FENCE_TYPE_BUILDABLE_BEGIN && args[4] < FENCE_TYPE_COUNT) {
+				BuildFence(voxel_pos, static_cast<TileEdge>(args[3]), static_cast<FenceType>(args[4]));
+			}
+			break;
+
+		case RCT_SET_GAME_MODE:
+			if (args[0] == GM_PLAY || args[0] == GM_EDITOR) _game_mode_mgr.SetGameMode(static_cast<GameMode>(args[0]));
+			break;
+
+		default:
+			NOT_REACHED();
+	}
+}
+
+/** Perform the player commands of the replay before the next simulation tick. */
+void Replay::OnTick()
+{
+	if (this->replaying) {
+		while (this->next_command < this->commands.size() && this->commands[this->next_command].tick <= this->tick) {
+			this->ExecuteCommand(this->commands[this->next_command]);
+			this->next_command++;
+		}
+	}
+	this->tick++;
+}
+
+/** Record or verify the checksum of the game state at the start of a new day. */
+void Replay::OnNewDay()
+{
+	if (this->record_file != nullptr) {
+		fprintf(this->record_file, "day %d-%02d-%02d %08x\n", _date.year, _date.month, _date.day, ComputeGameChecksum());
+		fflush(this->record_file);
+		return;
+	}
+
+	if (!this->replaying || this->next_checksum >= this->checksums.size()) return;
+	const ReplayChecksum &rc = this->checksums[this->next_checksum];
+	if (rc.date != _date.Compress()) return; // Not recorded.
+	this->next_checksum++;
+
+	uint32 checksum = ComputeGameChecksum();
+	if (checksum == rc.checksum) return;
+
+	this->mismatches++;
+	if (this->mismatches <= MAX_REPORTED_MISMATCHES) {
+		fprintf(stderr, "Replay: game state differs at %d-%02d-%02d (%08x instead of %08x)\n", _date.year, _date.month, _date.day, checksum, rc.checksum);
+	}
+}
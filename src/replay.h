@@ -0,0 +1,113 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file replay.h Recording and replaying the player commands of a game. */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "dates.h"
+#include <initializer_list>
+#include <vector>
+
+/** Player commands that can be recorded in a replay. */
+enum ReplayCommandType {
+	RCT_BUILD_FLAT_PATH,     ///< Build a flat path, see #BuildFlatPath.
+	RCT_BUILD_UPWARD_PATH,   ///< Build an upward path, see #BuildUpwardPath.
+	RCT_BUILD_DOWNWARD_PATH, ///< Build a downward path, see #BuildDownwardPath.
+	RCT_REMOVE_PATH,         ///< Remove a path, see #RemovePath.
+	RCT_CHANGE_PATH,         ///< Change the type of a path, see #ChangePath.
+	RCT_TERRAFORM_TILE,      ///< Change the terrain at a tile or a corner, see #ChangeTileCursorMode.
+	RCT_TERRAFORM_AREA,      ///< Change the terrain of an area, see #ChangeAreaCursorMode.
+	RCT_CREATE_RIDE,         ///< Create a fixed ride to place in the world, see #RidesManager::CreateInstance.
+	RCT_PLACE_RIDE,          ///< Place a created fixed ride in the world, see #RideBuildWindow::SelectorMouseButtonEvent.
+	RCT_REMOVE_RIDE,         ///< Remove a ride, see #RidesManager::DeleteInstance.
+	RCT_OPEN_RIDE,           ///< Open a ride, see #RideInstance::OpenRide.
+	RCT_CLOSE_RIDE,          ///< Close a ride, see #RideInstance::CloseRide.
+	RCT_PLACE_RIDE_ENTRANCE, ///< Move the entrance of a gentle or thrill ride, see #GentleThrillRideInstance::SetEntrancePos.
+	RCT_PLACE_RIDE_EXIT,     ///< Move the exit of a gentle or thrill ride, see #GentleThrillRideInstance::SetExitPos.
+	RCT_SET_ENTRANCE_TYPE,   ///< Change the entrance type of a ride, see #RideInstance::SetEntranceType.
+	RCT_SET_EXIT_TYPE,       ///< Change the exit type of a ride, see #RideInstance::SetExitType.
+	RCT_BUILD_FENCE,         ///< Build a fence, see #BuildFence.
+	RCT_SET_GAME_MODE,       ///< Switch between playing and editing, see #GameModeManager::SetGameMode.
+
+	RCT_COUNT,               ///< Number of player command types.
+};
+
+static const int REPLAY_MAX_ARGS = 6; ///< Maximal number of arguments of a player command.
+
+/** A player command in a replay. */
+struct ReplayCommand {
+	uint32 tick;                  ///< Number of simulation ticks since the start of the game before the command was given.
+	ReplayCommandType type;       ///< Type of the command.
+	int32 args[REPLAY_MAX_ARGS];  ///< Arguments of the command, unused arguments are \c 0.
+};
+
+/** Checksum of the game state at a day in a replay. */
+struct ReplayChecksum {
+	CompressedDate date; ///< Day of the checksum.
+	uint32 checksum;     ///< Checksum of the game state, see #ComputeGameChecksum.
+};
+
+/**
+ * Recording or replaying of the player commands of a new game.
+ * A replay file contains the master seed of the game, the player commands with the simulation tick at which they were given,
+ * and a checksum of the game state at the start of every day. Replaying the commands in a new game with the same seed gives
+ * the same game, which is verified with the checksums.
+ */
+class Replay {
+public:
+	Replay();
+	~Replay();
+
+	bool StartRecording(const char *fname);
+	bool LoadReplay(const char *fname);
+	void Stop();
+
+	void StartGame(uint32 game_seed);
+	void Record(ReplayCommandType type, std::initializer_list<int32> args);
+	void RecordUnsupported(const char *command);
+	void OnTick();
+	void OnNewDay();
+
+	/**
+	 * Are player commands being recorded?
+	 * @return Whether a replay is being recorded.
+	 */
+	inline bool IsRecording() const
+	{
+		return this->record_file != nullptr;
+	}
+
+	/**
+	 * Is a recorded game being replayed?
+	 * @return Whether a replay is being played.
+	 */
+	inline bool IsReplaying() const
+	{
+		return this->replaying;
+	}
+
+	uint32 seed;     ///< Master seed of the replayed game.
+	uint32 tick;     ///< Number of simulation ticks since the start of the game.
+	uint mismatches; ///< Number of days where the game state differed from the replay.
+
+private:
+	void ExecuteCommand(const ReplayCommand &cmd);
+
+	FILE *record_file; ///< File being recorded, \c nullptr if not recording.
+	bool replaying;    ///< Whether a replay is being played.
+
+	std::vector<ReplayCommand> commands;   ///< Player commands of the replay.
+	std::vector<ReplayChecksum> checksums; ///< Daily checksums of the replay.
+	uint next_command;  ///< Index of the next command to perform in #commands.
+	uint next_checksum; ///< Index of the next checksum to verify in #checksums.
+};
+
+extern Replay _replay;
+
+#endif
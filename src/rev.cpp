@@ -0,0 +1,39 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file rev.cpp Autogenerated file with the revision and such of FreeRCT. */
+
+#include "rev.h"
+
+/**
+ * The text version of FreeRCT's revision.
+ * This will be either "<major>.<minor>.<build>[-RC<rc>]",
+ * "<commitdate YYYYmmdd-HHMM>.<vcs type><identifier>" or "norev.n000".
+ *
+ * The major, minor and build are the numbers that describe releases of
+ * FreeRCT (like 0.5.3). "-RC" is used to flag release candidates.
+ * Note: This format is not yet implemented in the configure script.
+ *
+ * The revision number is fairly straight forward. The first part is the
+ * date of the last commit, in the format "%Y%m%d-%H%M", followed by a
+ * '.', and then a VCS tag - 'r' for svn (including hgsvn and git svn),
+ * 'h' for hg, and 'g' for git checkouts. This is finally followed by
+ * the revision for that VCS.
+ * e.g. 20130921-0929.r870
+ *
+ * norev.n000 is for non-releases that are made on systems where no VCS
+ * detection was possible.
+ */
+const char _freerct_revision[] = "ea58a69";
+
+/**
+ * The text version of FreeRCT's build date.
+ * Updating the build date in this file is the safest as it generally gets
+ * updated for each revision in contrary to most other files that only see
+ * updates when they are actually changed themselves.
+ */
+const char _freerct_build_date[] = __DATE__ " " __TIME__;
@@ -14,6 +14,7 @@
 #include "gentle_thrill_ride_type.h"
 #include "mouse_mode.h"
 #include "language.h"
+#include "replay.h"
 
 #include "gui_sprites.h"
 
@@ -118,7 +119,10 @@ RideBuildWindow::RideBuildWindow(RideInstance *ri) : GuiWindow(WC_RIDE_BUILD, ri
 RideBuildWindow::~RideBuildWindow()
 {
 	this->SetSelector(nullptr);
-	if (this->instance != nullptr) _rides_manager.DeleteInstance(this->instance->GetIndex());
+	if (this->instance != nullptr) {
+		_replay.Record(RCT_REMOVE_RIDE, {this->instance->GetIndex()});
+		_rides_manager.DeleteInstance(this->instance->GetIndex());
+	}
 }
 
 void RideBuildWindow::SetWidgetStringParameters(WidgetNumber wid_num) const
@@ -388,6 +392,7 @@ void RideBuildWindow::SelectorMouseButtonEvent(uint8 state)
 	const SmallRideInstance inst_number = static_cast<SmallRideInstance>(this->instance->GetIndex());
 	const RideTypeKind kind = si->GetKind();
 
+	_replay.Record(RCT_PLACE_RIDE, {inst_number, si->vox_pos.x, si->vox_pos.y, si->vox_pos.z, si->orientation});
 	_rides_manager.NewInstanceAdded(inst_number);
 	AddRemovePathEdges(si->vox_pos, PATH_EMPTY, si->GetEntranceDirections(si->vox_pos), PAS_QUEUE_PATH);
 
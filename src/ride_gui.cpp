@@ -15,6 +15,7 @@
 #include "palette.h"
 #include "viewport.h"
 #include "map.h"
+#include "replay.h"
 
 #include "gui_sprites.h"
 
@@ -232,6 +233,11 @@ void RideSelectGui::OnClick(WidgetNumber wid_num, const Point16 &pos)
 				uint16 instance = _rides_manager.GetFreeInstance(ride_type);
 				if (instance == INVALID_RIDE_INSTANCE) return;
 
+				if (ride_type->kind == RTK_COASTER) {
+					_replay.RecordUnsupported("Building a roller coaster");
+				} else {
+					_replay.Record(RCT_CREATE_RIDE, {instance, this->current_ride});
+				}
 				RideInstance *ri = _rides_manager.CreateInstance(ride_type, instance);
 				assert(this->current_kind == ride_type->kind);
 				switch (ride_type->kind) {
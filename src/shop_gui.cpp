@@ -15,6 +15,7 @@
 #include "sprite_store.h"
 #include "shop_type.h"
 #include "entity_gui.h"
+#include "replay.h"
 
 /** Window to prompt for removing a shop. */
 class ShopRemoveWindow : public EntityRemoveWindow  {
@@ -41,6 +42,7 @@ void ShopRemoveWindow::OnClick(WidgetNumber number, const Point16 &pos)
 {
 	if (number == ERW_YES) {
 		delete GetWindowByType(WC_SHOP_MANAGER, this->si->GetIndex());
+		_replay.Record(RCT_REMOVE_RIDE, {this->si->GetIndex()});
 		_rides_manager.DeleteInstance(this->si->GetIndex());
 	}
 	delete this;
@@ -251,6 +253,7 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, const Point16 &pos)
 		case SMW_SHOP_OPENED_TEXT:
 		case SMW_SHOP_OPENED:
 			if (this->shop->state != RIS_OPEN) {
+				_replay.Record(RCT_OPEN_RIDE, {this->shop->GetIndex()});
 				this->shop->OpenRide();
 				this->SetShopToggleButtons();
 			}
@@ -259,6 +262,7 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, const Point16 &pos)
 		case SMW_SHOP_CLOSED_TEXT:
 		case SMW_SHOP_CLOSED:
 			if (this->shop->state != RIS_CLOSED) {
+				_replay.Record(RCT_CLOSE_RIDE, {this->shop->GetIndex()});
 				this->shop->CloseRide();
 				this->SetShopToggleButtons();
 			}
@@ -0,0 +1,266 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file sprite_cache.cpp Cache of sprites decoded for blitting. */
+
+#include "stdafx.h"
+#include "sprite_cache.h"
+#include "sprite_data.h"
+#include "blitter.h"
+#include "bitmath.h"
+
+SpriteCache _sprite_cache; ///< Cache of the sprites drawn at the screen.
+
+static const size_t DEFAULT_SPRITE_CACHE_SIZE = 32 * 1024 * 1024; ///< Default memory limit of the sprite cache, in bytes.
+
+/**
+ * Add pixels to the current row of the sprite, extending the last span of the row if possible.
+ * @param x Horizontal offset of the first pixel in the row.
+ * @param colours Colours of the pixels.
+ * @param count Number of pixels.
+ * @param blend Whether the pixels are blended with the screen.
+ * @param opacity Opacity of the pixels, if \a blend is set.
+ */
+void DecodedSprite::AddPixels(int16 x, const uint32 *colours, uint count, bool blend, uint8 opacity)
+{
+	if (count == 0) return;
+
+	if (this->spans.size() > this->row_starts.back()) {
+		DecodedSpan &last = this->spans.back();
+		if (last.x + last.count == x && last.blend == blend && last.opacity == opacity && last.count + count <= UINT16_MAX) {
+			last.count += count;
+			this->pixels.insert(this->pixels.end(), colours, colours + count);
+			return;
+		}
+	}
+	this->spans.push_back({x, static_cast<uint16>(count), opacity, blend, static_cast<uint32>(this->pixels.size())});
+	this->pixels.insert(this->pixels.end(), colours, colours + count);
+}
+
+/**
+ * Decode an 8bpp sprite.
+ * @param spr Sprite to decode.
+ * @param recoloured Shifted palette to use.
+ */
+void DecodedSprite::Decode8bpp(const ImageData *spr, const uint8 *recoloured)
+{
+	for (int yoff = 0; yoff < spr->height; yoff++) {
+		this->row_starts.push_back(this->spans.size());
+		uint32 offset = spr->table[yoff];
+		if (offset == INVALID_JUMP) continue;
+
+		int16 xpos = 0;
+		for (;;) {
+			uint8 rel_off = spr->data[offset];
+			uint8 count   = spr->data[offset + 1];
+			const uint8 *pixels = &spr->data[offset + 2];
+			offset += 2 + count;
+
+			xpos += rel_off & 127;
+			for (; count > 0; count--) {
+				uint32 colour = _palette[recoloured[*pixels++]];
+				this->AddPixels(xpos, &colour, 1, GetA(colour) != OPAQUE, GetA(colour));
+				xpos++;
+			}
+			if ((rel_off & 128) != 0) break;
+		}
+	}
+}
+
+/**
+ * Decode a 32bpp sprite.
+ * @param spr Sprite to decode.
+ * @param recolour Sprite recolouring definition.
+ * @param shift Gradient shift.
+ */
+void DecodedSprite::Decode32bpp(const ImageData *spr, const Recolouring &recolour, GradientShift shift)
+{
+	const bool white = shift == GS_SEMI_TRANSPARENT;
+	const int delta = white ? 0 : (shift - GS_NORMAL) * STEP_SIZE;
+	uint32 colours[64]; // Colours of a run.
+	if (white) std::fill(colours, colours + lengthof(colours), MakeRGBA(255, 255, 255, OPAQUE));
+
+	const uint8 *src = spr->data;
+	for (int yoff = 0; yoff < spr->height; yoff++) {
+		this->row_starts.push_back(this->spans.size());
+		src += 2; // Skip the length word.
+		int16 xpos = 0;
+		for (;;) {
+			uint8 mode = *src++;
+			if (mode == 0) break;
+
+			const uint count = mode & 0x3F;
+			switch (mode >> 6) {
+				case 0: // Fully opaque pixels.
+					if (white) {
+						this->AddPixels(xpos, colours, count, true, OPACITY_SEMI_TRANSPARENT);
+					} else {
+						_blitter.expand_rgb(colours, src, count);
+						if (delta != 0) _blitter.shift(colours, count, delta);
+						this->AddPixels(xpos, colours, count, false, OPAQUE);
+					}
+					src += 3 * count;
+					break;
+
+				case 1: { // Partial opaque pixels.
+					uint8 opacity = *src++;
+					if (white) {
+						opacity = std::min<uint8>(opacity, OPACITY_SEMI_TRANSPARENT);
+					} else {
+						_blitter.expand_rgb(colours, src, count);
+						if (delta != 0) _blitter.shift(colours, count, delta);
+					}
+					this->AddPixels(xpos, colours, count, true, opacity);
+					src += 3 * count;
+					break;
+				}
+				case 2: // Fully transparent pixels.
+					break;
+
+				case 3: { // Recoloured pixels.
+					uint8 layer = *src++;
+					uint8 opacity = *src++;
+					if (white) {
+						opacity = std::min<uint8>(opacity, OPACITY_SEMI_TRANSPARENT);
+					} else {
+						_blitter.recolour(colours, src, count, recolour.GetRecolourTable(layer - 1));
+						if (delta != 0) _blitter.shift(colours, count, delta);
+					}
+					this->AddPixels(xpos, colours, count, true, opacity);
+					src += count;
+					break;
+				}
+			}
+			xpos += count;
+		}
+	}
+}
+
+/**
+ * Decode a sprite for blitting.
+ * @param spr Sprite to decode.
+ * @param recolour Sprite recolouring definition.
+ * @param shift Gradient shift.
+ */
+void DecodedSprite::Decode(const ImageData *spr, const Recolouring &recolour, GradientShift shift)
+{
+	this->height = spr->height;
+	this->row_starts.clear();
+	this->spans.clear();
+	this->pixels.clear();
+
+	if (GB(spr->flags, IFG_IS_8BPP, 1) != 0) {
+		this->Decode8bpp(spr, recolour.GetPalette(shift));
+	} else {
+		this->Decode32bpp(spr, recolour, shift);
+	}
+	this->row_starts.push_back(this->spans.size());
+
+	this->row_starts.shrink_to_fit();
+	this->spans.shrink_to_fit();
+	this->pixels.shrink_to_fit();
+}
+
+/**
+ * Get the amount of memory used by the decoded sprite.
+ * @return Size of the decoded sprite, in bytes.
+ */
+size_t DecodedSprite::GetMemorySize() const
+{
+	return sizeof(*this) + this->row_starts.capacity() * sizeof(uint32) + this->spans.capacity() * sizeof(DecodedSpan) + this->pixels.capacity() * sizeof(uint32);
+}
+
+/**
+ * Compute the hash of a cache key.
+ * @param key Key to hash.
+ * @return Hash value of the key.
+ */
+size_t SpriteCache::KeyHash::operator()(const Key &key) const
+{
+	uint64 hash = reinterpret_cast<uintptr_t>(key.sprite);
+	hash ^= (key.recolour + key.shift) * 0x9E3779B97F4A7C15ULL;
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+SpriteCache::SpriteCache() : hits(0), misses(0), evictions(0), memory_used(0), memory_limit(DEFAULT_SPRITE_CACHE_SIZE), frame(0)
+{
+}
+
+/**
+ * Get a decoded sprite, decoding it if it is not in the cache.
+ * @param spr Sprite to get.
+ * @param recolour Sprite recolouring definition.
+ * @param shift Gradient shift.
+ * @return The decoded sprite, valid until the next call of #BeginFrame.
+ */
+const DecodedSprite *SpriteCache::Get(const ImageData *spr, const Recolouring &recolour, GradientShift shift)
+{
+	Key key = {spr, recolour.GetKey(), shift};
+	auto iter = this->lookup.find(key);
+	if (iter != this->lookup.end()) {
+		this->hits++;
+		this->entries.splice(this->entries.begin(), this->entries, iter->second);
+		iter->second->frame = this->frame;
+		return &iter->second->sprite;
+	}
+
+	this->misses++;
+	this->entries.emplace_front();
+	Entry &entry = this->entries.front();
+	entry.key = key;
+	entry.frame = this->frame;
+	entry.sprite.Decode(spr, recolour, shift);
+	entry.memory = sizeof(Entry) + entry.sprite.GetMemorySize() - sizeof(DecodedSprite);
+	this->memory_used += entry.memory;
+	this->lookup.emplace(key, this->entries.begin());
+
+	this->Evict();
+	return &entry.sprite;
+}
+
+/**
+ * Start a new frame, sprites used in the previous frame may be dropped from now on.
+ * @note Sprites are dropped only when getting a sprite that is not in the cache.
+ */
+void SpriteCache::BeginFrame()
+{
+	this->frame++;
+}
+
+/** Drop the least recently used sprites until the memory limit is met, sprites used in the current frame are always kept. */
+void SpriteCache::Evict()
+{
+	while (this->memory_used > this->memory_limit && !this->entries.empty() && this->entries.back().frame != this->frame) {
+		const Entry &entry = this->entries.back();
+		this->memory_used -= entry.memory;
+		this->lookup.erase(entry.key);
+		this->entries.pop_back();
+		this->evictions++;
+	}
+}
+
+/**
+ * Set the maximal amount of memory used by the cached sprites.
+ * @param limit Memory limit in bytes, \c 0 disables the cache.
+ */
+void SpriteCache::SetMemoryLimit(size_t limit)
+{
+	this->memory_limit = limit;
+	if (limit == 0) {
+		this->Clear();
+	} else {
+		this->Evict();
+	}
+}
+
+/** Drop all sprites from the cache, for example when the image data is destroyed. */
+void SpriteCache::Clear()
+{
+	this->lookup.clear();
+	this->entries.clear();
+	this->memory_used = 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file sprite_cache.h Cache of sprites decoded for blitting. */
+
+#ifndef SPRITE_CACHE_H
+#define SPRITE_CACHE_H
+
+#include "palette.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class ImageData;
+
+/** Horizontal span of pixels in a row of a #DecodedSprite that are drawn the same way. */
+struct DecodedSpan {
+	int16 x;       ///< Horizontal offset of the first pixel of the span in the row.
+	uint16 count;  ///< Number of pixels of the span.
+	uint8 opacity; ///< Opacity of the pixels, if #blend is set.
+	bool blend;    ///< Whether the pixels are blended with the screen, else they are copied.
+	uint32 first;  ///< Index of the first pixel of the span in #DecodedSprite::pixels.
+};
+
+/**
+ * Sprite decoded for blitting with a given recolouring and gradient shift.
+ * The rows are lists of spans, with the pixels of the spans already recoloured and shifted, so blitting is copying and blending spans.
+ */
+struct DecodedSprite {
+	void Decode(const ImageData *spr, const Recolouring &recolour, GradientShift shift);
+	size_t GetMemorySize() const;
+
+	uint16 height; ///< Number of rows of the sprite.
+	std::vector<uint32> row_starts; ///< Index of the first span of each row in #spans, followed by the number of spans.
+	std::vector<DecodedSpan> spans; ///< Spans of all rows, ordered by row and horizontal offset.
+	std::vector<uint32> pixels;     ///< Pixel colours of the spans.
+
+private:
+	void AddPixels(int16 x, const uint32 *colours, uint count, bool blend, uint8 opacity);
+	void Decode8bpp(const ImageData *spr, const uint8 *recoloured);
+	void Decode32bpp(const ImageData *spr, const Recolouring &recolour, GradientShift shift);
+};
+
+/**
+ * Bounded cache of decoded sprites, dropping the least recently used sprites when its memory limit is reached.
+ * Sprites are identified by their image data, their recolouring, and their gradient shift.
+ * Sprites used in the current frame are kept, so decoded sprites stay valid until the next #BeginFrame.
+ */
+class SpriteCache {
+public:
+	SpriteCache();
+
+	const DecodedSprite *Get(const ImageData *spr, const Recolouring &recolour, GradientShift shift);
+	void BeginFrame();
+	void SetMemoryLimit(size_t limit);
+	void Clear();
+
+	/**
+	 * Is the cache in use?
+	 * @return Whether sprites are cached, a memory limit of \c 0 disables the cache.
+	 */
+	inline bool IsEnabled() const
+	{
+		return this->memory_limit > 0;
+	}
+
+	uint64 hits;      ///< Number of sprites found in the cache.
+	uint64 misses;    ///< Number of sprites decoded and added to the cache.
+	uint64 evictions; ///< Number of sprites dropped from the cache.
+
+private:
+	/** Identification of a cached sprite. */
+	struct Key {
+		const ImageData *sprite; ///< Image data of the sprite.
+		uint64 recolour;         ///< Key of the recolouring, see #Recolouring::GetKey.
+		GradientShift shift;     ///< Gradient shift of the sprite.
+
+		/**
+		 * Equality operator of keys.
+		 * @param other Key to compare with.
+		 * @return Whether both keys identify the same sprite.
+		 */
+		inline bool operator==(const Key &other) const
+		{
+			return this->sprite == other.sprite && this->recolour == other.recolour && this->shift == other.shift;
+		}
+	};
+
+	/** Hash function of cache keys. */
+	struct KeyHash {
+		size_t operator()(const Key &key) const;
+	};
+
+	/** Cached sprite. */
+	struct Entry {
+		Key key;              ///< Identification of the sprite.
+		DecodedSprite sprite; ///< Decoded sprite.
+		size_t memory;        ///< Memory used by the entry, in bytes.
+		uint32 frame;         ///< Last frame using the sprite.
+	};
+
+	typedef std::list<Entry> EntryList; ///< Cached sprites, the most recently used sprite first.
+
+	void Evict();
+
+	EntryList entries; ///< Cached sprites, the most recently used sprite first.
+	std::unordered_map<Key, EntryList::iterator, KeyHash> lookup; ///< Cached sprites by key.
+	size_t memory_used;  ///< Memory used by the cached sprites, in bytes.
+	size_t memory_limit; ///< Maximal memory of the cached sprites, in bytes.
+	uint32 frame;        ///< Number of the current frame, sprites used in the current frame are not dropped.
+};
+
+extern SpriteCache _sprite_cache;
+
+#endif
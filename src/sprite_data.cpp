@@ -10,14 +10,16 @@
 #include "stdafx.h"
 #include "palette.h"
 #include "sprite_data.h"
+#include "sprite_cache.h"
 #include "fileio.h"
 #include "bitmath.h"
+#include "worker_pool.h"
 
 #include <vector>
 
 static const uint32 MAX_IMAGE_COUNT = 10000; ///< Maximum number of images that can be loaded (arbitrary number).
 
-static std::vector<ImageData> _sprites;  ///< Available sprites to the program.
+static std::vector<ImageData *> _sprites; ///< Available sprites to the program.
 static uint32 _sprites_loaded;           ///< Total number of sprites loaded.
 
 ImageData::ImageData()
@@ -26,12 +28,39 @@ ImageData::ImageData()
 	this->height = 0;
 	this->table = nullptr;
 	this->data = nullptr;
+	this->half = nullptr;
 }
 
 ImageData::~ImageData()
 {
 	delete[] this->table;
-	delete[] this->data;
+	if (this->file == nullptr) delete[] this->data;
+	delete this->half;
+}
+
+/**
+ * Load the image data from the RCD file. If the file is memory-mapped, the image uses the data in the file instead of a copy.
+ * @param rcd_file File to load from.
+ * @param length Length of the image data.
+ * @return Whether the data was loaded successfully.
+ */
+bool ImageData::LoadData(RcdFileReader *rcd_file, size_t length)
+{
+	if (rcd_file->GetMapping() != nullptr) {
+		const uint8 *mapped = rcd_file->GetMappedBlob(length);
+		if (mapped == nullptr) return false; // The file is truncated.
+		this->data = mapped;
+		this->file = rcd_file->GetMapping();
+		return true;
+	}
+
+	uint8 *data = new uint8[length];
+	if (!rcd_file->GetBlob(data, length)) {
+		delete[] data;
+		return false;
+	}
+	this->data = data;
+	return true;
 }
 
 /**
@@ -60,10 +89,9 @@ bool ImageData::Load8bpp(RcdFileReader *rcd_file, size_t length)
 	length -= jmp_table;
 
 	this->table = new uint32[jmp_table / 4];
-	this->data  = new uint8[length];
-	if (this->table == nullptr || this->data == nullptr) return false;
+	if (this->table == nullptr) return false;
 
-	/* Load jump table, adjusting the entries while loading. */
+	/* Load jump table, adjusting the entries while loading. The table is always converted, the data is used as stored in the file. */
 	for (uint i = 0; i < this->height; i++) {
 		uint32 dest = rcd_file->GetUInt32();
 		if (dest == 0) {
@@ -75,7 +103,7 @@ bool ImageData::Load8bpp(RcdFileReader *rcd_file, size_t length)
 		this->table[i] = dest;
 	}
 
-	rcd_file->GetBlob(this->data, length); // Load the image data.
+	if (!this->LoadData(rcd_file, length)) return false;
 
 	/* Verify the image data. */
 	for (uint i = 0; i < this->height; i++) {
@@ -120,13 +148,10 @@ bool ImageData::Load32bpp(RcdFileReader *rcd_file, size_t length)
 	length -= 8;
 	if (length > 100 * 1024) return false; // Another arbitrary limit.
 
-	/* Allocate and load the image data. */
-	this->data = new uint8[length];
-	if (this->data == nullptr) return false;
-	rcd_file->GetBlob(this->data, length);
+	if (!this->LoadData(rcd_file, length)) return false;
 
 	/* Verify the data. */
-	uint8 *abs_end = this->data + length;
+	const uint8 *abs_end = this->data + length;
 	int line_count = 0;
 	const uint8 *ptr = this->data;
 	bool finished = false;
@@ -256,41 +281,340 @@ uint32 ImageData::GetPixel(uint16 xoffset, uint16 yoffset, const Recolouring *re
 	}
 }
 
+/** Pixel of an image while making a smaller image. */
+struct ScalePixel {
+	uint8 mode;    ///< Way of drawing the pixel, as in the 32bpp image data: \c 0 opaque, \c 1 partial opaque, \c 2 transparent, \c 3 recoloured.
+	uint8 opacity; ///< Opacity of a partial opaque or recoloured pixel.
+	uint8 layer;   ///< Recolour layer of a recoloured pixel.
+	uint8 col[3];  ///< Colour of the pixel, palette index of 8bpp pixels and recoloured pixels in the first byte.
+};
+
+/**
+ * Round a coordinate down to half the size.
+ * @param value Coordinate to halve.
+ * @return Largest coordinate at half the size that is not after \a value.
+ */
+static inline int HalveDown(int value)
+{
+	return (value >= 0) ? value / 2 : -((1 - value) / 2);
+}
+
+/**
+ * Decode the pixels of an 8bpp image.
+ * @param imd Image to decode.
+ * @param [out] pixels Pixels of the image, row by row.
+ */
+static void DecodePixels8bpp(const ImageData *imd, std::vector<ScalePixel> *pixels)
+{
+	for (uint y = 0; y < imd->height; y++) {
+		uint32 offset = imd->table[y];
+		if (offset == INVALID_JUMP) continue;
+
+		uint x = 0;
+		for (;;) {
+			uint8 rel_pos = imd->data[offset];
+			uint8 count = imd->data[offset + 1];
+			x += rel_pos & 127;
+			for (uint i = 0; i < count; i++) {
+				uint8 index = imd->data[offset + 2 + i];
+				if (index != 0) (*pixels)[y * imd->width + x + i] = {0, OPAQUE, 0, {index, 0, 0}};
+			}
+			x += count;
+			offset += 2 + count;
+			if ((rel_pos & 128) != 0) break;
+		}
+	}
+}
+
+/**
+ * Decode the pixels of a 32bpp image.
+ * @param imd Image to decode.
+ * @param [out] pixels Pixels of the image, row by row.
+ */
+static void DecodePixels32bpp(const ImageData *imd, std::vector<ScalePixel> *pixels)
+{
+	const uint8 *ptr = imd->data;
+	for (uint y = 0; y < imd->height; y++) {
+		ptr += 2; // Skip the length of the row.
+		uint x = 0;
+		for (;;) {
+			uint8 mode = *ptr++;
+			if (mode == 0) break;
+			uint count = mode & 0x3F;
+			ScalePixel *dest = &(*pixels)[y * imd->width + x];
+			switch (mode >> 6) {
+				case 0:
+					for (uint i = 0; i < count; i++) dest[i] = {0, OPAQUE, 0, {ptr[3 * i], ptr[3 * i + 1], ptr[3 * i + 2]}};
+					ptr += 3 * count;
+					break;
+				case 1: {
+					uint8 opacity = *ptr++;
+					for (uint i = 0; i < count; i++) dest[i] = {1, opacity, 0, {ptr[3 * i], ptr[3 * i + 1], ptr[3 * i + 2]}};
+					ptr += 3 * count;
+					break;
+				}
+				case 2:
+					break;
+				case 3: {
+					uint8 layer = *ptr++;
+					uint8 opacity = *ptr++;
+					for (uint i = 0; i < count; i++) dest[i] = {3, opacity, layer, {ptr[i], 0, 0}};
+					ptr += count;
+					break;
+				}
+			}
+			x += count;
+		}
+	}
+}
+
+/**
+ * Encode pixels as 8bpp image data.
+ * @param [inout] imd Image to store the data, with its size set.
+ * @param pixels Pixels of the image, row by row.
+ */
+static void EncodePixels8bpp(ImageData *imd, const std::vector<ScalePixel> &pixels)
+{
+	std::vector<uint8> data;
+	imd->table = new uint32[imd->height];
+	for (uint y = 0; y < imd->height; y++) {
+		const ScalePixel *row = &pixels[y * imd->width];
+		imd->table[y] = INVALID_JUMP;
+		size_t last_run = 0; // Offset of the last run of the row.
+		uint x = 0;
+		uint start = 0; // End of the previous run.
+		for (;;) {
+			while (x < imd->width && row[x].mode == 2) x++;
+			if (x == imd->width) break;
+
+			if (imd->table[y] == INVALID_JUMP) imd->table[y] = data.size();
+			/* Skip the transparent pixels, with empty runs if the gap is too long. */
+			while (x - start > 127) {
+				data.push_back(127);
+				data.push_back(0);
+				start += 127;
+			}
+			last_run = data.size();
+			data.push_back(x - start);
+			data.push_back(0);
+			while (x < imd->width && row[x].mode != 2 && data[last_run + 1] < 255) {
+				data.push_back(row[x].col[0]);
+				data[last_run + 1]++;
+				x++;
+			}
+			start = x;
+		}
+		if (imd->table[y] != INVALID_JUMP) data[last_run] |= 128;
+	}
+	uint8 *encoded = new uint8[data.size()];
+	std::copy(data.begin(), data.end(), encoded);
+	imd->data = encoded;
+}
+
+/**
+ * Encode pixels as 32bpp image data.
+ * @param [inout] imd Image to store the data, with its size set.
+ * @param pixels Pixels of the image, row by row.
+ */
+static void EncodePixels32bpp(ImageData *imd, const std::vector<ScalePixel> &pixels)
+{
+	std::vector<uint8> data;
+	for (uint y = 0; y < imd->height; y++) {
+		const ScalePixel *row = &pixels[y * imd->width];
+		size_t row_start = data.size();
+		data.push_back(0); // Length of the row, filled in afterwards.
+		data.push_back(0);
+
+		/* Trailing transparent pixels are not stored. */
+		uint end = imd->width;
+		while (end > 0 && row[end - 1].mode == 2) end--;
+
+		uint x = 0;
+		while (x < end) {
+			const ScalePixel &first = row[x];
+			uint count = 1;
+			while (x + count < end && count < 63 && row[x + count].mode == first.mode &&
+					(first.mode == 0 || first.mode == 2 || (row[x + count].opacity == first.opacity && row[x + count].layer == first.layer))) {
+				count++;
+			}
+			data.push_back((first.mode << 6) | count);
+			switch (first.mode) {
+				case 0:
+				case 1:
+					if (first.mode == 1) data.push_back(first.opacity);
+					for (uint i = 0; i < count; i++) data.insert(data.end(), row[x + i].col, row[x + i].col + 3);
+					break;
+				case 2:
+					break;
+				case 3:
+					data.push_back(first.layer);
+					data.push_back(first.opacity);
+					for (uint i = 0; i < count; i++) data.push_back(row[x + i].col[0]);
+					break;
+			}
+			x += count;
+		}
+		data.push_back(0);
+
+		size_t length = data.size() - row_start;
+		data[row_start] = length & 0xFF;
+		data[row_start + 1] = length >> 8;
+	}
+	uint8 *encoded = new uint8[data.size()];
+	std::copy(data.begin(), data.end(), encoded);
+	imd->data = encoded;
+}
+
+/**
+ * Make the image at half the size, for the next zoom level.
+ * The image is scaled down in blocks of 2x2 screen pixels, taking the first non-transparent pixel of each block. Taking a pixel rather
+ * than mixing the colours keeps the palette indices and recolour layers of the pixels, so the smaller image is recoloured and used
+ * for finding the parts of ground tiles in the same way.
+ * @return The new image.
+ */
+ImageData *ImageData::MakeHalfSize() const
+{
+	const bool is_8bpp = GB(this->flags, IFG_IS_8BPP, 1) != 0;
+	std::vector<ScalePixel> pixels(this->width * this->height, {2, 0, 0, {0, 0, 0}});
+	if (is_8bpp) {
+		DecodePixels8bpp(this, &pixels);
+	} else {
+		DecodePixels32bpp(this, &pixels);
+	}
+
+	/* The blocks are aligned at the origin of the image, so images drawn at the same position stay aligned. */
+	ImageData *half = new ImageData;
+	half->flags = this->flags;
+	half->xoffset = HalveDown(this->xoffset);
+	half->yoffset = HalveDown(this->yoffset);
+	half->width = HalveDown(this->xoffset + this->width + 1) - half->xoffset;
+	half->height = HalveDown(this->yoffset + this->height + 1) - half->yoffset;
+
+	std::vector<ScalePixel> half_pixels(half->width * half->height, {2, 0, 0, {0, 0, 0}});
+	for (int y = 0; y < half->height; y++) {
+		for (int x = 0; x < half->width; x++) {
+			for (int i = 0; i < 4; i++) {
+				int src_x = 2 * (half->xoffset + x) + (i & 1) - this->xoffset;
+				int src_y = 2 * (half->yoffset + y) + (i >> 1) - this->yoffset;
+				if (src_x < 0 || src_x >= this->width || src_y < 0 || src_y >= this->height) continue;
+
+				const ScalePixel &pixel = pixels[src_y * this->width + src_x];
+				if (pixel.mode == 2) continue;
+				half_pixels[y * half->width + x] = pixel;
+				break;
+			}
+		}
+	}
+
+	if (is_8bpp) {
+		EncodePixels8bpp(half, half_pixels);
+	} else {
+		EncodePixels32bpp(half, half_pixels);
+	}
+	return half;
+}
+
 /**
  * Load 8bpp or 32bpp sprite block from the \a rcd_file.
  * @param rcd_file File being loaded.
- * @return Loaded sprite, if loading was successful, else \c nullptr.
+ * @return Loaded sprite, if loading was successful, else \c nullptr. The caller owns the sprite, until it is added with #AddImage.
+ * @note Does not access shared data, files may be loaded concurrently.
  */
 ImageData *LoadImage(RcdFileReader *rcd_file)
 {
-	if (_sprites_loaded >= MAX_IMAGE_COUNT) {
-		fprintf(stderr, "Attempt to load too many sprites! MAX_IMAGE_COUNT needs to be increased.\n");
-		exit(1);
-	}
 	bool is_8bpp = strcmp(rcd_file->name, "8PXL") == 0;
 	if (rcd_file->version != (is_8bpp ? 2 : 1)) return nullptr;
 
-	_sprites.emplace_back();
-	_sprites_loaded++;
-	ImageData *imd = &_sprites.back();
+	ImageData *imd = new ImageData;
 	bool loaded = is_8bpp ? imd->Load8bpp(rcd_file, rcd_file->size) : imd->Load32bpp(rcd_file, rcd_file->size);
 	if (!loaded) {
-		_sprites.pop_back();
-		_sprites_loaded--;
+		delete imd;
 		return nullptr;
 	}
 	imd->flags = is_8bpp ? (1 << IFG_IS_8BPP) : 0;
 	return imd;
 }
 
+/**
+ * Add a loaded sprite to the sprites available to the program.
+ * @param imd Sprite to add, the image storage takes ownership.
+ */
+void AddImage(ImageData *imd)
+{
+	if (_sprites_loaded >= MAX_IMAGE_COUNT) {
+		fprintf(stderr, "Attempt to load too many sprites! MAX_IMAGE_COUNT needs to be increased.\n");
+		exit(1);
+	}
+	_sprites.push_back(imd);
+	_sprites_loaded++;
+}
+
+RcdFileImages::~RcdFileImages()
+{
+	for (auto &entry : this->images) delete entry.second;
+}
+
+/**
+ * Decode the images of an RCD file.
+ * Decoding stops at the first image that fails to load, loading the file later reports the error.
+ * @param fname Name of the RCD file.
+ */
+void RcdFileImages::Decode(const char *fname)
+{
+	RcdFileReader rcd_file(fname);
+	if (!rcd_file.CheckFileHeader("RCDF", 2)) return;
+
+	while (rcd_file.ReadBlockHeader()) {
+		if (strcmp(rcd_file.name, "8PXL") != 0 && strcmp(rcd_file.name, "32PX") != 0) {
+			if (!rcd_file.SkipBytes(rcd_file.size)) return;
+			continue;
+		}
+
+		size_t position = rcd_file.GetPosition();
+		ImageData *imd = LoadImage(&rcd_file);
+		if (imd == nullptr) return;
+		this->images[position] = imd;
+	}
+}
+
+/**
+ * Take a decoded image.
+ * @param position Position of the data of the image block in the file.
+ * @return The decoded image of the block, owned by the caller, or \c nullptr if no image was decoded there.
+ */
+ImageData *RcdFileImages::Take(size_t position)
+{
+	auto iter = this->images.find(position);
+	if (iter == this->images.end()) return nullptr;
+
+	ImageData *imd = iter->second;
+	this->images.erase(iter);
+	return imd;
+}
+
 /** Initialize image storage. */
 void InitImageStorage()
 {
 	_sprites.reserve(MAX_IMAGE_COUNT);
 }
 
+/** Generate the smaller images of all zoom levels of the loaded images, concurrently on the worker threads. */
+void GenerateZoomedImages()
+{
+	_worker_pool.Run(_sprites.size(), [](uint i) {
+		ImageData *current = _sprites[i];
+		for (int zoom = 1; zoom < ZOOM_LEVEL_COUNT; zoom++) {
+			if (current->half == nullptr) current->half = current->MakeHalfSize();
+			current = current->half;
+		}
+	});
+}
+
 /** Clear all memory. */
 void DestroyImageStorage()
 {
+	_sprite_cache.Clear();
+	for (ImageData *imd : _sprites) delete imd;
 	_sprites.clear();
+	_sprites_loaded = 0;
 }
@@ -10,15 +10,21 @@
 #ifndef SPRITE_DATA_H
 #define SPRITE_DATA_H
 
+#include <map>
+#include <memory>
+
 static const uint32 INVALID_JUMP = UINT32_MAX; ///< Invalid jump destination in image data.
 
 class RcdFileReader;
+class MappedFile;
 
 /** Flags of an image in #ImageData. */
 enum ImageFlags {
 	IFG_IS_8BPP = 0, ///< Bit number used for the image type.
 };
 
+static const int ZOOM_LEVEL_COUNT = 4; ///< Number of zoom levels of the images, each level halves the size of the images of the previous level.
+
 /**
  * Image data of 8bpp images.
  * @ingroup sprites_group
@@ -32,6 +38,19 @@ public:
 	bool Load32bpp(RcdFileReader *rcd_file, size_t length);
 
 	uint32 GetPixel(uint16 xoffset, uint16 yoffset, const Recolouring *recolour = nullptr, GradientShift shift = GS_NORMAL) const;
+	ImageData *MakeHalfSize() const;
+
+	/**
+	 * Get the image at a zoom level.
+	 * @param zoom Zoom level, \c 0 is the image itself.
+	 * @return The image at the zoom level, or the smallest generated image if the zoom level is not available.
+	 */
+	inline const ImageData *GetZoomed(uint8 zoom) const
+	{
+		const ImageData *imd = this;
+		for (; zoom > 0 && imd->half != nullptr; zoom--) imd = imd->half;
+		return imd;
+	}
 
 	/**
 	 * Is the sprite just a single pixel?
@@ -48,12 +67,35 @@ public:
 	int16 xoffset; ///< Horizontal offset of the image.
 	int16 yoffset; ///< Vertical offset of the image.
 	uint32 *table; ///< The jump table. For missing entries, #INVALID_JUMP is used.
-	uint8 *data;   ///< The image data itself.
+	const uint8 *data; ///< The image data itself, owned by the image unless it is in #file.
+	ImageData *half; ///< The image at half the size (the next zoom level), if generated. Owned by this image.
+	std::shared_ptr<const MappedFile> file; ///< Memory-mapped file containing #data, \c nullptr if the image owns the data.
+
+private:
+	bool LoadData(RcdFileReader *rcd_file, size_t length);
+};
+
+/**
+ * Images of an RCD file, decoded before the other blocks of the file are loaded.
+ * Decoding does not depend on other files, so the images of several files can be decoded concurrently.
+ * @ingroup sprites_group
+ */
+class RcdFileImages {
+public:
+	~RcdFileImages();
+
+	void Decode(const char *fname);
+	ImageData *Take(size_t position);
+
+private:
+	std::map<size_t, ImageData *> images; ///< Decoded images not taken yet, by position of their block in the file.
 };
 
 ImageData *LoadImage(RcdFileReader *rcd_file);
+void AddImage(ImageData *imd);
 
 void InitImageStorage();
+void GenerateZoomedImages();
 void DestroyImageStorage();
 
 #endif
@@ -27,6 +27,7 @@
 #include "coaster.h"
 #include "gui_sprites.h"
 #include "string_func.h"
+#include "worker_pool.h"
 
 SpriteManager _sprite_manager; ///< Sprite manager.
 GuiSprites _gui_sprites;       ///< GUI sprites.
@@ -1358,11 +1359,12 @@ SpriteManager::~SpriteManager()
 /**
  * Load sprites from the disk.
  * @param filename Name of the RCD file to load.
+ * @param images Images of the file decoded beforehand, if available. Other images are decoded while loading.
  * @return Error message if load failed, else \c nullptr.
  * @todo Try to re-use already loaded blocks.
  * @todo Code will use last loaded surface as grass.
  */
-const char *SpriteManager::Load(const char *filename)
+const char *SpriteManager::Load(const char *filename, RcdFileImages *images)
 {
 	RcdFileReader rcd_file(filename);
 	if (!rcd_file.CheckFileHeader("RCDF", 2)) return "Bad header";
@@ -1382,10 +1384,16 @@ const char *SpriteManager::Load(const char *filename)
 		}
 
 		if (strcmp(rcd_file.name, "8PXL") == 0 || strcmp(rcd_file.name, "32PX") == 0) {
-			ImageData *imd = LoadImage(&rcd_file);
-			if (imd == nullptr) {
-				return "Image data loading failed";
+			ImageData *imd = (images != nullptr) ? images->Take(rcd_file.GetPosition()) : nullptr;
+			if (imd != nullptr) {
+				if (!rcd_file.SkipBytes(rcd_file.size)) return "Image data loading failed";
+			} else {
+				imd = LoadImage(&rcd_file);
+				if (imd == nullptr) {
+					return "Image data loading failed";
+				}
 			}
+			AddImage(imd);
 			std::pair<uint, ImageData *> p(blk_num, imd);
 			sprites.insert(p);
 			continue;
@@ -1619,14 +1627,24 @@ SpriteStorage *SpriteManager::GetSpriteStore(uint16 width)
 	return nullptr;
 }
 
-/** Load all useful RCD files found by #_rcd_collection, into the program. */
+/**
+ * Load all useful RCD files found by #_rcd_collection, into the program.
+ * The images of the files are decoded concurrently on the worker threads first. The blocks are then loaded file by file in the
+ * same order as without decoding beforehand, so the loaded data does not depend on the number of threads.
+ */
 void SpriteManager::LoadRcdFiles()
 {
-	for (auto &entry : _rcd_collection.rcdfiles) {
-		const char *fname = entry.second.path.c_str();
-		const char *mesg = this->Load(fname);
-		if (mesg != nullptr) fprintf(stderr, "Error while reading \"%s\": %s\n", fname, mesg);
+	std::vector<const char *> fnames;
+	for (auto &entry : _rcd_collection.rcdfiles) fnames.push_back(entry.second.path.c_str());
+
+	std::vector<RcdFileImages> images(fnames.size());
+	_worker_pool.Run(fnames.size(), [&fnames, &images](uint i) { images[i].Decode(fnames[i]); });
+
+	for (uint i = 0; i < fnames.size(); i++) {
+		const char *mesg = this->Load(fnames[i], &images[i]);
+		if (mesg != nullptr) fprintf(stderr, "Error while reading \"%s\": %s\n", fnames[i], mesg);
 	}
+	GenerateZoomedImages();
 }
 
 /**
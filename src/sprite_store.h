@@ -24,6 +24,7 @@ extern const uint8 _slope_rotation[NUM_SLOPE_SPRITES][4];
 
 class RcdFileReader;
 class ImageData;
+class RcdFileImages;
 
 /**
  * Block of data from a RCD file.
@@ -668,7 +669,7 @@ public:
 	PathStatus GetPathStatus(PathType path_type);
 
 protected:
-	const char *Load(const char *fname);
+	const char *Load(const char *fname, RcdFileImages *images = nullptr);
 	SpriteStorage *GetSpriteStore(uint16 width);
 
 	RcdBlock *blocks;         ///< List of loaded RCD data blocks.
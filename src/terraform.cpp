@@ -14,6 +14,8 @@
 #include "gamecontrol.h"
 #include "math_func.h"
 #include "memory.h"
+#include "path_finding.h"
+#include "replay.h"
 
 /**
  * Structure describing a corner at a voxel stack.
@@ -469,6 +471,7 @@ bool TerrainChanges::ModifyWorld(int direction)
 	}
 
 	/* Second iteration: Change the ground of the tiles. */
+	InvalidatePathDistances(); // Paths at the park border may be at a different height.
 	for (auto &iter : this->changes) {
 		const Point16 &pos = iter.first;
 		const GroundData &gd = iter.second;
@@ -576,6 +579,7 @@ bool TerrainChanges::ModifyWorld(int direction)
 void ChangeTileCursorMode(const Point16 &voxel_pos, CursorType ctype, bool levelling, int direction, bool dot_mode)
 {
 	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(voxel_pos.x, voxel_pos.y) != OWN_PARK) return;
+	_replay.Record(RCT_TERRAFORM_TILE, {voxel_pos.x, voxel_pos.y, ctype, levelling, direction, dot_mode});
 
 	Point16 p;
 	uint16 w, h;
@@ -632,6 +636,7 @@ void ChangeTileCursorMode(const Point16 &voxel_pos, CursorType ctype, bool level
  */
 void ChangeAreaCursorMode(const Rectangle16 &orig_area, bool levelling, int direction)
 {
+	_replay.Record(RCT_TERRAFORM_AREA, {orig_area.base.x, orig_area.base.y, orig_area.width, orig_area.height, levelling, direction});
 	Point16 p;
 
 	Rectangle16 area(orig_area); // Restrict area to on-world.
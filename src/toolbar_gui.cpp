@@ -22,6 +22,7 @@
 #include "viewport.h"
 #include "gamecontrol.h"
 #include "weather.h"
+#include "replay.h"
 
 void ShowQuitProgram();
 
@@ -176,9 +177,12 @@ void ToolbarWindow::OnChange(ChangeCode code, uint32 parameter)
 						case DDM_SETTINGS:
 							ShowSettingGui();
 							break;
-						case DDM_GAME_MODE:
-							_game_mode_mgr.SetGameMode(_game_mode_mgr.InEditorMode() ? GM_PLAY : GM_EDITOR);
+						case DDM_GAME_MODE: {
+							GameMode mode = _game_mode_mgr.InEditorMode() ? GM_PLAY : GM_EDITOR;
+							_replay.Record(RCT_SET_GAME_MODE, {mode});
+							_game_mode_mgr.SetGameMode(mode);
 							break;
+						}
 						case DDM_SAVE:
 							/* \todo Provide option to enter the filename for saving. */
 							_game_control.SaveGame("saved.fct");
@@ -15,6 +15,9 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <climits>
 
 UnixDirectoryReader::UnixDirectoryReader() : DirectoryReader('/')
 {
@@ -96,3 +99,79 @@ bool PathIsDirectory(const char *path)
 	return S_ISDIR(st.st_mode);
 }
 
+/**
+ * Rename a file, replacing an existing file with the new name.
+ * @param from Current name of the file.
+ * @param to New name of the file.
+ * @return Whether renaming was successful.
+ * @note The existing file is replaced atomically, it is never missing or incomplete if \a from was synchronized with #SyncFile.
+ */
+bool RenameFile(const char *from, const char *to)
+{
+	return rename(from, to) == 0;
+}
+
+/**
+ * Write the buffered data of an opened file to the storage device.
+ * @param fp File to synchronize.
+ * @return Whether the data was written successfully.
+ */
+bool SyncFile(FILE *fp)
+{
+	return fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+}
+
+/**
+ * Make a path independent of the current working directory.
+ * @param path Path to convert, relative to the current working directory or absolute.
+ * @return Absolute path, or a copy of \a path if the working directory is not known. Caller must free the returned memory.
+ */
+char *MakeAbsolutePath(const char *path)
+{
+	char cwd[PATH_MAX];
+	if (path[0] == '/' || getcwd(cwd, lengthof(cwd)) == nullptr) return StrDup(path);
+
+	size_t cwd_length = strlen(cwd);
+	size_t length = cwd_length + 1 + strlen(path) + 1;
+	char *result = new char[length];
+	memcpy(result, cwd, cwd_length);
+	result[cwd_length] = '/';
+	strcpy(result + cwd_length + 1, path);
+	return result;
+}
+
+/**
+ * Map a file into memory for reading.
+ * @param fname Name of the file to map.
+ * @return Whether the file was mapped successfully. Empty files cannot be mapped.
+ */
+bool MappedFile::Open(const char *fname)
+{
+	this->Close();
+
+	int fd = open(fname, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	void *address = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd); // The mapping stays valid without the file descriptor.
+	if (address == MAP_FAILED) return false;
+
+	this->data = static_cast<const uint8 *>(address);
+	this->size = st.st_size;
+	return true;
+}
+
+/** Remove the mapping of the file, if a file is mapped. */
+void MappedFile::Close()
+{
+	if (this->data == nullptr) return;
+
+	munmap(const_cast<uint8 *>(this->data), this->size);
+	this->data = nullptr;
+	this->size = 0;
+}
+
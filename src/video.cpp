@@ -18,6 +18,8 @@
 #include "gamecontrol.h"
 #include "window.h"
 #include "viewport.h"
+#include "blitter.h"
+#include "sprite_cache.h"
 
 VideoSystem _video;  ///< Video sub-system.
 
@@ -28,6 +30,10 @@ ClippedRectangle::ClippedRectangle()
 	this->absy = 0;
 	this->width = 0;
 	this->height = 0;
+	this->clip_left = 0;
+	this->clip_top = 0;
+	this->clip_right = 0;
+	this->clip_bottom = 0;
 	this->address = nullptr; this->pitch = 0;
 }
 
@@ -44,6 +50,10 @@ ClippedRectangle::ClippedRectangle(uint16 x, uint16 y, uint16 w, uint16 h)
 	this->absy = y;
 	this->width = w;
 	this->height = h;
+	this->clip_left = 0;
+	this->clip_top = 0;
+	this->clip_right = w;
+	this->clip_bottom = h;
 	this->address = nullptr; this->pitch = 0;
 }
 
@@ -54,7 +64,7 @@ ClippedRectangle::ClippedRectangle(uint16 x, uint16 y, uint16 w, uint16 h)
  * @param y Top-left y position.
  * @param w Width.
  * @param h Height.
- * @note %Rectangle is clipped to the old one.
+ * @note %Rectangle is clipped to the old one, including its drawable area.
  */
 ClippedRectangle::ClippedRectangle(const ClippedRectangle &cr, uint16 x, uint16 y, uint16 w, uint16 h)
 {
@@ -63,6 +73,10 @@ ClippedRectangle::ClippedRectangle(const ClippedRectangle &cr, uint16 x, uint16
 		this->absy = 0;
 		this->width = 0;
 		this->height = 0;
+		this->clip_left = 0;
+		this->clip_top = 0;
+		this->clip_right = 0;
+		this->clip_bottom = 0;
 		this->address = nullptr; this->pitch = 0;
 		return;
 	}
@@ -73,9 +87,31 @@ ClippedRectangle::ClippedRectangle(const ClippedRectangle &cr, uint16 x, uint16
 	this->absy = cr.absy + y;
 	this->width = w;
 	this->height = h;
+	this->clip_left   = Clamp(cr.clip_left   - x, 0, (int)w);
+	this->clip_top    = Clamp(cr.clip_top    - y, 0, (int)h);
+	this->clip_right  = Clamp(cr.clip_right  - x, (int)this->clip_left, (int)w);
+	this->clip_bottom = Clamp(cr.clip_bottom - y, (int)this->clip_top,  (int)h);
 	this->address = nullptr; this->pitch = 0;
 }
 
+/**
+ * Construct a clipped rectangle with the same origin as an existing one, but with drawing restricted to an area.
+ * @param cr Existing rectangle.
+ * @param area Area that may be drawn, relative to the top-left of \a cr.
+ */
+ClippedRectangle::ClippedRectangle(const ClippedRectangle &cr, const Rectangle32 &area)
+{
+	this->absx = cr.absx;
+	this->absy = cr.absy;
+	this->width = cr.width;
+	this->height = cr.height;
+	this->clip_left   = Clamp(area.base.x, (int32)cr.clip_left, (int32)cr.clip_right);
+	this->clip_top    = Clamp(area.base.y, (int32)cr.clip_top,  (int32)cr.clip_bottom);
+	this->clip_right  = Clamp(area.base.x + (int32)area.width,  (int32)this->clip_left, (int32)cr.clip_right);
+	this->clip_bottom = Clamp(area.base.y + (int32)area.height, (int32)this->clip_top,  (int32)cr.clip_bottom);
+	this->address = cr.address; this->pitch = cr.pitch;
+}
+
 /**
  * Copy constructor.
  * @param cr Existing clipped rectangle.
@@ -86,6 +122,10 @@ ClippedRectangle::ClippedRectangle(const ClippedRectangle &cr)
 	this->absy = cr.absy;
 	this->width = cr.width;
 	this->height = cr.height;
+	this->clip_left = cr.clip_left;
+	this->clip_top = cr.clip_top;
+	this->clip_right = cr.clip_right;
+	this->clip_bottom = cr.clip_bottom;
 	this->address = cr.address; this->pitch = cr.pitch;
 }
 
@@ -101,6 +141,10 @@ ClippedRectangle &ClippedRectangle::operator=(const ClippedRectangle &cr)
 		this->absy = cr.absy;
 		this->width = cr.width;
 		this->height = cr.height;
+		this->clip_left = cr.clip_left;
+		this->clip_top = cr.clip_top;
+		this->clip_right = cr.clip_right;
+		this->clip_bottom = cr.clip_bottom;
 		this->address = cr.address; this->pitch = cr.pitch;
 	}
 	return *this;
@@ -122,6 +166,8 @@ void ClippedRectangle::ValidateAddress()
 VideoSystem::VideoSystem()
 {
 	this->initialized = false;
+	this->offscreen = false;
+	this->display_resets = 0;
 }
 
 /** Destructor. */
@@ -140,6 +186,7 @@ std::string VideoSystem::Initialize(const char *font_name, int font_size)
 {
 	if (this->initialized) return "";
 
+	SelectBlitter(nullptr);
 	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
 		std::string err = "SDL video initialization failed: ";
 		err += SDL_GetError();
@@ -212,7 +259,7 @@ std::string VideoSystem::Initialize(const char *font_name, int font_size)
 
 	this->font_height = TTF_FontLineSkip(this->font);
 	this->initialized = true;
-	this->dirty = true; // Ensure it gets painted.
+	this->MarkDisplayDirty(); // Ensure it gets painted.
 	this->missing_sprites = false;
 
 	this->digit_size.x = 0;
@@ -222,6 +269,36 @@ std::string VideoSystem::Initialize(const char *font_name, int font_size)
 }
 
 
+/**
+ * Initialize the video system for drawing in memory only, without window and font.
+ * Text cannot be drawn, and the display is never shown.
+ * @param width Width of the display memory.
+ * @param height Height of the display memory.
+ */
+void VideoSystem::InitializeOffscreen(uint16 width, uint16 height)
+{
+	if (this->initialized) return;
+
+	SelectBlitter(nullptr);
+	this->vid_width = width;
+	this->vid_height = height;
+	this->mem = new uint32[this->vid_width * this->vid_height];
+	this->blit_rect = ClippedRectangle(0, 0, this->vid_width, this->vid_height);
+
+	this->window = nullptr;
+	this->renderer = nullptr;
+	this->texture = nullptr;
+	this->font = nullptr;
+	this->font_height = 0;
+	this->offscreen = true;
+	this->initialized = true;
+	this->MarkDisplayDirty();
+	this->missing_sprites = false;
+
+	this->digit_size.x = 0;
+	this->digit_size.y = 0;
+}
+
 /**
  * Change the resolution of the game window, including
  * reinitialising some screen-size related data structures.
@@ -282,23 +359,68 @@ void VideoSystem::GetResolutions()
 /** Mark the entire display as being out of date (it needs the be repainted). */
 void VideoSystem::MarkDisplayDirty()
 {
-	this->dirty = true;
+	this->display_resets++;
+	this->dirty_areas.clear();
+	this->dirty_areas.emplace_back(0, 0, this->vid_width, this->vid_height);
+}
+
+/**
+ * Get the number of pixels in an area.
+ * @param rect Area to examine.
+ * @return Size of the area in pixels.
+ */
+static inline uint32 GetPixelCount(const Rectangle32 &rect)
+{
+	return rect.width * rect.height;
+}
+
+/**
+ * Get the smallest area that contains both given areas.
+ * @param r1 First area.
+ * @param r2 Second area.
+ * @return Bounding area of \a r1 and \a r2.
+ */
+static Rectangle32 GetBoundingArea(const Rectangle32 &r1, const Rectangle32 &r2)
+{
+	int32 left   = std::min(r1.base.x, r2.base.x);
+	int32 top    = std::min(r1.base.y, r2.base.y);
+	int32 right  = std::max(r1.base.x + (int32)r1.width,  r2.base.x + (int32)r2.width);
+	int32 bottom = std::max(r1.base.y + (int32)r1.height, r2.base.y + (int32)r2.height);
+	return Rectangle32(left, top, right - left, bottom - top);
 }
 
 /**
  * Mark the stated area of the screen as being out of date.
+ * Areas are merged with already marked areas as long as that does not cause many needless pixels to be painted.
  * @param rect %Rectangle which is out of date.
- * @todo Keep an administration of the rectangle(s??) to update, and update just that part.
  */
 void VideoSystem::MarkDisplayDirty(const Rectangle32 &rect)
 {
-	this->dirty = true;
-}
+	static const uint MAX_DIRTY_AREAS = 32; ///< Number of areas to keep before falling back to a single bounding area.
 
-/** Mark the display as being up-to-date. */
-void VideoSystem::MarkDisplayClean()
-{
-	this->dirty = false;
+	Rectangle32 area(rect);
+	area.RestrictTo(0, 0, this->vid_width, this->vid_height);
+	if (area.width == 0 || area.height == 0) return;
+
+	uint i = 0;
+	while (i < this->dirty_areas.size()) {
+		Rectangle32 merged = GetBoundingArea(this->dirty_areas[i], area);
+		if (GetPixelCount(merged) > GetPixelCount(this->dirty_areas[i]) + GetPixelCount(area)) {
+			i++;
+			continue;
+		}
+		/* Merging is cheaper than painting both areas separately. */
+		area = merged;
+		this->dirty_areas[i] = this->dirty_areas.back();
+		this->dirty_areas.pop_back();
+		i = 0; // The bigger area may absorb other areas as well.
+	}
+
+	if (this->dirty_areas.size() >= MAX_DIRTY_AREAS) {
+		for (const Rectangle32 &r : this->dirty_areas) area = GetBoundingArea(area, r);
+		this->dirty_areas.clear();
+	}
+	this->dirty_areas.push_back(area);
 }
 
 /**
@@ -347,6 +469,10 @@ static bool HandleKeyInput(WmKeyCode key_code, const uint8 *symbol)
 	} else if (key_code == WMKC_SYMBOL) {
 		if (symbol[0] == '1') {
 			_window_manager.GetViewport()->ToggleUndergroundMode();
+		} else if (symbol[0] == '-') {
+			_window_manager.GetViewport()->Zoom(1);
+		} else if (symbol[0] == '+' || symbol[0] == '=') {
+			_window_manager.GetViewport()->Zoom(-1);
 		} else if (symbol[0] == 'q') {
 			_game_control.QuitGame();
 			return true;
@@ -442,15 +568,13 @@ bool VideoSystem::HandleEvent()
 /** Main loop. Loops until told not to. */
 void VideoSystem::MainLoop()
 {
-	static const uint32 FRAME_DELAY = 30; // Number of milliseconds between two frames.
 	bool missing_sprites_check = false;
+	FrameScheduler scheduler;
 
 	for (;;) {
-		uint32 start = SDL_GetTicks();
-
-		OnNewFrame(FRAME_DELAY);
+		scheduler.Run();
 
-		/* Handle input events until time for the next frame has arrived. */
+		/* Handle the pending input events. */
 		for (;;) {
 			if (HandleEvent()) break;
 		}
@@ -459,11 +583,8 @@ void VideoSystem::MainLoop()
 		_game_control.DoNextAction();
 		if (!_game_control.running) break;
 
-		uint32 now = SDL_GetTicks();
-		if (now >= start) { // No wrap around.
-			now -= start;
-			if (now < FRAME_DELAY) SDL_Delay(FRAME_DELAY - now); // Too early, wait until next frame.
-		}
+		uint32 delay = scheduler.GetDelay();
+		if (delay > 0) SDL_Delay(delay); // Wait until the next tick or frame is due.
 
 		if (!missing_sprites_check && this->missing_sprites) {
 			ShowGraphicsErrorMessage();
@@ -476,27 +597,36 @@ void VideoSystem::MainLoop()
 void VideoSystem::Shutdown()
 {
 	if (this->initialized) {
-		TTF_CloseFont(this->font);
-		TTF_Quit();
-		SDL_Quit();
+		if (!this->offscreen) {
+			TTF_CloseFont(this->font);
+			TTF_Quit();
+			SDL_Quit();
+		}
 		delete[] this->mem;
 		this->initialized = false;
-		this->dirty = false;
+		this->offscreen = false;
+		this->dirty_areas.clear();
+		this->text_cache.clear();
 	}
 }
 
 /**
- * Finish repainting, perform the final steps.
- * @todo Implement partial window repainting.
+ * Finish repainting, upload the repainted areas to the GPU, and display the result.
+ * @param areas Areas that were repainted, see #TakeDirtyAreas.
  */
-void VideoSystem::FinishRepaint()
+void VideoSystem::FinishRepaint(const std::vector<Rectangle32> &areas)
 {
-	SDL_UpdateTexture(this->texture, nullptr, this->mem, this->GetXSize() * sizeof(uint32)); // Upload memory to the GPU.
+	_sprite_cache.BeginFrame(); // Sprites of the finished frame may be dropped from the cache.
+	if (this->offscreen) return; // Nothing to show.
+
+	for (const Rectangle32 &area : areas) {
+		SDL_Rect sdl_rect = {area.base.x, area.base.y, (int)area.width, (int)area.height};
+		const uint32 *pixels = this->mem + area.base.x + area.base.y * this->GetXSize();
+		SDL_UpdateTexture(this->texture, &sdl_rect, pixels, this->GetXSize() * sizeof(uint32));
+	}
 	SDL_RenderClear(this->renderer);
 	SDL_RenderCopy(this->renderer, this->texture, nullptr, nullptr);
 	SDL_RenderPresent(this->renderer);
-
-	MarkDisplayClean();
 }
 
 /**
@@ -518,14 +648,14 @@ static void BlitPixel(const ClippedRectangle &cr, uint32 *scr_base,
 	const int32 xend = xmin + numx * width;
 	const int32 yend = ymin + numy * height;
 	while (ymin < yend) {
-		if (ymin >= cr.height) return;
+		if (ymin >= cr.clip_bottom) return;
 
-		if (ymin >= 0) {
+		if (ymin >= cr.clip_top) {
 			uint32 *scr = scr_base;
 			int32 x = xmin;
 			while (x < xend) {
-				if (x >= cr.width) break;
-				if (x >= 0) *scr = colour;
+				if (x >= cr.clip_right) break;
+				if (x >= cr.clip_left) *scr = colour;
 
 				x += width;
 				scr += width;
@@ -577,7 +707,7 @@ static void Blit8bppImages(const ClippedRectangle &cr, int32 x_base, int32 y_bas
 			for (;;) {
 				uint8 rel_off = spr->data[offset];
 				uint8 count   = spr->data[offset + 1];
-				uint8 *pixels = &spr->data[offset + 2];
+				const uint8 *pixels = &spr->data[offset + 2];
 				offset += 2 + count;
 
 				xpos += rel_off & 127;
@@ -601,6 +731,129 @@ static void Blit8bppImages(const ClippedRectangle &cr, int32 x_base, int32 y_bas
 	}
 }
 
+/**
+ * Blit a single 32bpp sprite to the screen.
+ * Each run of pixels is clipped once, the clipped pixels of the run are handled by the #_blitter kernels.
+ * @param cr Clipped rectangle to draw to.
+ * @param x_base Base X coordinate of the sprite data.
+ * @param y_base Base Y coordinate of the sprite data.
+ * @param spr The sprite to blit.
+ * @param recolour Sprite recolouring definition.
+ * @param shift Gradient shift.
+ */
+static void Blit32bppSprite(const ClippedRectangle &cr, int32 x_base, int32 y_base, const ImageData *spr, const Recolouring &recolour, GradientShift shift)
+{
+	const bool white = shift == GS_SEMI_TRANSPARENT;
+	const int delta = white ? 0 : (shift - GS_NORMAL) * STEP_SIZE;
+	uint32 colours[64]; // Colours of a run, before blending them with the screen.
+	if (white) std::fill(colours, colours + lengthof(colours), MakeRGBA(255, 255, 255, OPAQUE));
+
+	const uint8 *src = spr->data;
+	int32 ypos = y_base;
+	const int32 yend = std::min<int32>(y_base + spr->height, cr.clip_bottom);
+	for (; ypos < cr.clip_top && ypos < yend; ypos++) src += src[0] | (src[1] << 8); // Skip rows above the clipped area.
+
+	uint32 *line_base = cr.address + cr.pitch * ypos;
+	for (; ypos < yend; ypos++) {
+		src += 2; // Skip the length word.
+		int32 xpos = x_base;
+		for (;;) {
+			uint8 mode = *src++;
+			if (mode == 0) break;
+
+			const int32 count = mode & 0x3F;
+			const int32 first = std::max<int32>(xpos, cr.clip_left);
+			const int32 visible = std::min<int32>(xpos + count, cr.clip_right) - first; // Number of pixels to draw, may be negative.
+			const int32 skip = first - xpos;
+			uint32 *dest = line_base + first;
+			switch (mode >> 6) {
+				case 0: // Fully opaque pixels.
+					if (visible > 0) {
+						if (white) {
+							_blitter.blend(dest, colours, visible, OPACITY_SEMI_TRANSPARENT);
+						} else {
+							_blitter.expand_rgb(dest, src + 3 * skip, visible);
+							if (delta != 0) _blitter.shift(dest, visible, delta);
+						}
+					}
+					src += 3 * count;
+					break;
+
+				case 1: { // Partial opaque pixels.
+					uint8 opacity = *src++;
+					if (visible > 0) {
+						if (white) {
+							opacity = std::min<uint8>(opacity, OPACITY_SEMI_TRANSPARENT);
+						} else {
+							_blitter.expand_rgb(colours, src + 3 * skip, visible);
+							if (delta != 0) _blitter.shift(colours, visible, delta);
+						}
+						_blitter.blend(dest, colours, visible, opacity);
+					}
+					src += 3 * count;
+					break;
+				}
+				case 2: // Fully transparent pixels.
+					break;
+
+				case 3: { // Recoloured pixels.
+					uint8 layer = *src++;
+					uint8 opacity = *src++;
+					if (visible > 0) {
+						if (white) {
+							opacity = std::min<uint8>(opacity, OPACITY_SEMI_TRANSPARENT);
+						} else {
+							_blitter.recolour(colours, src + skip, visible, recolour.GetRecolourTable(layer - 1));
+							if (delta != 0) _blitter.shift(colours, visible, delta);
+						}
+						_blitter.blend(dest, colours, visible, opacity);
+					}
+					src += count;
+					break;
+				}
+			}
+			xpos += count;
+		}
+		line_base += cr.pitch;
+	}
+}
+
+/**
+ * Blit a decoded sprite to the screen.
+ * Only the pixels of the clipped area are written, and no state of the video system is used,
+ * so sprites can be blitted concurrently to disjoint areas of the screen.
+ * @param cr Clipped rectangle to draw to, its address must be valid.
+ * @param x_base Base X coordinate of the sprite data.
+ * @param y_base Base Y coordinate of the sprite data.
+ * @param spr The decoded sprite to blit.
+ */
+void BlitDecodedSprite(const ClippedRectangle &cr, int32 x_base, int32 y_base, const DecodedSprite &spr)
+{
+	int32 ypos = std::max<int32>(y_base, cr.clip_top);
+	const int32 yend = std::min<int32>(y_base + spr.height, cr.clip_bottom);
+	uint32 *line_base = cr.address + cr.pitch * ypos;
+	for (; ypos < yend; ypos++) {
+		const uint32 last_span = spr.row_starts[ypos - y_base + 1];
+		for (uint32 i = spr.row_starts[ypos - y_base]; i < last_span; i++) {
+			const DecodedSpan &span = spr.spans[i];
+			const int32 xpos = x_base + span.x;
+			if (xpos >= cr.clip_right) break;
+
+			const int32 first = std::max<int32>(xpos, cr.clip_left);
+			const int32 visible = std::min<int32>(xpos + span.count, cr.clip_right) - first;
+			if (visible <= 0) continue;
+
+			const uint32 *pixels = &spr.pixels[span.first + first - xpos];
+			if (span.blend) {
+				_blitter.blend(line_base + first, pixels, visible, span.opacity);
+			} else {
+				std::copy(pixels, pixels + visible, line_base + first);
+			}
+		}
+		line_base += cr.pitch;
+	}
+}
+
 /**
  * Blit 32bpp images to the screen.
  * @param cr Clipped rectangle to draw to.
@@ -622,7 +875,7 @@ static void Blit32bppImages(const ClippedRectangle &cr, int32 x_base, int32 y_ba
 		int32 xpos = x_base;
 		uint32 *src_base = line_base;
 		auto is_in_drawing_region = [&cr, &src_base]() {
-			return src_base >= cr.address && src_base < cr.address + cr.width * cr.height;
+			return src_base >= cr.address && src_base < cr.address + cr.pitch * cr.height;
 		};
 		for (;;) {
 			uint8 mode = *src++;
@@ -714,24 +967,81 @@ void VideoSystem::BlitImages(const Point32 &pt, const ImageData *spr, uint16 num
 	int x_base = pt.x + spr->xoffset;
 	int y_base = pt.y + spr->yoffset;
 
-	/* Don't draw wildly outside the screen. */
-	while (numx > 0 && x_base + spr->width < 0) {
+	/* Don't draw wildly outside the drawable area. */
+	while (numx > 0 && x_base + spr->width < this->blit_rect.clip_left) {
 		x_base += spr->width; numx--;
 	}
-	while (numx > 0 && x_base + (numx - 1) * spr->width >= this->blit_rect.width) numx--;
+	while (numx > 0 && x_base + (numx - 1) * spr->width >= this->blit_rect.clip_right) numx--;
 	if (numx == 0) return;
 
-	while (numy > 0 && y_base + spr->height < 0) {
+	while (numy > 0 && y_base + spr->height < this->blit_rect.clip_top) {
 		y_base += spr->height; numy--;
 	}
-	while (numy > 0 && y_base + (numy - 1) * spr->height >= this->blit_rect.height) numy--;
+	while (numy > 0 && y_base + (numy - 1) * spr->height >= this->blit_rect.clip_bottom) numy--;
 	if (numy == 0) return;
 
-	if (GB(spr->flags, IFG_IS_8BPP, 1) != 0) {
+	if (numx == 1 && numy == 1 && _sprite_cache.IsEnabled()) {
+		BlitDecodedSprite(this->blit_rect, x_base, y_base, *_sprite_cache.Get(spr, recolour, shift));
+	} else if (GB(spr->flags, IFG_IS_8BPP, 1) != 0) {
 		Blit8bppImages(this->blit_rect, x_base, y_base, spr, numx, numy, recolour.GetPalette(shift));
 	} else {
-		Blit32bppImages(this->blit_rect, x_base, y_base, spr, numx, numy, recolour, shift);
+		if (numx == 1 && numy == 1) {
+			Blit32bppSprite(this->blit_rect, x_base, y_base, spr, recolour, shift);
+		} else {
+			Blit32bppImages(this->blit_rect, x_base, y_base, spr, numx, numy, recolour, shift);
+		}
+	}
+}
+
+/**
+ * Get a text measured with the font, and rendered if requested.
+ * Texts are cached, as the same texts are drawn at every repaint of the windows.
+ * @param text Text to get.
+ * @param render Whether the pixels of the text are needed.
+ * @return The measured text, or \c nullptr if the font failed. Valid until the next call.
+ */
+VideoSystem::CachedText *VideoSystem::GetCachedText(const uint8 *text, bool render)
+{
+	static const size_t MAX_CACHED_TEXTS = 2048; ///< Number of cached texts before starting over.
+
+	std::string key(reinterpret_cast<const char *>(text));
+	auto iter = this->text_cache.find(key);
+	if (iter == this->text_cache.end()) {
+		int width, height;
+		if (TTF_SizeUTF8(this->font, key.c_str(), &width, &height) != 0) return nullptr;
+
+		/* Changing numbers keep adding new texts, drop all texts once in a while rather than tracking their use. */
+		if (this->text_cache.size() >= MAX_CACHED_TEXTS) this->text_cache.clear();
+		iter = this->text_cache.emplace(key, CachedText()).first;
+		iter->second.width = width;
+		iter->second.height = height;
+	}
+
+	CachedText &ct = iter->second;
+	if (render && !ct.rendered && !key.empty()) {
+		SDL_Color col = {0, 0, 0}; // Font colour does not matter as only the bitmap is used.
+		SDL_Surface *surf = TTF_RenderUTF8_Solid(this->font, key.c_str(), col);
+		if (surf == nullptr) {
+			fprintf(stderr, "Rendering text failed (%s)\n", TTF_GetError());
+			return nullptr;
+		}
+		if (surf->format->BitsPerPixel != 8 || surf->format->BytesPerPixel != 1) {
+			fprintf(stderr, "Rendering text failed (Wrong surface format)\n");
+			SDL_FreeSurface(surf);
+			return nullptr;
+		}
+
+		ct.cover_width = surf->w;
+		ct.cover_rows = surf->h;
+		ct.coverage.resize(surf->w * surf->h);
+		for (int y = 0; y < surf->h; y++) {
+			const uint8 *src = static_cast<const uint8 *>(surf->pixels) + y * surf->pitch;
+			std::copy(src, src + surf->w, &ct.coverage[y * surf->w]);
+		}
+		SDL_FreeSurface(surf);
 	}
+	if (render) ct.rendered = true; // An empty text has nothing to render.
+	return &ct;
 }
 
 /**
@@ -742,10 +1052,14 @@ void VideoSystem::BlitImages(const Point32 &pt, const ImageData *spr, uint16 num
  */
 void VideoSystem::GetTextSize(const uint8 *text, int *width, int *height)
 {
-	if (TTF_SizeUTF8(this->font, (const char *)text, width, height) != 0) {
+	const CachedText *ct = this->GetCachedText(text, false);
+	if (ct == nullptr) {
 		*width = 0;
 		*height = 0;
+		return;
 	}
+	*width = ct->width;
+	*height = ct->height;
 }
 
 /**
@@ -797,19 +1111,10 @@ void VideoSystem::GetNumberRangeSize(int64 smallest, int64 biggest, int *width,
  */
 void VideoSystem::BlitText(const uint8 *text, uint32 colour, int xpos, int ypos, int width, Alignment align)
 {
-	SDL_Color col = {0, 0, 0}; // Font colour does not matter as only the bitmap is used.
-	SDL_Surface *surf = TTF_RenderUTF8_Solid(this->font, (const char *)text, col);
-	if (surf == nullptr) {
-		fprintf(stderr, "Rendering text failed (%s)\n", TTF_GetError());
-		return;
-	}
+	const CachedText *ct = this->GetCachedText(text, true);
+	if (ct == nullptr) return;
 
-	if (surf->format->BitsPerPixel != 8 || surf->format->BytesPerPixel != 1) {
-		fprintf(stderr, "Rendering text failed (Wrong surface format)\n");
-		return;
-	}
-
-	int real_w = std::min(surf->w, width);
+	int real_w = std::min(ct->cover_width, width);
 	switch (align) {
 		case ALG_LEFT:
 			break;
@@ -827,30 +1132,32 @@ void VideoSystem::BlitText(const uint8 *text, uint32 colour, int xpos, int ypos,
 
 	this->blit_rect.ValidateAddress();
 
-	uint8 *src = ((uint8 *)surf->pixels);
+	const uint8 *src = ct->coverage.data();
 	uint32 *dest = this->blit_rect.address + xpos + ypos * this->blit_rect.pitch;
-	int h = surf->h;
-	if (ypos < 0) {
-		h += ypos;
-		src  -= ypos * surf->pitch;
-		dest -= ypos * this->blit_rect.pitch;
-		ypos = 0;
+	int h = ct->cover_rows;
+	const int clip_top = this->blit_rect.clip_top;
+	if (ypos < clip_top) {
+		h -= clip_top - ypos;
+		src  += (clip_top - ypos) * ct->cover_width;
+		dest += (clip_top - ypos) * this->blit_rect.pitch;
+		ypos = clip_top;
 	}
+	const int clip_left = this->blit_rect.clip_left;
 	while (h > 0) {
-		if (ypos >= this->blit_rect.height) break;
-		uint8 *src2 = src;
+		if (ypos >= this->blit_rect.clip_bottom) break;
+		const uint8 *src2 = src;
 		uint32 *dest2 = dest;
 		int w = real_w;
 		int x = xpos;
-		if (x < 0) {
-			w += x;
+		if (x < clip_left) {
+			w -= clip_left - x;
 			if (w <= 0) break;
-			dest2 -= x;
-			src2 -= x;
-			x = 0;
+			dest2 += clip_left - x;
+			src2 += clip_left - x;
+			x = clip_left;
 		}
 		while (w > 0) {
-			if (x >= this->blit_rect.width) break;
+			if (x >= this->blit_rect.clip_right) break;
 			if (*src2 != 0) *dest2 = colour;
 			src2++;
 			dest2++;
@@ -858,12 +1165,10 @@ void VideoSystem::BlitText(const uint8 *text, uint32 colour, int xpos, int ypos,
 			w--;
 		}
 		ypos++;
-		src  += surf->pitch;
+		src  += ct->cover_width;
 		dest += this->blit_rect.pitch;
 		h--;
 	}
-
-	SDL_FreeSurface(surf);
 }
 
 /**
@@ -901,7 +1206,8 @@ void VideoSystem::DrawLine(const Point16 &start, const Point16 &end, uint32 colo
 
 	for (;;) {
 		/* Blit pixel. */
-		if (pos_x >= 0 && pos_x < this->blit_rect.width && pos_y >= 0 && pos_y < this->blit_rect.height) {
+		if (pos_x >= this->blit_rect.clip_left && pos_x < this->blit_rect.clip_right &&
+				pos_y >= this->blit_rect.clip_top && pos_y < this->blit_rect.clip_bottom) {
 			*dest = colour;
 		}
 		if (pos_x == end.x && pos_y == end.y) break;
@@ -947,10 +1253,10 @@ void VideoSystem::FillRectangle(const Rectangle32 &rect, uint32 colour)
 {
 	ClippedRectangle cr = this->GetClippedRectangle();
 
-	int x = Clamp((int)rect.base.x, 0, (int)cr.width);
-	int w = Clamp((int)(rect.base.x + rect.width), 0, (int)cr.width);
-	int y = Clamp((int)rect.base.y, 0, (int)cr.height);
-	int h = Clamp((int)(rect.base.y + rect.height), 0, (int)cr.height);
+	int x = Clamp((int)rect.base.x, (int)cr.clip_left, (int)cr.clip_right);
+	int w = Clamp((int)(rect.base.x + rect.width), (int)cr.clip_left, (int)cr.clip_right);
+	int y = Clamp((int)rect.base.y, (int)cr.clip_top, (int)cr.clip_bottom);
+	int h = Clamp((int)(rect.base.y + rect.height), (int)cr.clip_top, (int)cr.clip_bottom);
 
 	w -= x;
 	h -= y;
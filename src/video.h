@@ -11,12 +11,16 @@
 #define VIDEO_H
 
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include "geometry.h"
 #include "palette.h"
 
 class ImageData;
+struct DecodedSprite;
 
 /** Clipped rectangle. */
 class ClippedRectangle {
@@ -24,6 +28,7 @@ public:
 	ClippedRectangle();
 	ClippedRectangle(uint16 x, uint16 y, uint16 w, uint16 h);
 	ClippedRectangle(const ClippedRectangle &cr, uint16 x, uint16 y, uint16 w, uint16 h);
+	ClippedRectangle(const ClippedRectangle &cr, const Rectangle32 &area);
 
 	ClippedRectangle(const ClippedRectangle &cr);
 	ClippedRectangle &operator=(const ClippedRectangle &cr);
@@ -35,6 +40,11 @@ public:
 	uint16 width;    ///< Number of columns.
 	uint16 height;   ///< Number of rows.
 
+	uint16 clip_left;   ///< First column that may be drawn (relative to #absx).
+	uint16 clip_top;    ///< First row that may be drawn (relative to #absy).
+	uint16 clip_right;  ///< Column after the last column that may be drawn (relative to #absx).
+	uint16 clip_bottom; ///< Row after the last row that may be drawn (relative to #absy).
+
 	uint32 *address; ///< Base address. @note Call #ValidateAddress prior to use.
 	int32 pitch;     ///< Pitch of a row in bytes. @note Call #ValidateAddress prior to use.
 };
@@ -57,6 +67,7 @@ public:
 	~VideoSystem();
 
 	std::string Initialize(const char *font_name, int font_size);
+	void InitializeOffscreen(uint16 width, uint16 height);
 	bool SetResolution(const Point32 &res);
 	void GetResolutions();
 	void MainLoop();
@@ -88,12 +99,31 @@ public:
 	 */
 	inline bool DisplayNeedsRepaint()
 	{
-		return this->dirty;
+		return !this->dirty_areas.empty();
+	}
+
+	/**
+	 * Take the areas of the display that need to be repainted. Areas marked dirty afterwards are kept for the next repaint.
+	 * @param areas Receives the screen areas that are out of date.
+	 */
+	inline void TakeDirtyAreas(std::vector<Rectangle32> *areas)
+	{
+		areas->clear();
+		areas->swap(this->dirty_areas);
 	}
 
 	void MarkDisplayDirty();
 	void MarkDisplayDirty(const Rectangle32 &rect);
 
+	/**
+	 * Get the number of times the entire display was marked dirty, for detecting changes that need a complete repaint.
+	 * @return Number of calls of #MarkDisplayDirty without area.
+	 */
+	inline uint32 GetDisplayResetCount() const
+	{
+		return this->display_resets;
+	}
+
 	void SetClippedRectangle(const ClippedRectangle &cr);
 	ClippedRectangle GetClippedRectangle();
 
@@ -137,7 +167,7 @@ public:
 
 	void BlitImages(const Point32 &pt, const ImageData *spr, uint16 numx, uint16 numy, const Recolouring &recolour, GradientShift shift = GS_NORMAL);
 
-	void FinishRepaint();
+	void FinishRepaint(const std::vector<Rectangle32> &areas);
 
 	/**
 	 * Get the height of a line of text.
@@ -159,11 +189,25 @@ public:
 	std::set<Point32> resolutions; ///< Set (for automatic sorting) of available resolutions.
 
 private:
+	/** Text measured and rendered with the font. */
+	struct CachedText {
+		int width;       ///< Width of the text in pixels.
+		int height;      ///< Height of the text in pixels.
+		bool rendered;   ///< Whether the text has been rendered into #coverage.
+		int cover_width; ///< Number of pixels in a row of #coverage.
+		int cover_rows;  ///< Number of rows of #coverage.
+		std::vector<uint8> coverage; ///< Pixels of the rendered text row by row, non-zero for the pixels of the text.
+	};
+
+	CachedText *GetCachedText(const uint8 *text, bool render);
+
 	int vid_width;    ///< Width of the application window.
 	int vid_height;   ///< Height of the application window.
 	int font_height;  ///< Height of a line of text in pixels.
 	bool initialized; ///< Video system is initialized.
-	bool dirty;       ///< Video display needs being repainted.
+	bool offscreen;   ///< Video system only draws in memory, there is no window or font.
+	std::vector<Rectangle32> dirty_areas; ///< Areas of the display that need being repainted.
+	uint32 display_resets;                ///< Number of times the entire display was marked dirty.
 
 	TTF_Font *font;             ///< Opened text font.
 	SDL_Window *window;         ///< %Window of the application.
@@ -172,11 +216,13 @@ private:
 	uint32 *mem;                ///< Memory used for blitting the application display.
 	ClippedRectangle blit_rect; ///< %Rectangle to blit in.
 	Point16 digit_size;         ///< Size of largest digit (initially a zero-size).
+	std::unordered_map<std::string, CachedText> text_cache; ///< Texts measured and rendered with the font, by their contents.
 
 	bool HandleEvent();
-	void MarkDisplayClean();
 };
 
+void BlitDecodedSprite(const ClippedRectangle &cr, int32 x_base, int32 y_base, const DecodedSprite &spr);
+
 extern VideoSystem _video;
 extern const uint32 _icon_data[32][32];
 
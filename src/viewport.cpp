@@ -24,8 +24,13 @@
 #include "person.h"
 #include "weather.h"
 #include "fence.h"
+#include "sprite_cache.h"
+#include "worker_pool.h"
 
-#include <set>
+#include <algorithm>
+#include <vector>
+
+static const uint16 SPRITE_TILE_WIDTH = 64; ///< Tile width of the loaded sprites, the sprites of the other zoom levels are made from them.
 
 /**
  * \page the_world_page World
@@ -94,6 +99,40 @@ static inline int32 ComputeYFunction(int32 x, int32 y, int32 z, ViewOrientation
 	}
 }
 
+/**
+ * Division rounding towards negative infinity.
+ * @param num Numerator.
+ * @param denom Denominator, must be positive.
+ * @return Largest integer not bigger than \a num / \a denom.
+ */
+static inline int32 FloorDivide(int32 num, int32 denom)
+{
+	return (num >= 0) ? num / denom : -((-num + denom - 1) / denom);
+}
+
+/**
+ * Limit a range of voxel columns to the columns with a screen coordinate inside an open interval.
+ * The screen coordinate of column \c c is \a base + \c c * \a step.
+ * @param base Screen coordinate of column \c 0.
+ * @param step Change of the screen coordinate from one column to the next, non-zero.
+ * @param low The screen coordinate must be bigger than this value.
+ * @param high The screen coordinate must be smaller than this value.
+ * @param [inout] first First column of the range, may be increased.
+ * @param [inout] last Last column of the range, may be decreased.
+ */
+static void LimitColumnRange(int32 base, int32 step, int32 low, int32 high, int32 *first, int32 *last)
+{
+	if (step < 0) { // Mirror the coordinates to get a rising screen coordinate.
+		base = -base;
+		step = -step;
+		std::swap(low, high);
+		low = -low;
+		high = -high;
+	}
+	*first = std::max(*first, FloorDivide(low - base, step) + 1);
+	*last = std::min(*last, -FloorDivide(base - high, step) - 1);
+}
+
 /**
  * Search the world for voxels to render.
  * @ingroup viewport_group
@@ -106,6 +145,7 @@ public:
 	void SetWindowSize(int16 xpos, int16 ypos, uint16 width, uint16 height);
 
 	void Collect();
+	bool GetVisibleColumns(uint xpos, int32 *first, int32 *last);
 	void SetSelector(MouseModeSelector *selector);
 
 	/**
@@ -134,8 +174,9 @@ public:
 	XYZPoint32 view_pos;          ///< Position of the centre point of the display.
 	uint16 tile_width;            ///< Width of a tile.
 	uint16 tile_height;           ///< Height of a tile.
+	uint8 zoom;                   ///< Zoom level of the sprites.
 	ViewOrientation orient;       ///< Direction of view.
-	const SpriteStorage *sprites; ///< Sprite collection of the right size.
+	const SpriteStorage *sprites; ///< Sprite collection, use #ImageData::GetZoomed for the sprites of the zoom level.
 	Viewport *vp;                 ///< Parent viewport for accessing the cursors if not \c nullptr.
 	MouseModeSelector *selector;  ///< Mouse mode selector.
 	bool underground_mode;        ///< Whether to draw underground mode sprites (else draw normal surface sprites).
@@ -190,6 +231,15 @@ struct DrawData {
 		this->highlight = highlight;
 	}
 
+	/**
+	 * Is the sprite of a voxel object? These sprites move around, and are not part of the static layer.
+	 * @return Whether the sprite is a moving sprite.
+	 */
+	inline bool IsMoving() const
+	{
+		return this->order == SO_PERSON;
+	}
+
 	int32 level;                 ///< Slice of this sprite (vertical row).
 	uint16 z_height;             ///< Height of the voxel being drawn.
 	SpriteOrder order;           ///< Selection when to draw this sprite (sorts sprites within a voxel). @see SpriteOrder
@@ -215,9 +265,82 @@ inline bool operator<(const DrawData &dd1, const DrawData &dd2)
 
 /**
  * Collection of sprites to render to the screen.
+ * The list is kept between redraws to avoid allocating memory for every sprite on every redraw. Sprites are added in
+ * any order, #Sort then orders them like #operator<(const DrawData &, const DrawData &), where sprites that compare
+ * equal stay in the order of adding.
  * @ingroup viewport_group
  */
-typedef std::multiset<DrawData> DrawImages;
+class DrawImages {
+public:
+	/** Remove all sprites, while keeping the memory for the next redraw. */
+	inline void Clear()
+	{
+		this->images.clear();
+		this->keys.clear();
+	}
+
+	/**
+	 * Add a sprite to draw.
+	 * @param dd Drawing data of the sprite.
+	 */
+	inline void Add(const DrawData &dd)
+	{
+		DrawKey key;
+		key.key = (static_cast<uint64>(static_cast<uint32>(dd.level) ^ 0x80000000u) << 32) | (static_cast<uint64>(dd.z_height) << 16) | static_cast<uint16>(dd.order);
+		key.base_y = dd.base.y;
+		key.index = this->images.size();
+		this->keys.push_back(key);
+		this->images.push_back(dd);
+	}
+
+	/** Sort the sprites in drawing order. */
+	inline void Sort()
+	{
+		std::sort(this->keys.begin(), this->keys.end());
+	}
+
+	/**
+	 * Get the number of sprites to draw.
+	 * @return Number of sprites.
+	 */
+	inline uint Count() const
+	{
+		return this->images.size();
+	}
+
+	/**
+	 * Get a sprite to draw.
+	 * @param i Index of the sprite in drawing order (after #Sort).
+	 * @return The drawing data of the sprite.
+	 */
+	inline const DrawData &Get(uint i) const
+	{
+		return this->images[this->keys[i].index];
+	}
+
+private:
+	/** Sort key of a sprite. */
+	struct DrawKey {
+		uint64 key;   ///< Slice (with flipped sign bit), height, and sprite order of the sprite, packed in sorting order.
+		int32 base_y; ///< Vertical position of the sprite.
+		uint32 index; ///< Index of the sprite in #images.
+
+		/**
+		 * Sort predicate of the sprites, equal to #operator<(const DrawData &, const DrawData &) with the order of adding as last criterium.
+		 * @param other Key to compare with.
+		 * @return \c true if this sprite should be drawn before \a other.
+		 */
+		inline bool operator<(const DrawKey &other) const
+		{
+			if (this->key != other.key) return this->key < other.key;
+			if (this->base_y != other.base_y) return this->base_y < other.base_y;
+			return this->index < other.index;
+		}
+	};
+
+	std::vector<DrawData> images; ///< Sprites to draw, in order of adding.
+	std::vector<DrawKey> keys;    ///< Sort keys of the sprites.
+};
 
 /**
  * Collect sprites to draw in a viewport.
@@ -230,7 +353,17 @@ public:
 
 	void SetXYOffset(int16 xoffset, int16 yoffset);
 
-	DrawImages draw_images; ///< Sprites to draw ordered by viewing distance.
+	/**
+	 * Add a sprite to draw, at the size of the zoom level.
+	 * @param dd Drawing data of the sprite.
+	 */
+	inline void AddImage(DrawData dd)
+	{
+		if (dd.sprite != nullptr) dd.sprite = dd.sprite->GetZoomed(this->zoom);
+		this->draw_images.Add(dd);
+	}
+
+	DrawImages &draw_images; ///< Sprites to draw, ordered by viewing distance after sorting.
 	int16 xoffset; ///< Horizontal offset of the top-left coordinate to the top-left of the display.
 	int16 yoffset; ///< Vertical offset of the top-left coordinate to the top-left of the display.
 
@@ -247,24 +380,46 @@ protected:
 };
 
 /**
- * Find the sprite and pixel under the mouse cursor.
+ * Sprite that may be found under the mouse cursor, while searching.
+ * @ingroup viewport_group
+ */
+struct FoundSprite {
+	DrawData data;    ///< Drawing data for finding the closest sprite, with the negated screen position of the voxel or person as base.
+	HitSprite hit;    ///< Sprite and its voxel.
+	Rectangle32 area; ///< Part of the window where the sprite may be found, relative to the origin of the world.
+};
+
+/**
+ * Find the sprites that may be under the pixels of a window.
  * @ingroup viewport_group
  */
 class PixelFinder : public VoxelCollector {
 public:
-	PixelFinder(Viewport *vp, FinderData *fdata);
+	PixelFinder(Viewport *vp, ClickableSprite allowed);
 	~PixelFinder();
 
-	ClickableSprite allowed; ///< Sprite types looking for.
-	bool found;              ///< Found a match.
-	DrawData data;           ///< Drawing data of the match found so far.
-	uint32 pixel;            ///< Pixel colour of the closest sprite.
-	FinderData *fdata;       ///< Finder data to return.
+	bool FindPixel(SpriteOrder *order, uint32 *pixel, FinderData *fdata) const;
+
+	ClickableSprite allowed;          ///< Sprite types looking for.
+	std::vector<FoundSprite> found; ///< Sprites that may be found, in order of examining.
 
 protected:
 	void CollectVoxel(const Voxel *vx, const XYZPoint16 &voxel_pos, int32 xnorth, int32 ynorth) override;
+	void AddSprite(const Rectangle32 &voxel_area, const DrawData &dd, const ImageData *spr, int32 xpos, int32 ypos, const XYZPoint16 &voxel_pos,
+			uint16 ride = INVALID_RIDE_INSTANCE, const Person *person = nullptr);
 };
 
+/**
+ * Is a pixel of a sprite found?
+ * @param order Kind of sprite.
+ * @param pixel Colour of the pixel.
+ * @return Whether the pixel belongs to the sprite.
+ */
+static inline bool IsFoundPixel(SpriteOrder order, uint32 pixel)
+{
+	return ((order & CS_MASK) == CS_GROUND_EDGE) ? pixel != 0 : GetA(pixel) != TRANSPARENT;
+}
+
 /**
  * Base class constructor.
  * @param vp %Viewport querying the voxel information.
@@ -277,10 +432,11 @@ VoxelCollector::VoxelCollector(Viewport *vp)
 	this->view_pos = vp->view_pos;
 	this->tile_width = vp->tile_width;
 	this->tile_height = vp->tile_height;
+	this->zoom = vp->zoom;
 	this->orient = vp->orientation;
 	this->underground_mode = vp->underground_mode;
 
-	this->sprites = _sprite_manager.GetSprites(this->tile_width);
+	this->sprites = _sprite_manager.GetSprites(SPRITE_TILE_WIDTH);
 	assert(this->sprites != nullptr);
 }
 
@@ -313,17 +469,47 @@ void VoxelCollector::SetSelector(MouseModeSelector *selector)
 	this->selector = selector;
 }
 
+/**
+ * Compute the voxel columns of a row of the world that may be visible in the window.
+ * The screen position of the north corner of a column changes linearly with the y coordinate, which is inverted to get the columns
+ * horizontally inside the window, and vertically inside the window for some height of the world.
+ * @param xpos X coordinate of the row of voxel columns.
+ * @param [out] first First y coordinate of the columns that may be visible.
+ * @param [out] last Last y coordinate of the columns that may be visible.
+ * @return Whether any column of the row may be visible.
+ */
+bool VoxelCollector::GetVisibleColumns(uint xpos, int32 *first, int32 *last)
+{
+	int32 world_x = (xpos + ((this->orient == VOR_SOUTH || this->orient == VOR_WEST) ? 1 : 0)) * 256;
+	int32 world_y = ((this->orient == VOR_SOUTH || this->orient == VOR_EAST) ? 1 : 0) * 256;
+	*first = 0;
+	*last = _world.GetYSize() - 1;
+
+	int32 base_x = this->ComputeX(world_x, world_y);
+	LimitColumnRange(base_x, this->ComputeX(world_x, world_y + 256) - base_x,
+			this->rect.base.x - this->tile_width / 2, this->rect.base.x + this->rect.width + this->tile_width / 2, first, last);
+
+	/* Lower voxels are drawn lower at the screen, the highest possible voxel gives the margin below the window. */
+	int32 base_y = this->ComputeY(world_x, world_y, 0);
+	LimitColumnRange(base_y, this->ComputeY(world_x, world_y + 256, 0) - base_y,
+			this->rect.base.y - this->tile_width / 2 - this->tile_height,
+			this->rect.base.y + this->rect.height + this->tile_height + (WORLD_Z_SIZE - 1) * this->tile_height, first, last);
+	return *first <= *last;
+}
+
 /**
  * Perform the collecting cycle.
- * This part walks over the voxels, and call #CollectVoxel for each useful voxel.
+ * This part walks over the voxels that may be visible, and call #CollectVoxel for each useful voxel.
  * A derived class may then inspect the voxel in more detail.
- * @todo Do this less stupid. Walking the whole world is not going to work in general.
  */
 void VoxelCollector::Collect()
 {
 	for (uint xpos = 0; xpos < _world.GetXSize(); xpos++) {
+		int32 first, last;
+		if (!this->GetVisibleColumns(xpos, &first, &last)) continue;
+
 		int32 world_x = (xpos + ((this->orient == VOR_SOUTH || this->orient == VOR_WEST) ? 1 : 0)) * 256;
-		for (uint ypos = 0; ypos < _world.GetYSize(); ypos++) {
+		for (uint ypos = first; ypos <= (uint)last; ypos++) {
 			int32 world_y = (ypos + ((this->orient == VOR_SOUTH || this->orient == VOR_EAST) ? 1 : 0)) * 256;
 			int32 north_x = ComputeX(world_x, world_y);
 			if (north_x + this->tile_width / 2 <= (int32)this->rect.base.x) continue; // Right of voxel column is at left of window.
@@ -361,9 +547,9 @@ void VoxelCollector::Collect()
  * Constructor of sprites collector.
  * @param vp %Viewport that needs the sprites.
  */
-SpriteCollector::SpriteCollector(Viewport *vp) : VoxelCollector(vp)
+SpriteCollector::SpriteCollector(Viewport *vp) : VoxelCollector(vp), draw_images(*vp->draw_images)
 {
-	this->draw_images.clear();
+	this->draw_images.Clear();
 	this->xoffset = 0;
 	this->yoffset = 0;
 
@@ -500,13 +686,13 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		DrawData dd;
 		dd.Set(slice, voxel_pos.z, SO_PATH, this->sprites->GetPathSprite(GetPathType(instance_data), GetImplodedPathSlope(instance_data), this->orient),
 				north_point, nullptr, highlight);
-		this->draw_images.insert(dd);
+		this->AddImage(dd);
 	} else if (sri >= SRI_FULL_RIDES) { // A normal ride.
 		DrawData dd[4];
 		int count = DrawRide(slice, voxel_pos, north_point, this->orient, sri, instance_data, dd, &platform_shape);
 		for (int i = 0; i < count; i++) {
 			dd[i].highlight = highlight;
-			this->draw_images.insert(dd[i]);
+			this->AddImage(dd[i]);
 		}
 	}
 
@@ -527,7 +713,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_FOUNDATION, img, north_point);
-				this->draw_images.insert(dd);
+				this->AddImage(dd);
 			}
 		}
 		if (se != 0) {
@@ -535,7 +721,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_FOUNDATION, img, north_point);
-				this->draw_images.insert(dd);
+				this->AddImage(dd);
 			}
 		}
 	}
@@ -547,7 +733,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		uint8 type = (this->underground_mode) ? GTP_UNDERGROUND : voxel->GetGroundType();
 		DrawData dd;
 		dd.Set(slice, voxel_pos.z, SO_GROUND, this->sprites->GetSurfaceSprite(type, slope, this->orient), north_point);
-		this->draw_images.insert(dd);
+		this->AddImage(dd);
 		switch (slope) {
 			// XXX There are no sprites for partial support of a platform.
 			case SL_FLAT:
@@ -590,7 +776,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 						this->sprites->GetFenceSprite(fence_type, edge, gslope, this->orient), north_point);
 				if (IsImplodedSteepSlope(gslope) && !IsImplodedSteepSlopeTop(gslope)) dd.z_height++;
 				if (GB(fences, 16 + edge, 1) != 0) dd.highlight = true;
-				this->draw_images.insert(dd);
+				this->AddImage(dd);
 			}
 		}
 	}
@@ -604,7 +790,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_CURSOR, mspr, north_point);
 				if (ctype >= CUR_TYPE_EDGE_NE && ctype <= CUR_TYPE_EDGE_NW && IsImplodedSteepSlope(gslope) && !IsImplodedSteepSlopeTop(gslope)) dd.z_height++;
-				this->draw_images.insert(dd);
+				this->AddImage(dd);
 			}
 		}
 	}
@@ -623,7 +809,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		if (pl_spr != nullptr) {
 			DrawData dd;
 			dd.Set(slice, voxel_pos.z, SO_PLATFORM, pl_spr, north_point);
-			this->draw_images.insert(dd);
+			this->AddImage(dd);
 		}
 
 		/* XXX Use the shape to draw handle bars. */
@@ -657,7 +843,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, height, SO_SUPPORT, img, Point32(north_point.x, north_point.y + yoffset));
-				this->draw_images.insert(dd);
+				this->AddImage(dd);
 			}
 		}
 	}
@@ -674,7 +860,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			            north_point.y + this->north_offsets[this->orient].y + y_off);
 			DrawData dd;
 			dd.Set(slice, voxel_pos.z, SO_PERSON, anim_spr, pos, recolour);
-			this->draw_images.insert(dd);
+			this->AddImage(dd);
 		}
 		vo = vo->next_object;
 	}
@@ -697,24 +883,17 @@ FinderData::FinderData(ClickableSprite allowed, GroundTilePart select)
 	assert(select != FW_EDGE || (allowed & SO_GROUND) == 0);
 	assert(select == FW_EDGE || (allowed & SO_GROUND_EDGE) == 0);
 
-	// Other data is initialized in PixelFinder::PixelFinder, or Viewport::ComputeCursorPosition.
+	// Other data is initialized in Viewport::ComputeCursorPosition.
 }
 
 /**
  * Constructor of the tile position finder.
  * @param vp %Viewport that needs the tile position.
- * @param fdata Finder data.
+ * @param allowed Sprite types looking for.
  */
-PixelFinder::PixelFinder(Viewport *vp, FinderData *fdata) : VoxelCollector(vp)
+PixelFinder::PixelFinder(Viewport *vp, ClickableSprite allowed) : VoxelCollector(vp)
 {
-	this->allowed = fdata->allowed;
-	this->found = false;
-	this->pixel = _palette[0]; // 0 is transparent, and is not used in sprites.
-	this->fdata = fdata;
-
-	fdata->voxel_pos = XYZPoint16(0, 0, 0);
-	fdata->person = nullptr;
-	fdata->ride   = INVALID_RIDE_INSTANCE;
+	this->allowed = allowed;
 }
 
 PixelFinder::~PixelFinder()
@@ -722,7 +901,35 @@ PixelFinder::~PixelFinder()
 }
 
 /**
- * Find the closest sprite.
+ * Add a sprite that may be found.
+ * @param voxel_area Part of the window where the voxel of the sprite is examined.
+ * @param dd Drawing data of the sprite.
+ * @param spr Sprite to examine.
+ * @param xpos Horizontal screen position of the origin of the sprite.
+ * @param ypos Vertical screen position of the origin of the sprite.
+ * @param voxel_pos Position of the voxel of the sprite.
+ * @param ride Ride instance of the sprite, if any.
+ * @param person Person of the sprite, if any.
+ */
+void PixelFinder::AddSprite(const Rectangle32 &voxel_area, const DrawData &dd, const ImageData *spr, int32 xpos, int32 ypos, const XYZPoint16 &voxel_pos,
+		uint16 ride, const Person *person)
+{
+	if (spr == nullptr) return;
+	spr = spr->GetZoomed(this->zoom);
+
+	Rectangle32 area(xpos + spr->xoffset, ypos + spr->yoffset, spr->width, spr->height);
+	area.RestrictTo(voxel_area.base.x, voxel_area.base.y, voxel_area.width, voxel_area.height);
+	if (area.width == 0 || area.height == 0) return;
+
+	FoundSprite fs;
+	fs.data = dd;
+	fs.hit = {spr, Point32(xpos + spr->xoffset, ypos + spr->yoffset), dd.order, voxel_pos, ride, person};
+	fs.area = area;
+	this->found.push_back(fs);
+}
+
+/**
+ * Collect the sprites of a voxel that may be found.
  * @param voxel %Voxel to examine, \c nullptr means 'cursor above stack'.
  * @param voxel_pos World position.
  * @param xnorth X coordinate of the north corner at the display.
@@ -738,20 +945,16 @@ void PixelFinder::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_pos,
 		case 3: slice = -voxel_pos.x + voxel_pos.y; break;
 		default: NOT_REACHED();
 	}
+
+	/* Sprites of the voxel are only found at the pixels where the voxel is examined while collecting for a single pixel. */
+	Rectangle32 voxel_area(xnorth - this->tile_width / 2, ynorth - this->tile_height, this->tile_width, this->tile_width / 2 + 2 * this->tile_height);
+	voxel_area.RestrictTo(this->rect.base.x, this->rect.base.y, this->rect.width, this->rect.height);
+	DrawData dd;
+
 	/* Looking for surface edge? */
 	if ((this->allowed & SO_GROUND_EDGE) != 0 && voxel->GetGroundType() != GTP_INVALID) {
-		const ImageData *spr = this->sprites->GetSurfaceSprite(GTP_CURSOR_EDGE_TEST, voxel->GetGroundSlope(), this->orient);
-		DrawData dd;
-		dd.Set(slice, voxel_pos.z, SO_GROUND_EDGE, nullptr, Point32(this->rect.base.x - xnorth, this->rect.base.y - ynorth));
-		if (spr != nullptr && (!this->found || this->data < dd)) {
-			uint32 pixel = spr->GetPixel(dd.base.x - spr->xoffset, dd.base.y - spr->yoffset);
-			if (pixel != 0) {
-				this->found = true;
-				this->data = dd;
-				this->fdata->voxel_pos = voxel_pos;
-				this->pixel = pixel;
-			}
-		}
+		dd.Set(slice, voxel_pos.z, SO_GROUND_EDGE, nullptr, Point32(-xnorth, -ynorth));
+		this->AddSprite(voxel_area, dd, this->sprites->GetSurfaceSprite(GTP_CURSOR_EDGE_TEST, voxel->GetGroundSlope(), this->orient), xnorth, ynorth, voxel_pos);
 	}
 
 	if (voxel == nullptr) return; // Ignore cursors, they are not clickable.
@@ -759,51 +962,18 @@ void PixelFinder::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_pos,
 	SmallRideInstance number = voxel->GetInstance();
 	if ((this->allowed & CS_RIDE) != 0 && number >= SRI_FULL_RIDES) {
 		/* Looking for a ride? */
-		DrawData dd[4];
-		int count = DrawRide(slice, voxel_pos, Point32(this->rect.base.x - xnorth, this->rect.base.y - ynorth),
-				this->orient, number, voxel->GetInstanceData(), dd, nullptr);
-		for (int i = 0; i < count; i++) {
-			if (!this->found || this->data < dd[i]) {
-				const ImageData *img = dd[i].sprite;
-				uint32 pixel = img->GetPixel(dd[i].base.x - img->xoffset, dd[i].base.y - img->yoffset);
-				if (GetA(pixel) != TRANSPARENT) {
-					this->found = true;
-					this->data = dd[i];
-					this->fdata->voxel_pos = voxel_pos;
-					this->pixel = pixel;
-					this->fdata->ride = number;
-				}
-			}
-		}
+		DrawData ride_dd[4];
+		int count = DrawRide(slice, voxel_pos, Point32(-xnorth, -ynorth), this->orient, number, voxel->GetInstanceData(), ride_dd, nullptr);
+		for (int i = 0; i < count; i++) this->AddSprite(voxel_area, ride_dd[i], ride_dd[i].sprite, xnorth, ynorth, voxel_pos, number);
 	} else if ((this->allowed & CS_PATH) != 0 && HasValidPath(voxel)) {
 		/* Looking for a path? */
 		uint16 instance_data = voxel->GetInstanceData();
-		const ImageData *img = this->sprites->GetPathSprite(GetPathType(instance_data), GetImplodedPathSlope(instance_data), this->orient);
-		DrawData dd;
-		dd.Set(slice, voxel_pos.z, SO_PATH, nullptr, Point32(this->rect.base.x - xnorth, this->rect.base.y - ynorth));
-		if (img != nullptr && (!this->found || this->data < dd)) {
-			uint32 pixel = img->GetPixel(dd.base.x - img->xoffset, dd.base.y - img->yoffset);
-			if (GetA(pixel) != TRANSPARENT) {
-				this->found = true;
-				this->data = dd;
-				this->fdata->voxel_pos = voxel_pos;
-				this->pixel = pixel;
-			}
-		}
+		dd.Set(slice, voxel_pos.z, SO_PATH, nullptr, Point32(-xnorth, -ynorth));
+		this->AddSprite(voxel_area, dd, this->sprites->GetPathSprite(GetPathType(instance_data), GetImplodedPathSlope(instance_data), this->orient), xnorth, ynorth, voxel_pos);
 	} else if ((this->allowed & CS_GROUND) != 0 && voxel->GetGroundType() != GTP_INVALID) {
 		/* Looking for surface? */
-		const ImageData *spr = this->sprites->GetSurfaceSprite(GTP_CURSOR_TEST, voxel->GetGroundSlope(), this->orient);
-		DrawData dd;
-		dd.Set(slice, voxel_pos.z, SO_GROUND, nullptr, Point32(this->rect.base.x - xnorth, this->rect.base.y - ynorth));
-		if (spr != nullptr && (!this->found || this->data < dd)) {
-			uint32 pixel = spr->GetPixel(dd.base.x - spr->xoffset, dd.base.y - spr->yoffset);
-			if (GetA(pixel) != TRANSPARENT) {
-				this->found = true;
-				this->data = dd;
-				this->fdata->voxel_pos = voxel_pos;
-				this->pixel = pixel;
-			}
-		}
+		dd.Set(slice, voxel_pos.z, SO_GROUND, nullptr, Point32(-xnorth, -ynorth));
+		this->AddSprite(voxel_area, dd, this->sprites->GetSurfaceSprite(GTP_CURSOR_TEST, voxel->GetGroundSlope(), this->orient), xnorth, ynorth, voxel_pos);
 	} else if ((this->allowed & CS_PERSON) != 0) {
 		/* Looking for persons? */
 		const VoxelObject *vo = voxel->voxel_objects;
@@ -814,23 +984,40 @@ void PixelFinder::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_pos,
 			const ImageData *anim_spr = this->sprites->GetAnimationSprite(anim_type, pers->frame_index, pers->type, this->orient);
 			int x_off = ComputeX(pers->pix_pos.x, pers->pix_pos.y);
 			int y_off = ComputeY(pers->pix_pos.x, pers->pix_pos.y, pers->pix_pos.z);
-			DrawData dd;
-			dd.Set(slice, voxel_pos.z, SO_PERSON, nullptr, Point32(this->rect.base.x - xnorth - x_off, this->rect.base.y - ynorth - y_off));
-			if (anim_spr && (!this->found || this->data < dd)) {
-				uint32 pixel = anim_spr->GetPixel(dd.base.x - anim_spr->xoffset, dd.base.y - anim_spr->yoffset);
-				if (GetA(pixel) != TRANSPARENT) {
-					this->found = true;
-					this->data = dd;
-					this->fdata->voxel_pos = voxel_pos;
-					this->pixel = pixel;
-					this->fdata->person = pers;
-				}
-			}
+			dd.Set(slice, voxel_pos.z, SO_PERSON, nullptr, Point32(-xnorth - x_off, -ynorth - y_off));
+			this->AddSprite(voxel_area, dd, anim_spr, xnorth + x_off, ynorth + y_off, voxel_pos, INVALID_RIDE_INSTANCE, pers);
 			vo = vo->next_object;
 		}
 	}
 }
 
+/**
+ * Find the closest sprite at the pixel of a window of a single pixel.
+ * @param [out] order Kind of the found sprite.
+ * @param [out] pixel Colour of the found sprite at the pixel.
+ * @param [out] fdata Finder data to return.
+ * @return Whether a sprite was found.
+ */
+bool PixelFinder::FindPixel(SpriteOrder *order, uint32 *pixel, FinderData *fdata) const
+{
+	const FoundSprite *closest = nullptr;
+	for (const FoundSprite &fs : this->found) {
+		if (closest != nullptr && !(closest->data < fs.data)) continue;
+
+		uint32 colour = fs.hit.sprite->GetPixel(this->rect.base.x - fs.hit.pos.x, this->rect.base.y - fs.hit.pos.y);
+		if (!IsFoundPixel(fs.data.order, colour)) continue;
+		closest = &fs;
+		*pixel = colour;
+	}
+	if (closest == nullptr) return false;
+
+	*order = closest->data.order;
+	fdata->voxel_pos = closest->hit.voxel_pos;
+	fdata->ride = closest->hit.ride;
+	fdata->person = closest->hit.person;
+	return true;
+}
+
 /**
  * %Viewport constructor.
  * @param view_pos Pixel position of the center viewpoint of the main display.
@@ -838,8 +1025,9 @@ void PixelFinder::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_pos,
 Viewport::Viewport(const XYZPoint32 &view_pos) : Window(WC_MAINDISPLAY, ALL_WINDOWS_OF_TYPE)
 {
 	this->view_pos = view_pos;
-	this->tile_width  = 64;
-	this->tile_height = 16;
+	this->tile_width  = SPRITE_TILE_WIDTH;
+	this->tile_height = SPRITE_TILE_WIDTH / 4;
+	this->zoom = 0;
 	this->orientation = VOR_NORTH;
 
 	this->mouse_pos.x = 0;
@@ -852,6 +1040,8 @@ Viewport::Viewport(const XYZPoint32 &view_pos) : Window(WC_MAINDISPLAY, ALL_WIND
 
 	this->SetSize(width, height);
 	this->SetPosition(0, 0);
+
+	this->draw_images.reset(new DrawImages);
 }
 
 Viewport::~Viewport()
@@ -864,7 +1054,7 @@ Viewport::~Viewport()
  */
 bool Viewport::IsUndergroundModeAvailable() const
 {
-	const SpriteStorage *storage = _sprite_manager.GetSprites(this->tile_width);
+	const SpriteStorage *storage = _sprite_manager.GetSprites(SPRITE_TILE_WIDTH);
 	return storage->surface[GTP_UNDERGROUND].HasAllSprites();
 }
 
@@ -912,35 +1102,354 @@ int32 Viewport::ComputeY(int32 xpos, int32 ypos, int32 zpos)
 
 void Viewport::OnDraw(MouseModeSelector *selector)
 {
+	ClippedRectangle cr = _video.GetClippedRectangle();
+	assert(this->rect.base.x >= 0 && this->rect.base.y >= 0);
+	ClippedRectangle draw_rect(cr, this->rect.base.x, this->rect.base.y, this->rect.width, this->rect.height);
+	if (draw_rect.clip_left >= draw_rect.clip_right || draw_rect.clip_top >= draw_rect.clip_bottom) return;
+
+	GradientShift gs = static_cast<GradientShift>(GS_LIGHT - _weather.GetWeatherType());
+
+	/* The static layer needs the decoded sprites of the sprite cache. Its out of date part is rendered together with the repainted part. */
+	Rectangle32 area(draw_rect.clip_left, draw_rect.clip_top, draw_rect.clip_right - draw_rect.clip_left, draw_rect.clip_bottom - draw_rect.clip_top);
+	bool use_static_layer = _sprite_cache.IsEnabled();
+	if (use_static_layer) {
+		StaticLayerSettings settings = {this->orientation, this->tile_width, this->underground_mode, gs, selector, _video.GetDisplayResetCount()};
+		Point32 origin(this->ComputeX(this->view_pos.x, this->view_pos.y) - this->rect.width / 2,
+				this->ComputeY(this->view_pos.x, this->view_pos.y, this->view_pos.z) - this->rect.height / 2);
+		this->static_layer.SetView(this->rect.width, this->rect.height, origin, settings);
+
+		Rectangle32 dirty_area;
+		if (this->static_layer.GetDirtyArea(&dirty_area)) {
+			int32 right = std::max(area.base.x + (int32)area.width, dirty_area.base.x + (int32)dirty_area.width);
+			int32 bottom = std::max(area.base.y + (int32)area.height, dirty_area.base.y + (int32)dirty_area.height);
+			area.base.x = std::min(area.base.x, dirty_area.base.x);
+			area.base.y = std::min(area.base.y, dirty_area.base.y);
+			area.width = right - area.base.x;
+			area.height = bottom - area.base.y;
+		}
+	}
+
+	/* Only collect the sprites of the part of the viewport being repainted. Sprites may stick out of
+	 * their voxel sideways and upwards, so include a tile extra at the sides, and everything below it.
+	 */
+	int16 left = std::max((int)area.base.x - this->tile_width, 0);
+	int16 right = std::min((int)(area.base.x + area.width) + this->tile_width, (int)this->rect.width);
+	int16 top = area.base.y;
 	SpriteCollector collector(this);
-	collector.SetWindowSize(-(int16)this->rect.width / 2, -(int16)this->rect.height / 2, this->rect.width, this->rect.height);
+	collector.SetWindowSize(-(int16)this->rect.width / 2 + left, -(int16)this->rect.height / 2 + top, right - left, this->rect.height - top);
+	collector.SetXYOffset(left, top);
 	collector.SetSelector(selector);
 	collector.Collect();
+	collector.draw_images.Sort();
+
+	if (use_static_layer) {
+		this->DrawLayers(draw_rect, gs);
+		return;
+	}
+
 	static const Recolouring recolour;
 
 	_video.FillRectangle(this->rect, MakeRGBA(0, 0, 0, OPAQUE)); // Black background.
 
-	ClippedRectangle cr = _video.GetClippedRectangle();
-	assert(this->rect.base.x >= 0 && this->rect.base.y >= 0);
-	ClippedRectangle draw_rect(cr, this->rect.base.x, this->rect.base.y, this->rect.width, this->rect.height);
 	_video.SetClippedRectangle(draw_rect);
-
-	GradientShift gs = static_cast<GradientShift>(GS_LIGHT - _weather.GetWeatherType());
-	for (const auto &iter : collector.draw_images) {
-		const DrawData &dd = iter;
+	for (uint i = 0; i < collector.draw_images.Count(); i++) {
+		const DrawData &dd = collector.draw_images.Get(i);
 		const Recolouring &rec = (dd.recolour == nullptr) ? recolour : *dd.recolour;
 		_video.BlitImage(dd.base, dd.sprite, rec, dd.highlight ? GS_SEMI_TRANSPARENT : gs);
 	}
-
 	_video.SetClippedRectangle(cr);
 }
 
+/**
+ * Equality operator of static layer settings.
+ * @param other Settings to compare with.
+ * @return Whether both settings give the same static layer.
+ */
+bool StaticLayerSettings::operator==(const StaticLayerSettings &other) const
+{
+	return this->orientation == other.orientation && this->tile_width == other.tile_width && this->underground_mode == other.underground_mode &&
+			this->gs == other.gs && this->selector == other.selector && this->display_resets == other.display_resets;
+}
+
+StaticLayer::StaticLayer() : width(0), height(0), cells_x(0), cells_y(0), origin(0, 0)
+{
+	this->settings = {VOR_NORTH, 0, false, GS_NORMAL, nullptr, 0};
+}
+
+/**
+ * Set the view of the layer before drawing. A change of the size or the settings makes the entire layer out of date,
+ * while a moved origin scrolls the contents of the layer.
+ * @param width Width of the viewport.
+ * @param height Height of the viewport.
+ * @param origin Screen position of the top-left pixel of the viewport, relative to the origin of the world.
+ * @param settings Settings of the viewport.
+ */
+void StaticLayer::SetView(uint16 width, uint16 height, const Point32 &origin, const StaticLayerSettings &settings)
+{
+	if (width != this->width || height != this->height || !(settings == this->settings)) {
+		this->width = width;
+		this->height = height;
+		this->cells_x = (width + CELL_SIZE - 1) / CELL_SIZE;
+		this->cells_y = (height + CELL_SIZE - 1) / CELL_SIZE;
+		this->pixels.resize(width * height);
+		this->dirty.assign(this->cells_x * this->cells_y, true);
+		this->origin = origin;
+		this->settings = settings;
+		return;
+	}
+	if (!(origin == this->origin)) {
+		this->Scroll(origin.x - this->origin.x, origin.y - this->origin.y);
+		this->origin = origin;
+	}
+}
+
+/**
+ * Move the contents of the layer after moving its origin. Cells that are not completely covered by valid old contents become out of date.
+ * @param dx Horizontal distance of moving the origin.
+ * @param dy Vertical distance of moving the origin.
+ */
+void StaticLayer::Scroll(int32 dx, int32 dy)
+{
+	/* Pixel (x, y) of the scrolled layer is pixel (x + dx, y + dy) of the current layer. */
+	this->scroll_pixels.resize(this->pixels.size());
+	const int32 first_x = std::max(0, -dx);
+	const int32 last_x = std::min((int32)this->width, this->width - dx);
+	for (int32 y = std::max(0, -dy); y < std::min((int32)this->height, this->height - dy) && first_x < last_x; y++) {
+		const uint32 *src = &this->pixels[(y + dy) * this->width + first_x + dx];
+		std::copy(src, src + (last_x - first_x), &this->scroll_pixels[y * this->width + first_x]);
+	}
+
+	this->scroll_dirty.resize(this->dirty.size());
+	for (int32 cy = 0; cy < this->cells_y; cy++) {
+		for (int32 cx = 0; cx < this->cells_x; cx++) {
+			/* Area of the cell in the current layer. */
+			int32 left = cx * CELL_SIZE + dx;
+			int32 right = std::min((cx + 1) * CELL_SIZE, (int32)this->width) + dx;
+			int32 top = cy * CELL_SIZE + dy;
+			int32 bottom = std::min((cy + 1) * CELL_SIZE, (int32)this->height) + dy;
+			bool is_dirty = left < 0 || top < 0 || right > this->width || bottom > this->height;
+			for (int32 y = top / CELL_SIZE; !is_dirty && y <= (bottom - 1) / CELL_SIZE; y++) {
+				for (int32 x = left / CELL_SIZE; !is_dirty && x <= (right - 1) / CELL_SIZE; x++) is_dirty = this->dirty[y * this->cells_x + x];
+			}
+			this->scroll_dirty[cy * this->cells_x + cx] = is_dirty;
+		}
+	}
+
+	std::swap(this->pixels, this->scroll_pixels);
+	std::swap(this->dirty, this->scroll_dirty);
+}
+
+/**
+ * Mark an area of the layer as out of date.
+ * @param area Screen area to mark, relative to the origin of the world.
+ */
+void StaticLayer::MarkDirty(const Rectangle32 &area)
+{
+	int32 left = std::max(area.base.x - this->origin.x, 0);
+	int32 right = std::min(area.base.x - this->origin.x + (int32)area.width, (int32)this->width);
+	int32 top = std::max(area.base.y - this->origin.y, 0);
+	int32 bottom = std::min(area.base.y - this->origin.y + (int32)area.height, (int32)this->height);
+	if (left >= right || top >= bottom) return;
+
+	for (int32 y = top / CELL_SIZE; y <= (bottom - 1) / CELL_SIZE; y++) {
+		for (int32 x = left / CELL_SIZE; x <= (right - 1) / CELL_SIZE; x++) this->dirty[y * this->cells_x + x] = true;
+	}
+}
+
+/**
+ * Get the bounding area of the cells that are out of date.
+ * @param [out] area Bounding area of the dirty cells, relative to the top-left of the viewport.
+ * @return Whether any cell is out of date.
+ */
+bool StaticLayer::GetDirtyArea(Rectangle32 *area) const
+{
+	int32 left = this->cells_x, right = -1, top = this->cells_y, bottom = -1;
+	for (int32 y = 0; y < this->cells_y; y++) {
+		for (int32 x = 0; x < this->cells_x; x++) {
+			if (!this->dirty[y * this->cells_x + x]) continue;
+			left = std::min(left, x);
+			right = std::max(right, x);
+			top = std::min(top, y);
+			bottom = std::max(bottom, y);
+		}
+	}
+	if (right < 0) return false;
+
+	area->base.x = left * CELL_SIZE;
+	area->base.y = top * CELL_SIZE;
+	area->width = std::min((right + 1) * CELL_SIZE, (int32)this->width) - area->base.x;
+	area->height = std::min((bottom + 1) * CELL_SIZE, (int32)this->height) - area->base.y;
+	return true;
+}
+
+/**
+ * Get a clipped rectangle for rendering into the layer.
+ * @return Clipped rectangle covering the entire layer.
+ */
+ClippedRectangle StaticLayer::GetClippedRectangle()
+{
+	ClippedRectangle cr(0, 0, this->width, this->height);
+	cr.address = this->pixels.data();
+	cr.pitch = this->width;
+	return cr;
+}
+
+/**
+ * Draw the collected sprites using the static layer.
+ * The out of date cells of the static layer are rendered first, after which the repainted area is copied from it. The cells with
+ * moving sprites are then rendered again with all sprites, which draws the moving sprites in the right order with the static sprites.
+ * @param draw_rect Clipped rectangle of the viewport to draw in.
+ * @param gs Gradient shift of the sprites.
+ */
+void Viewport::DrawLayers(ClippedRectangle &draw_rect, GradientShift gs)
+{
+	const int cell_size = StaticLayer::CELL_SIZE;
+	StaticLayer &layer = this->static_layer;
+	const DrawImages &images = *this->draw_images;
+
+	/* Sprites are decoded when they are rendered. */
+	_sprite_cache.BeginFrame();
+	this->decoded_sprites.assign(images.Count(), nullptr);
+
+	if (std::find(layer.dirty.begin(), layer.dirty.end(), true) != layer.dirty.end()) {
+		this->RenderCells(layer.GetClippedRectangle(), layer.dirty, true, gs);
+		layer.dirty.assign(layer.dirty.size(), false);
+	}
+
+	draw_rect.ValidateAddress();
+	for (int y = draw_rect.clip_top; y < draw_rect.clip_bottom; y++) {
+		const uint32 *src = &layer.pixels[y * layer.width + draw_rect.clip_left];
+		std::copy(src, src + (draw_rect.clip_right - draw_rect.clip_left), draw_rect.address + y * draw_rect.pitch + draw_rect.clip_left);
+	}
+
+	this->moving_cells.assign(layer.dirty.size(), false);
+	bool has_moving = false;
+	for (uint i = 0; i < images.Count(); i++) {
+		const DrawData &dd = images.Get(i);
+		if (!dd.IsMoving()) continue;
+
+		int32 x = dd.base.x + dd.sprite->xoffset;
+		int32 y = dd.base.y + dd.sprite->yoffset;
+		int32 left = std::max(x, (int32)draw_rect.clip_left);
+		int32 right = std::min(x + dd.sprite->width, (int32)draw_rect.clip_right);
+		int32 top = std::max(y, (int32)draw_rect.clip_top);
+		int32 bottom = std::min(y + dd.sprite->height, (int32)draw_rect.clip_bottom);
+		if (left >= right || top >= bottom) continue; // Sprite is outside the repainted area.
+
+		for (int32 row = top / cell_size; row <= (bottom - 1) / cell_size; row++) {
+			for (int32 col = left / cell_size; col <= (right - 1) / cell_size; col++) this->moving_cells[row * layer.cells_x + col] = true;
+		}
+		has_moving = true;
+	}
+	if (has_moving) this->RenderCells(draw_rect, this->moving_cells, false, gs);
+}
+
+/**
+ * Render the collected sprites in cells of the viewport, concurrently at the worker threads.
+ * A cell is rendered from a black background with the sprites overlapping it in drawing order, clipped to the cell.
+ * The rows of cells are distributed over the threads, which write to disjoint parts of the target.
+ * @param target Clipped rectangle to render into, with the coordinates of the viewport.
+ * @param cells For each cell of the viewport row by row, whether to render it.
+ * @param static_only Render only the sprites of the static layer.
+ * @param gs Gradient shift of the sprites.
+ */
+void Viewport::RenderCells(const ClippedRectangle &target, const std::vector<bool> &cells, bool static_only, GradientShift gs)
+{
+	static const Recolouring recolour;
+	const int cell_size = StaticLayer::CELL_SIZE;
+	const StaticLayer &layer = this->static_layer;
+	const DrawImages &images = *this->draw_images;
+
+	/* Find the rows with cells to render, and the sprites overlapping them in drawing order. */
+	std::vector<uint16> rows;
+	std::vector<bool> row_used(layer.cells_y, false);
+	if (this->row_sprites.size() < layer.cells_y) this->row_sprites.resize(layer.cells_y);
+	for (uint16 row = 0; row < layer.cells_y; row++) {
+		this->row_sprites[row].clear();
+		auto row_begin = cells.begin() + row * layer.cells_x;
+		if (std::find(row_begin, row_begin + layer.cells_x, true) == row_begin + layer.cells_x) continue;
+		rows.push_back(row);
+		row_used[row] = true;
+	}
+	for (uint i = 0; i < images.Count(); i++) {
+		const DrawData &dd = images.Get(i);
+		if (static_only && dd.IsMoving()) continue;
+
+		int32 y = dd.base.y + dd.sprite->yoffset;
+		int32 top = std::max(y, (int32)target.clip_top);
+		int32 bottom = std::min(y + dd.sprite->height, (int32)target.clip_bottom);
+		bool used = false;
+		for (int32 row = top / cell_size; row <= (bottom - 1) / cell_size && top < bottom; row++) {
+			if (!row_used[row]) continue;
+			this->row_sprites[row].push_back(i);
+			used = true;
+		}
+
+		/* Decoding uses the sprite cache and the colour maps of the recolourings, which is done at a single thread. */
+		if (used && this->decoded_sprites[i] == nullptr) {
+			const Recolouring &rec = (dd.recolour == nullptr) ? recolour : *dd.recolour;
+			this->decoded_sprites[i] = _sprite_cache.Get(dd.sprite, rec, dd.highlight ? GS_SEMI_TRANSPARENT : gs);
+		}
+	}
+
+	_worker_pool.Run(rows.size(), [this, &rows, &cells, &target, &images, &layer, cell_size](uint job) {
+		const uint16 row = rows[job];
+		const int32 top = std::max(row * cell_size, (int)target.clip_top);
+		const int32 bottom = std::min((row + 1) * cell_size, (int)target.clip_bottom);
+		if (top >= bottom) return;
+
+		uint16 col = 0;
+		while (col < layer.cells_x) {
+			if (!cells[row * layer.cells_x + col]) {
+				col++;
+				continue;
+			}
+			uint16 end = col + 1;
+			while (end < layer.cells_x && cells[row * layer.cells_x + end]) end++;
+			const int32 left = std::max(col * cell_size, (int)target.clip_left);
+			const int32 right = std::min(end * cell_size, (int)target.clip_right);
+			col = end;
+			if (left >= right) continue;
+
+			for (int32 y = top; y < bottom; y++) {
+				uint32 *dest = target.address + y * target.pitch;
+				std::fill(dest + left, dest + right, MakeRGBA(0, 0, 0, OPAQUE)); // Black background.
+			}
+			ClippedRectangle cell_rect(target);
+			cell_rect.clip_left = left;
+			cell_rect.clip_right = right;
+			cell_rect.clip_top = top;
+			cell_rect.clip_bottom = bottom;
+			for (uint i : this->row_sprites[row]) {
+				const DrawData &dd = images.Get(i);
+				int32 x = dd.base.x + dd.sprite->xoffset;
+				if (x >= right || x + dd.sprite->width <= left) continue;
+				BlitDecodedSprite(cell_rect, x, dd.base.y + dd.sprite->yoffset, *this->decoded_sprites[i]);
+			}
+		}
+	});
+}
+
+/**
+ * Collect the sprites of the entire viewport without drawing them.
+ * @return Number of collected sprites.
+ */
+uint Viewport::CollectSprites()
+{
+	SpriteCollector collector(this);
+	collector.SetWindowSize(-(int16)this->rect.width / 2, -(int16)this->rect.height / 2, this->rect.width, this->rect.height);
+	collector.Collect();
+	collector.draw_images.Sort();
+	return collector.draw_images.Count();
+}
+
 /**
  * Mark a voxel as in need of getting painted.
  * @param voxel_pos Position of the voxel.
  * @param height Number of voxels to mark above the specified coordinate (\c 0 means inspect the voxel itself).
+ * @param moving_only Only the voxel objects in the voxel changed, the static layer stays valid.
  */
-void Viewport::MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height)
+void Viewport::MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height, bool moving_only)
 {
 	if (height <= 0) {
 		const Voxel *v = _world.GetVoxel(voxel_pos);
@@ -996,50 +1505,201 @@ void Viewport::MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height)
 	rect.height = d - rect.base.y + 1;
 
 	_video.MarkDisplayDirty(rect);
+
+	/* The static layer may not have scrolled to the current view yet, mark the layers relative to the origin of the world. */
+	rect.base.x += center_x;
+	rect.base.y += center_y;
+	if (!moving_only) this->static_layer.MarkDirty(rect);
+	this->hit_buffer.MarkDirty(rect, moving_only);
+}
+
+HitBuffer::HitBuffer() : allowed(CS_NONE)
+{
+	this->settings = {VOR_NORTH, 0, false, GS_NORMAL, nullptr, 0};
+}
+
+/**
+ * Set the view of the buffer before searching. A change of the settings or the kinds of sprites drops all cells.
+ * @param settings Settings of the viewport.
+ * @param allowed Kinds of sprites being searched.
+ */
+void HitBuffer::SetView(const StaticLayerSettings &settings, ClickableSprite allowed)
+{
+	if (settings == this->settings && allowed == this->allowed) return;
+
+	this->settings = settings;
+	this->allowed = allowed;
+	this->cells.clear();
+}
+
+/**
+ * Drop the cells of an area with changed voxels.
+ * @param area Screen area with changed voxels, relative to the origin of the world.
+ * @param moving_only Only voxel objects have changed.
+ */
+void HitBuffer::MarkDirty(const Rectangle32 &area, bool moving_only)
+{
+	if (this->cells.empty() || area.width == 0 || area.height == 0) return;
+	if (moving_only && (this->allowed & CS_PERSON) == 0) return;
+
+	int32 right = FloorDivide(area.base.x + area.width - 1, CELL_SIZE);
+	int32 bottom = FloorDivide(area.base.y + area.height - 1, CELL_SIZE);
+	for (int32 cy = FloorDivide(area.base.y, CELL_SIZE); cy <= bottom; cy++) {
+		for (int32 cx = FloorDivide(area.base.x, CELL_SIZE); cx <= right; cx++) this->cells.erase(GetKey(cx, cy));
+	}
+}
+
+/**
+ * Get a cell of the buffer.
+ * @param cx Horizontal position of the cell, in cells relative to the origin of the world.
+ * @param cy Vertical position of the cell, in cells relative to the origin of the world.
+ * @param [out] created Whether the cell is new, and must be computed.
+ * @return The cell.
+ */
+HitCell *HitBuffer::GetCell(int32 cx, int32 cy, bool *created)
+{
+	if (this->cells.size() >= MAX_CELLS) this->cells.clear();
+
+	auto result = this->cells.emplace(GetKey(cx, cy), HitCell());
+	*created = result.second;
+	return &result.first->second;
+}
+
+/**
+ * Compute the closest sprite at each pixel of a cell of the hit buffer.
+ * @param cx Horizontal position of the cell, in cells relative to the origin of the world.
+ * @param cy Vertical position of the cell, in cells relative to the origin of the world.
+ * @param [out] cell Cell to compute.
+ * @param allowed Kinds of sprites being searched.
+ */
+void Viewport::ComputeHitCell(int32 cx, int32 cy, HitCell *cell, ClickableSprite allowed)
+{
+	static const Recolouring recolour;
+	const int cell_size = HitBuffer::CELL_SIZE;
+	const int32 left = cx * cell_size;
+	const int32 top = cy * cell_size;
+
+	PixelFinder finder(this, allowed);
+	finder.SetWindowSize(left - this->ComputeX(this->view_pos.x, this->view_pos.y),
+			top - this->ComputeY(this->view_pos.x, this->view_pos.y, this->view_pos.z), cell_size, cell_size);
+	finder.Collect();
+
+	cell->found.assign(cell_size * cell_size, 0);
+	cell->sprites.clear();
+	cell->sprites.reserve(finder.found.size());
+	for (uint i = 0; i < finder.found.size() && i < UINT16_MAX; i++) {
+		const FoundSprite &fs = finder.found[i];
+		cell->sprites.push_back(fs.hit);
+
+		/* Walk the drawn pixels of the sprite, transparent pixels are never found. */
+		const DecodedSprite *decoded = _sprite_cache.Get(fs.hit.sprite, recolour, GS_NORMAL);
+		const int32 area_right = fs.area.base.x + fs.area.width;
+		for (int32 y = fs.area.base.y; y < fs.area.base.y + (int32)fs.area.height; y++) {
+			const int32 row = y - fs.hit.pos.y;
+			uint16 *found_row = &cell->found[(y - top) * cell_size];
+			for (uint32 s = decoded->row_starts[row]; s < decoded->row_starts[row + 1]; s++) {
+				const DecodedSpan &span = decoded->spans[s];
+				const int32 first = std::max(fs.hit.pos.x + span.x, fs.area.base.x);
+				const int32 last = std::min(fs.hit.pos.x + span.x + span.count, area_right);
+				for (int32 x = first; x < last; x++) {
+					if (found_row[x - left] != 0 && !(finder.found[found_row[x - left] - 1].data < fs.data)) continue;
+					if (span.blend && span.opacity == TRANSPARENT) {
+						uint32 colour = fs.hit.sprite->GetPixel(x - fs.hit.pos.x, row);
+						if (!IsFoundPixel(fs.data.order, colour)) continue;
+					}
+					found_row[x - left] = i + 1;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Find the closest sprite under the mouse cursor in the hit buffer, computing the cell of the mouse cursor if needed.
+ * @param [out] fdata Finder data to return.
+ * @param [out] order Kind of the found sprite.
+ * @param [out] pixel Colour of the found sprite at the mouse cursor.
+ * @return Whether a sprite was found.
+ */
+bool Viewport::FindInHitBuffer(FinderData *fdata, SpriteOrder *order, uint32 *pixel)
+{
+	const int cell_size = HitBuffer::CELL_SIZE;
+	StaticLayerSettings settings = {this->orientation, this->tile_width, this->underground_mode, GS_NORMAL, nullptr, _video.GetDisplayResetCount()};
+	this->hit_buffer.SetView(settings, fdata->allowed);
+
+	int32 xpos = this->ComputeX(this->view_pos.x, this->view_pos.y) + (int16)(this->mouse_pos.x - this->rect.width / 2);
+	int32 ypos = this->ComputeY(this->view_pos.x, this->view_pos.y, this->view_pos.z) + (int16)(this->mouse_pos.y - this->rect.height / 2);
+	int32 cx = FloorDivide(xpos, cell_size);
+	int32 cy = FloorDivide(ypos, cell_size);
+	bool created;
+	HitCell *cell = this->hit_buffer.GetCell(cx, cy, &created);
+	if (created) this->ComputeHitCell(cx, cy, cell, fdata->allowed);
+
+	uint16 index = cell->found[(ypos - cy * cell_size) * cell_size + xpos - cx * cell_size];
+	if (index == 0) return false;
+
+	const HitSprite &hit = cell->sprites[index - 1];
+	*order = hit.order;
+	*pixel = hit.sprite->GetPixel(xpos - hit.pos.x, ypos - hit.pos.y);
+	fdata->voxel_pos = hit.voxel_pos;
+	fdata->ride = hit.ride;
+	fdata->person = hit.person;
+	return true;
 }
 
 /**
  * Compute position of the mouse cursor, and return the result.
+ * With the sprite cache, the sprites are found in the hit buffer, else the voxels at the mouse cursor are examined.
  * @param fdata [inout] Parameters and results of the finding process.
  * @return Found type of sprite.
  */
 ClickableSprite Viewport::ComputeCursorPosition(FinderData *fdata)
 {
-	int16 xp = this->mouse_pos.x - this->rect.width / 2;
-	int16 yp = this->mouse_pos.y - this->rect.height / 2;
-	PixelFinder collector(this, fdata);
-	collector.SetWindowSize(xp, yp, 1, 1);
-	collector.Collect();
-	if (!collector.found) return CS_NONE;
+	fdata->voxel_pos = XYZPoint16(0, 0, 0);
+	fdata->person = nullptr;
+	fdata->ride   = INVALID_RIDE_INSTANCE;
+
+	SpriteOrder order;
+	uint32 pixel;
+	if (_sprite_cache.IsEnabled()) {
+		if (!this->FindInHitBuffer(fdata, &order, &pixel)) return CS_NONE;
+	} else {
+		int16 xp = this->mouse_pos.x - this->rect.width / 2;
+		int16 yp = this->mouse_pos.y - this->rect.height / 2;
+		PixelFinder finder(this, fdata->allowed);
+		finder.SetWindowSize(xp, yp, 1, 1);
+		finder.Collect();
+		if (!finder.FindPixel(&order, &pixel, fdata)) return CS_NONE;
+	}
 
 	fdata->cursor = fdata->select == FW_EDGE ? CUR_TYPE_EDGE_NE : CUR_TYPE_TILE;
-	if (fdata->select == FW_CORNER && (collector.data.order & CS_MASK) == CS_GROUND) {
-		if (collector.pixel == _palette[181]) {
+	if (fdata->select == FW_CORNER && (order & CS_MASK) == CS_GROUND) {
+		if (pixel == _palette[181]) {
 			fdata->cursor = (CursorType)AddOrientations(VOR_NORTH, this->orientation);
-		} else if (collector.pixel == _palette[182]) {
+		} else if (pixel == _palette[182]) {
 			fdata->cursor = (CursorType)AddOrientations(VOR_EAST,  this->orientation);
-		} else if (collector.pixel == _palette[184]) {
+		} else if (pixel == _palette[184]) {
 			fdata->cursor = (CursorType)AddOrientations(VOR_WEST,  this->orientation);
-		} else if (collector.pixel == _palette[185]) {
+		} else if (pixel == _palette[185]) {
 			fdata->cursor = (CursorType)AddOrientations(VOR_SOUTH, this->orientation);
 		}
 	}
-	else if (fdata->select == FW_EDGE && (collector.data.order & CS_MASK) == CS_GROUND_EDGE) {
+	else if (fdata->select == FW_EDGE && (order & CS_MASK) == CS_GROUND_EDGE) {
 		uint8 base_edge = EDGE_COUNT;
-		if (collector.pixel == _palette[181]) {
+		if (pixel == _palette[181]) {
 			base_edge = (uint8)EDGE_NE;
-		} else if (collector.pixel == _palette[182]) {
+		} else if (pixel == _palette[182]) {
 			base_edge = (uint8)EDGE_SE;
-		} else if (collector.pixel == _palette[184]) {
+		} else if (pixel == _palette[184]) {
 			base_edge = (uint8)EDGE_NW;
-		} else if (collector.pixel == _palette[185]) {
+		} else if (pixel == _palette[185]) {
 			base_edge = (uint8)EDGE_SW;
 		}
 		if (base_edge < EDGE_COUNT) {
 			fdata->cursor = (CursorType)((base_edge + (uint8)this->orientation) % 4 + (uint8)CUR_TYPE_EDGE_NE);
 		}
 	}
-	return (ClickableSprite)(collector.data.order & CS_MASK);
+	return (ClickableSprite)(order & CS_MASK);
 }
 
 /**
@@ -1056,6 +1716,23 @@ void Viewport::Rotate(int direction)
 	NotifyChange(WC_PATH_BUILDER, ALL_WINDOWS_OF_TYPE, CHG_VIEWPORT_ROTATED, direction);
 }
 
+/**
+ * Zoom out or in one level.
+ * @param direction Direction of zooming (positive means zooming out).
+ */
+void Viewport::Zoom(int direction)
+{
+	int zoom = Clamp(this->zoom + ((direction > 0) ? 1 : -1), 0, ZOOM_LEVEL_COUNT - 1);
+	if (zoom == this->zoom) return;
+
+	this->zoom = zoom;
+	this->tile_width = SPRITE_TILE_WIDTH >> zoom;
+	this->tile_height = this->tile_width / 4;
+	Point16 pt = this->mouse_pos;
+	this->OnMouseMoveEvent(pt);
+	this->MarkDirty();
+}
+
 /**
  * Compute the horizontal translation in world coordinates of the viewing centre to move it \a dx / \a dy pixels.
  * @param dx Horizontal shift in screen pixels.
@@ -1181,6 +1858,16 @@ void MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height)
 	if (vp != nullptr) vp->MarkVoxelDirty(voxel_pos, height);
 }
 
+/**
+ * Mark a voxel as in need of getting painted after a voxel object in it changed.
+ * @param voxel_pos Position of the voxel.
+ */
+void MarkVoxelObjectDirty(const XYZPoint16 &voxel_pos)
+{
+	Viewport *vp = _window_manager.GetViewport();
+	if (vp != nullptr) vp->MarkVoxelDirty(voxel_pos, 0, true);
+}
+
 /**
  * Open the main isometric display window.
  * @param view_pos Pixel position of the center viewpoint of the main display.
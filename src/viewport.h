@@ -12,8 +12,14 @@
 
 #include "window.h"
 #include "mouse_mode.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 class Viewport;
+class DrawImages;
+class ImageData;
+struct DecodedSprite;
 class Person;
 class RideInstance;
 
@@ -88,6 +94,109 @@ public:
 	uint16 ride;             ///< Found ride instance, if any.
 };
 
+/**
+ * Settings of a viewport that change the looks of the sprites of the entire viewport.
+ * @ingroup viewport_group
+ */
+struct StaticLayerSettings {
+	ViewOrientation orientation;       ///< Direction of view.
+	uint16 tile_width;                 ///< Width of a tile.
+	bool underground_mode;             ///< Whether underground mode is displayed.
+	GradientShift gs;                  ///< Gradient shift of the sprites.
+	const MouseModeSelector *selector; ///< Mouse mode selector used while drawing.
+	uint32 display_resets;             ///< Number of times the entire display was marked dirty, see #VideoSystem::GetDisplayResetCount.
+
+	bool operator==(const StaticLayerSettings &other) const;
+};
+
+/**
+ * Cached rendering of the sprites of a viewport that do not move, that is everything except the voxel objects.
+ * The layer is divided in square cells, cells that are out of date are marked dirty and rendered again at the next redraw.
+ * @ingroup viewport_group
+ */
+class StaticLayer {
+public:
+	static const int CELL_SIZE = 32; ///< Width and height of a cell, in pixels.
+
+	StaticLayer();
+
+	void SetView(uint16 width, uint16 height, const Point32 &origin, const StaticLayerSettings &settings);
+	void MarkDirty(const Rectangle32 &area);
+	bool GetDirtyArea(Rectangle32 *area) const;
+	ClippedRectangle GetClippedRectangle();
+
+	uint16 width;   ///< Width of the layer in pixels.
+	uint16 height;  ///< Height of the layer in pixels.
+	uint16 cells_x; ///< Number of cells in horizontal direction.
+	uint16 cells_y; ///< Number of cells in vertical direction.
+	std::vector<uint32> pixels; ///< Pixels of the layer, row by row.
+	std::vector<bool> dirty;    ///< For each cell row by row, whether it is out of date.
+
+private:
+	void Scroll(int32 dx, int32 dy);
+
+	Point32 origin;               ///< Screen position of the top-left pixel of the layer, relative to the origin of the world.
+	StaticLayerSettings settings; ///< Settings of the viewport when the layer was rendered.
+	std::vector<uint32> scroll_pixels; ///< Memory for scrolling #pixels.
+	std::vector<bool> scroll_dirty;    ///< Memory for scrolling #dirty.
+};
+
+/**
+ * Sprite that may be found under the mouse cursor.
+ * @ingroup viewport_group
+ */
+struct HitSprite {
+	const ImageData *sprite; ///< Sprite to examine, for ground tiles the test sprite with the parts of the tile.
+	Point32 pos;             ///< Screen position of the top-left pixel of the sprite, relative to the origin of the world.
+	SpriteOrder order;       ///< Kind of sprite.
+	XYZPoint16 voxel_pos;    ///< Position of the voxel of the sprite.
+	uint16 ride;             ///< Ride instance of the sprite, if any.
+	const Person *person;    ///< Person of the sprite, if any.
+};
+
+/**
+ * Square part of a #HitBuffer with the closest sprite at each pixel.
+ * @ingroup viewport_group
+ */
+struct HitCell {
+	std::vector<HitSprite> sprites; ///< Sprites that may be found in the cell.
+	std::vector<uint16> found;      ///< For each pixel row by row, index in #sprites plus one of the closest sprite, or \c 0 if no sprite was found.
+};
+
+/**
+ * Sprites found under the pixels of a viewport for one kind of search, so following the mouse cursor does not need to examine the voxels
+ * at every movement. The buffer is divided in square cells relative to the origin of the world, a cell is computed when the mouse cursor
+ * first enters it, and dropped when its voxels change.
+ * @ingroup viewport_group
+ */
+class HitBuffer {
+public:
+	static const int CELL_SIZE = 32;      ///< Width and height of a cell, in pixels.
+	static const uint MAX_CELLS = 1024;   ///< Maximal number of cells in the buffer, the buffer is cleared when it gets full.
+
+	HitBuffer();
+
+	void SetView(const StaticLayerSettings &settings, ClickableSprite allowed);
+	void MarkDirty(const Rectangle32 &area, bool moving_only);
+	HitCell *GetCell(int32 cx, int32 cy, bool *created);
+
+private:
+	/**
+	 * Get the key of a cell in #cells.
+	 * @param cx Horizontal position of the cell.
+	 * @param cy Vertical position of the cell.
+	 * @return Key of the cell.
+	 */
+	static inline uint64 GetKey(int32 cx, int32 cy)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(cy)) << 32) | static_cast<uint32>(cx);
+	}
+
+	StaticLayerSettings settings; ///< Settings of the viewport when the cells were computed.
+	ClickableSprite allowed;      ///< Kinds of sprites being searched.
+	std::unordered_map<uint64, HitCell> cells; ///< Computed cells, by position.
+};
+
 /**
  * Class for displaying parts of the world.
  * @ingroup viewport_group
@@ -97,10 +206,12 @@ public:
 	Viewport(const XYZPoint32 &view_pos);
 	~Viewport();
 
-	void MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height = 0);
+	void MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height = 0, bool moving_only = false);
 	void OnDraw(MouseModeSelector *selector) override;
+	uint CollectSprites();
 
 	void Rotate(int direction);
+	void Zoom(int direction);
 	void MoveViewport(int dx, int dy);
 
 	ClickableSprite ComputeCursorPosition(FinderData *fdata);
@@ -116,17 +227,33 @@ public:
 	XYZPoint32 view_pos;         ///< Position of the centre point of the viewport.
 	uint16 tile_width;           ///< Width of a tile.
 	uint16 tile_height;          ///< Height of a tile.
+	uint8 zoom;                  ///< Zoom level of the sprites, each level halves the size of the tiles. @see ImageData::GetZoomed
 	ViewOrientation orientation; ///< Direction of view.
 	Point16 mouse_pos;           ///< Last known position of the mouse.
 	bool additions_enabled;      ///< Flashing of world additions is enabled.
 	bool underground_mode;       ///< Whether underground mode is displayed in this viewport.
 
+	std::unique_ptr<DrawImages> draw_images; ///< Sprites of the last redraw, kept for reusing the memory.
+
 private:
+	void DrawLayers(ClippedRectangle &draw_rect, GradientShift gs);
+	void RenderCells(const ClippedRectangle &target, const std::vector<bool> &cells, bool static_only, GradientShift gs);
+
+	bool FindInHitBuffer(FinderData *fdata, SpriteOrder *order, uint32 *pixel);
+	void ComputeHitCell(int32 cx, int32 cy, HitCell *cell, ClickableSprite allowed);
+
+	StaticLayer static_layer; ///< Cached rendering of the sprites that do not move.
+	HitBuffer hit_buffer;     ///< Sprites found under the mouse cursor.
+	std::vector<const DecodedSprite *> decoded_sprites; ///< Decoded sprites of #draw_images while drawing.
+	std::vector<std::vector<uint32>> row_sprites;       ///< Indices of the sprites to draw in each row of cells while drawing.
+	std::vector<bool> moving_cells;                     ///< Cells of the viewport with moving sprites while drawing.
+
 	void OnMouseMoveEvent(const Point16 &pos) override;
 	WmMouseEvent OnMouseButtonEvent(uint8 state) override;
 	void OnMouseWheelEvent(int direction) override;
 };
 
 void MarkVoxelDirty(const XYZPoint16 &voxel_pos, int16 height = 0);
+void MarkVoxelObjectDirty(const XYZPoint16 &voxel_pos);
 
 #endif
@@ -1074,33 +1074,46 @@ bool WindowManager::KeyEvent(WmKeyCode key_code, const uint8 *symbol)
 
 /**
  * Redraw (parts of) the windows.
- * @todo [medium/difficult] Do this much less stupid.
+ * Areas marked dirty while drawing are repainted in the next redraw.
  * @ingroup window_group
  */
 void WindowManager::UpdateWindows()
 {
 	if (!_video.DisplayNeedsRepaint()) return;
 
-	/* Until the entire background is covered by the main display, clean the entire display to ensure deleted
-	 * windows truly disappear (even if there is no other window behind it).
-	 */
-	Rectangle32 rect(0, 0, _video.GetXSize(), _video.GetYSize());
-	_video.FillRectangle(rect, MakeRGBA(0, 0, 0, OPAQUE));
-
 	GuiWindow *sel_window = this->GetSelector();
 	MouseModeSelector *selector = (sel_window == nullptr) ? nullptr : sel_window->selector;
-	for (Window *w = this->bottom; w != nullptr; w = w->higher) w->OnDraw(selector);
 
-	_video.FinishRepaint();
+	ClippedRectangle screen = _video.GetClippedRectangle();
+	std::vector<Rectangle32> areas;
+	_video.TakeDirtyAreas(&areas);
+	for (const Rectangle32 &area : areas) {
+		_video.SetClippedRectangle(ClippedRectangle(screen, area));
+
+		/* Until the entire background is covered by the main display, clean the area to ensure deleted
+		 * windows truly disappear (even if there is no other window behind it).
+		 */
+		_video.FillRectangle(area, MakeRGBA(0, 0, 0, OPAQUE));
+
+		for (Window *w = this->bottom; w != nullptr; w = w->higher) {
+			if (w->rect.Intersects(area)) w->OnDraw(selector);
+		}
+	}
+	_video.SetClippedRectangle(screen);
+
+	_video.FinishRepaint(areas);
 }
 
-/** A tick has passed, update whatever must be updated. */
-void WindowManager::Tick()
+/**
+ * A tick has passed, update whatever must be updated.
+ * @param frames Number of frames since the previous tick, when redraws were skipped.
+ */
+void WindowManager::Tick(uint frames)
 {
 	Window *w = _window_manager.top;
 	while (w != nullptr) {
 		if (w->timeout > 0) {
-			w->timeout--;
+			w->timeout = (w->timeout > frames) ? w->timeout - frames : 0;
 			if (w->timeout == 0) w->TimeoutCallback();
 		}
 		w = w->lower;
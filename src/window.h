@@ -347,7 +347,7 @@ public:
 	void MouseButtonEvent(MouseButtons button, bool pressed);
 	void MouseWheelEvent(int direction);
 	bool KeyEvent(WmKeyCode key_code, const uint8 *symbol);
-	void Tick();
+	void Tick(uint frames = 1);
 
 	/**
 	 * Mouse moved in the viewport. Forward the call to the selector window.
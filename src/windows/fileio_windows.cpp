@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <windows.h>
+#include <io.h>
 
 WindowsDirectoryReader::WindowsDirectoryReader() : DirectoryReader('\\')
 {
@@ -92,3 +93,76 @@ bool PathIsDirectory(const char *path)
 	return (attr & FILE_ATTRIBUTE_DIRECTORY) != 0;
 }
 
+/**
+ * Rename a file, replacing an existing file with the new name.
+ * @param from Current name of the file.
+ * @param to New name of the file.
+ * @return Whether renaming was successful.
+ */
+bool RenameFile(const char *from, const char *to)
+{
+	return MoveFileEx(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+/**
+ * Write the buffered data of an opened file to the storage device.
+ * @param fp File to synchronize.
+ * @return Whether the data was written successfully.
+ */
+bool SyncFile(FILE *fp)
+{
+	return fflush(fp) == 0 && _commit(_fileno(fp)) == 0;
+}
+
+/**
+ * Make a path independent of the current working directory.
+ * @param path Path to convert, relative to the current working directory or absolute.
+ * @return Absolute path, or a copy of \a path if it cannot be converted. Caller must free the returned memory.
+ */
+char *MakeAbsolutePath(const char *path)
+{
+	char full_path[MAX_PATH];
+	DWORD length = GetFullPathName(path, lengthof(full_path), full_path, nullptr);
+	if (length == 0 || length >= lengthof(full_path)) return StrDup(path);
+	return StrDup(full_path);
+}
+
+/**
+ * Map a file into memory for reading.
+ * @param fname Name of the file to map.
+ * @return Whether the file was mapped successfully. Empty files cannot be mapped.
+ */
+bool MappedFile::Open(const char *fname)
+{
+	this->Close();
+
+	HANDLE file = CreateFile(fname, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER file_size;
+	void *address = nullptr;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr) {
+			address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // The view keeps the mapping alive.
+		}
+	}
+	CloseHandle(file);
+	if (address == nullptr) return false;
+
+	this->data = static_cast<const uint8 *>(address);
+	this->size = file_size.QuadPart;
+	return true;
+}
+
+/** Remove the mapping of the file, if a file is mapped. */
+void MappedFile::Close()
+{
+	if (this->data == nullptr) return;
+
+	UnmapViewOfFile(this->data);
+	this->data = nullptr;
+	this->size = 0;
+}
+
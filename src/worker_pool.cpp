@@ -0,0 +1,122 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_pool.cpp Pool of worker threads. */
+
+#include "stdafx.h"
+#include "worker_pool.h"
+
+WorkerPool _worker_pool; ///< Worker threads of the game.
+
+static const uint MAX_WORKERS = 15; ///< Maximal number of worker threads started by default.
+
+/**
+ * Get the number of worker threads to start for the machine.
+ * @return Default number of worker threads.
+ */
+uint GetDefaultWorkerCount()
+{
+	uint cores = std::thread::hardware_concurrency(); // 0 if unknown.
+	return (cores > 1) ? std::min(cores - 1, MAX_WORKERS) : 0;
+}
+
+WorkerPool::WorkerPool() : generation(0), busy_workers(0), stopping(false), job(nullptr), job_count(0), next_job(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+	this->Stop();
+}
+
+/**
+ * Start worker threads.
+ * @param num_workers Number of worker threads to start.
+ */
+void WorkerPool::Start(uint num_workers)
+{
+	this->Stop();
+	for (uint i = 0; i < num_workers; i++) this->workers.emplace_back(&WorkerPool::WorkerMain, this, this->generation);
+}
+
+/** Stop all worker threads. */
+void WorkerPool::Stop()
+{
+	if (this->workers.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->wake_up.notify_all();
+	for (std::thread &worker : this->workers) worker.join();
+	this->workers.clear();
+	this->stopping = false;
+}
+
+/**
+ * Perform a batch of jobs, and wait until all jobs are done.
+ * @param job_count Number of jobs to perform.
+ * @param job Function to call for each job, with the job number as parameter. Jobs are done in an unspecified order, possibly concurrently.
+ * @note Only one thread may call this function at a time.
+ */
+void WorkerPool::Run(uint job_count, const std::function<void(uint)> &job)
+{
+	if (job_count == 0) return;
+	if (this->workers.empty() || job_count == 1) {
+		for (uint i = 0; i < job_count; i++) job(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->job = &job;
+		this->job_count = job_count;
+		this->next_job = 0;
+		this->busy_workers = this->workers.size();
+		this->generation++;
+	}
+	this->wake_up.notify_all();
+
+	this->DoJobs();
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->finished.wait(guard, [this]() { return this->busy_workers == 0; });
+	this->job = nullptr;
+}
+
+/** Perform jobs of the current batch until none are left. */
+void WorkerPool::DoJobs()
+{
+	for (;;) {
+		uint i = this->next_job++;
+		if (i >= this->job_count) return;
+		(*this->job)(i);
+	}
+}
+
+/**
+ * Main function of a worker thread.
+ * @param done_generation Last batch of jobs that was started before the worker.
+ */
+void WorkerPool::WorkerMain(uint done_generation)
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->wake_up.wait(guard, [this, done_generation]() { return this->stopping || this->generation != done_generation; });
+			if (this->stopping) return;
+			done_generation = this->generation;
+		}
+
+		this->DoJobs();
+
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->busy_workers--;
+		if (this->busy_workers == 0) this->finished.notify_one();
+	}
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_pool.h Pool of worker threads for splitting work in independent jobs. */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Pool of worker threads.
+ * The thread calling #Run also performs jobs, without worker threads all jobs are done by the calling thread.
+ */
+class WorkerPool {
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	void Start(uint num_workers);
+	void Stop();
+
+	/**
+	 * Get the number of threads that perform jobs in #Run, including the calling thread.
+	 * @return Number of threads doing jobs.
+	 */
+	inline uint GetThreadCount() const
+	{
+		return this->workers.size() + 1;
+	}
+
+	void Run(uint job_count, const std::function<void(uint)> &job);
+
+private:
+	void WorkerMain(uint done_generation);
+	void DoJobs();
+
+	std::vector<std::thread> workers; ///< Worker threads.
+	std::mutex lock;                  ///< Lock protecting the variables below.
+	std::condition_variable wake_up;  ///< Signal to the workers that there are new jobs, or that they should stop.
+	std::condition_variable finished; ///< Signal to #Run that the workers have finished.
+	uint generation;                  ///< Number of the current batch of jobs.
+	uint busy_workers;                ///< Number of workers still working at the current batch of jobs.
+	bool stopping;                    ///< Whether the workers should stop.
+
+	const std::function<void(uint)> *job; ///< Job function of the current batch.
+	uint job_count;                       ///< Number of jobs in the current batch.
+	std::atomic<uint> next_job;           ///< Next job to perform in the current batch.
+};
+
+uint GetDefaultWorkerCount();
+
+extern WorkerPool _worker_pool;
+
+#endif